@@ -0,0 +1,150 @@
+/*
+  AtofBench_430
+
+  Checks the accuracy and speed of the core's atof() on an MSP430
+  LaunchPad:
+  - accuracy: each string is compared with the same number written as a
+    constant, which the compiler rounds correctly for this double; the
+    difference is counted in units in the last place (ulp)
+  - speed: the strings are parsed with atof() and with the old digit by
+    digit loop, which is copied below
+
+  mspgcc's double is 32 bits wide, so the table stays inside its range
+  apart from the denormal and overflow cases at the end.
+
+  This example code is in the public domain.
+*/
+
+#include <string.h>
+
+#define RUNS 20
+
+struct Sample {
+  const char *text;
+  double value;
+};
+
+const Sample samples[] = {
+  { "0", 0.0 },
+  { "1", 1.0 },
+  { "-2.5", -2.5 },
+  { "0.1", 0.1 },
+  { "3.14159265", 3.14159265 },
+  { "123456.789", 123456.789 },
+  { "-0.000123", -0.000123 },
+  { "6.02214076e23", 6.02214076e23 },
+  { "1.6e-19", 1.6e-19 },
+  { "  +42.0625", 42.0625 },
+  { "9999999", 9999999.0 },
+  { "1.17549435e-38", 1.17549435e-38 },
+  { "3.4e38", 3.4e38 },
+  { "1e-40", 1e-40 },            // denormal with a 32-bit double
+};
+
+#define SAMPLES (sizeof(samples) / sizeof(samples[0]))
+
+// the atof() the core had before, for comparison
+double atofOld(const char *p)
+{
+  double sign = 1.0, value = 0.0, scale = 1.0, pow10 = 10.0;
+  unsigned int expon = 0;
+  int frac = 0;
+
+  while (*p == ' ' || *p == '\t') p++;
+  if (*p == '-') { sign = -1.0; p++; } else if (*p == '+') p++;
+  for (; *p >= '0' && *p <= '9'; p++) value = value * 10.0 + (*p - '0');
+  if (*p == '.') {
+    for (p++; *p >= '0' && *p <= '9'; p++) {
+      value += (*p - '0') / pow10;
+      pow10 *= 10.0;
+    }
+  }
+  if (*p == 'e' || *p == 'E') {
+    p++;
+    if (*p == '-') { frac = 1; p++; } else if (*p == '+') p++;
+    for (; *p >= '0' && *p <= '9'; p++) expon = expon * 10 + (*p - '0');
+    while (expon >= 8) { scale *= 1E8; expon -= 8; }
+    while (expon > 0) { scale *= 10.0; expon -= 1; }
+  }
+  return sign * (frac ? value / scale : value * scale);
+}
+
+// distance in ulp between two doubles of the same sign
+long ulps(double a, double b)
+{
+  if (sizeof(double) == 4) {
+    int32_t x, y;
+    memcpy(&x, &a, 4);
+    memcpy(&y, &b, 4);
+    return labs(x - y);
+  } else {
+    int64_t x, y;
+    memcpy(&x, &a, 8);
+    memcpy(&y, &b, 8);
+    return (long)(x > y ? x - y : y - x);
+  }
+}
+
+unsigned long timeParser(double (*parse)(const char *))
+{
+  volatile double sink;
+  unsigned long start = micros();
+
+  for (int run = 0; run < RUNS; run++)
+    for (unsigned int i = 0; i < SAMPLES; i++)
+      sink = parse(samples[i].text);
+  return (micros() - start) / (RUNS * SAMPLES);
+}
+
+double atofCore(const char *p)
+{
+  return atof(p);
+}
+
+void setup()
+{
+  Serial.begin(9600);
+}
+
+void loop()
+{
+  long worst = 0, worstOld = 0;
+  unsigned int exact = 0, exactOld = 0;
+
+  for (unsigned int i = 0; i < SAMPLES; i++) {
+    long d = ulps(atof(samples[i].text), samples[i].value);
+    long dOld = ulps(atofOld(samples[i].text), samples[i].value);
+
+    Serial.print(samples[i].text);
+    Serial.print(": ");
+    Serial.print(d);
+    Serial.print(" ulp, old ");
+    Serial.print(dOld);
+    Serial.println(" ulp");
+    if (d == 0) exact++;
+    if (dOld == 0) exactOld++;
+    if (d > worst) worst = d;
+    if (dOld > worstOld) worstOld = dOld;
+  }
+  Serial.print("exact: ");
+  Serial.print(exact);
+  Serial.print(" of ");
+  Serial.print(SAMPLES);
+  Serial.print(", worst ");
+  Serial.print(worst);
+  Serial.print(" ulp; old: ");
+  Serial.print(exactOld);
+  Serial.print(", worst ");
+  Serial.print(worstOld);
+  Serial.println(" ulp");
+
+  Serial.print("atof():    ");
+  Serial.print(timeParser(atofCore));
+  Serial.println(" us per number");
+  Serial.print("old loop:  ");
+  Serial.print(timeParser(atofOld));
+  Serial.println(" us per number");
+
+  Serial.println();
+  delay(5000);
+}
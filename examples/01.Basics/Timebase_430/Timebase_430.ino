@@ -0,0 +1,63 @@
+/*
+  Timebase_430
+
+  Measures what keeping time costs on an MSP430 LaunchPad:
+  - ISR load: a fixed amount of busy work is timed with micros(); any time
+    beyond the nominal cycle count was spent in the timebase interrupt.
+  - micros() cost: the average time of one micros() call.
+
+  Run it once as is and once with TIMEBASE_WDT defined in the build flags
+  to compare the Timer_A timebase with the WDT interval timebase on boards
+  that select TIMEBASE_TIMER in pins_energia.h.
+
+  This example code is in the public domain.
+*/
+
+#define WORK_LOOPS 1000
+#define CYCLES_PER_LOOP 1000
+#define MICROS_CALLS 1000
+
+void setup()
+{
+  Serial.begin(9600);
+#if defined(TIMEBASE_TIMER)
+  Serial.println("Timebase: Timer_A");
+#else
+  Serial.println("Timebase: WDT");
+#endif
+}
+
+void loop()
+{
+  unsigned long start, elapsed, nominal;
+  unsigned int i;
+
+  // Busy work of a known length; the overshoot is interrupt overhead
+  nominal = (unsigned long)WORK_LOOPS * CYCLES_PER_LOOP / (F_CPU / 1000000L);
+  start = micros();
+  for (i = 0; i < WORK_LOOPS; i++) {
+    __delay_cycles(CYCLES_PER_LOOP);
+  }
+  elapsed = micros() - start;
+
+  Serial.print("Work: ");
+  Serial.print(elapsed);
+  Serial.print(" us for ");
+  Serial.print(nominal);
+  Serial.print(" us nominal, ISR load ");
+  Serial.print(elapsed > nominal ? 100.0 * (elapsed - nominal) / elapsed : 0.0, 2);
+  Serial.println(" %");
+
+  // Average cost of one micros() call
+  start = micros();
+  for (i = 0; i < MICROS_CALLS; i++) {
+    micros();
+  }
+  elapsed = micros() - start;
+
+  Serial.print("micros(): ");
+  Serial.print((float)elapsed / MICROS_CALLS, 2);
+  Serial.println(" us per call");
+
+  delay(2000);
+}
@@ -0,0 +1,71 @@
+/*
+  TimerOwners_430
+
+  Shows which feature holds which timer channel on an MSP430 LaunchPad.
+  tone(), Servo and OneMsTaskTimer each take one compare channel of a
+  shared timer, Timer0_A or Timer1_A, and join one that already runs
+  compares; analogWrite() takes the timer of its pin in up mode.
+  The table is printed before anything starts and again once tone, a
+  servo, a 1 ms task and PWM are all running together.
+
+  Change SERVO_PIN, TONE_PIN and PWM_PIN to suit your board; PWM_PIN
+  should be on a timer other than the one tone() and Servo run on, which
+  is Timer0_A here since they start first.
+
+  This example code is in the public domain.
+*/
+
+#include <Servo.h>
+#include <OneMsTaskTimer.h>
+
+#define SERVO_PIN 9
+#define TONE_PIN 10
+#define PWM_PIN 12
+
+Servo servo;
+volatile unsigned long ticks = 0;
+
+void tick()
+{
+  ticks++;
+}
+
+OneMsTaskTimer_t task = { 1, tick, 0, 0 };
+
+void printOwners()
+{
+  for (uint8_t channel = 0; channel < TIMER_CHANNELS; channel++) {
+    uint8_t owner = timerOwner(channel);
+    if (owner == TIMER_OWNER_NONE) continue;
+    Serial.print("channel ");
+    Serial.print(channel);
+    Serial.print(": ");
+    Serial.println(timerOwnerName(owner));
+  }
+  Serial.println();
+}
+
+void setup()
+{
+  Serial.begin(9600);
+  Serial.println("Before:");
+  printOwners();
+
+  tone(TONE_PIN, 440);
+  servo.attach(SERVO_PIN);
+  servo.write(90);
+  OneMsTaskTimer::add(&task);
+  if (!OneMsTaskTimer::start())
+    Serial.println("OneMsTaskTimer: no timer free");
+  analogWrite(PWM_PIN, 128);
+
+  Serial.println("Running:");
+  printOwners();
+}
+
+void loop()
+{
+  Serial.print("1 ms ticks: ");
+  Serial.println(ticks);
+  delay(1000);
+}
@@ -0,0 +1,57 @@
+/*
+  AnalogReadRate_430
+
+  Measures how many analogRead() calls per second an MSP430 LaunchPad
+  manages:
+  - one-shot: the default, the ADC and reference are set up and powered
+    down again on every call
+  - cached, one pin: analogReadCache(true) leaves the ADC set up
+  - cached, two pins: only the channel is changed between calls
+
+  The cached rates are bound by the conversion time itself; the one-shot
+  rate also pays for the set up and the reference settling delay.
+
+  This example code is in the public domain.
+*/
+
+#define READS 1000
+
+unsigned long readRate(uint8_t pin1, uint8_t pin2)
+{
+  unsigned long start, elapsed;
+  unsigned int i;
+
+  start = micros();
+  for (i = 0; i < READS / 2; i++) {
+    analogRead(pin1);
+    analogRead(pin2);
+  }
+  elapsed = micros() - start;
+  return READS * 1000000UL / elapsed;
+}
+
+void report(const char *label, unsigned long rate)
+{
+  Serial.print(label);
+  Serial.print(rate);
+  Serial.println(" samples/s");
+}
+
+void setup()
+{
+  Serial.begin(9600);
+}
+
+void loop()
+{
+  analogReadCache(false);
+  report("one-shot:         ", readRate(A0, A0));
+
+  analogReadCache(true);
+  report("cached, one pin:  ", readRate(A0, A0));
+  report("cached, two pins: ", readRate(A0, A1));
+  analogReadCache(false);               // power the ADC down between runs
+
+  Serial.println();
+  delay(2000);
+}
@@ -0,0 +1,49 @@
+/*
+  AnalogStream_430
+
+  Samples two analog inputs continuously at 1 kHz each on a LaunchPad
+  with an ADC12 (MSP-EXP430F5529LP, MSP-EXP430FR5969, MSP-EXP430FR6989)
+  and prints the average of each input once per block. The samples are
+  taken by the hardware in the background; loop() only sees full blocks.
+
+  This example code is in the public domain.
+*/
+
+#define BLOCK 200   // samples per block, both inputs interleaved
+
+const uint8_t pins[] = { A0, A1 };
+uint16_t ring[2 * BLOCK];
+uint16_t * volatile fullBlock = 0;
+
+// Called from the ADC interrupt each time a block is full
+void blockDone(uint16_t *block, uint16_t length)
+{
+  fullBlock = block;
+}
+
+void setup()
+{
+  Serial.begin(9600);
+  if (!analogStreamBegin(pins, 2, 1000, ring, BLOCK, blockDone)) {
+    Serial.println("analogStreamBegin failed");
+  }
+}
+
+void loop()
+{
+  uint16_t *block = fullBlock;
+  unsigned long sum0 = 0, sum1 = 0;
+
+  if (!block) return;
+  fullBlock = 0;
+
+  // the block stays valid while the other half of the ring fills
+  for (int i = 0; i < BLOCK; i += 2) {
+    sum0 += block[i];
+    sum1 += block[i + 1];
+  }
+  Serial.print("A0: ");
+  Serial.print(sum0 / (BLOCK / 2));
+  Serial.print("  A1: ");
+  Serial.println(sum1 / (BLOCK / 2));
+}
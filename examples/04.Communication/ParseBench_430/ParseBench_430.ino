@@ -0,0 +1,236 @@
+/*
+  ParseBench_430
+
+  Compares Stream's parseInt() and parseFloat() with the digit by digit
+  versions the core had before, which are copied below, on an MSP430
+  LaunchPad:
+  - results: every number in the text is parsed by both and any
+    difference is printed
+  - speed: the whole text is parsed from a stream that hands out its
+    buffer through peekBuffer(), and from one that only has read() and
+    peek() like a plain serial port
+
+  parseFixed() is timed as well; it returns Q16.16 without any floating
+  point math.
+
+  This example code is in the public domain.
+*/
+
+#define RUNS 5
+#define TIMEOUT 0     // the text is all there, don't wait at its end
+
+const char text[] =
+  "12.5, -3.75, 1000, 0.001, 65535.25, -0.5, 42, 3.14159, 7, -1234.5678, "
+  "0.0625, 99999, 2.71828, -8, 511.875, 0.3, -20000.02, 123.456, 1, 0.75 ";
+
+#define NUMBERS 20
+
+// a stream over text; with buffered set it also offers peekBuffer()
+class TextStream : public Stream
+{
+  public:
+    TextStream(bool buffered) : _buffered(buffered) { rewind(); }
+    void rewind() { _pos = 0; }
+
+    virtual int available() { return sizeof(text) - 1 - _pos; }
+    virtual int read() { return available() ? text[_pos++] : -1; }
+    virtual int peek() { return available() ? text[_pos] : -1; }
+    virtual void flush() { }
+    virtual size_t write(uint8_t) { return 0; }
+
+    virtual int read(uint8_t *buffer, size_t length)
+    {
+      if (length > (size_t)available()) length = available();
+      memcpy(buffer, &text[_pos], length);
+      _pos += length;
+      return length;
+    }
+
+    virtual size_t peekBuffer(const uint8_t **data)
+    {
+      if (!_buffered) return 0;
+      *data = (const uint8_t *)&text[_pos];
+      return available();
+    }
+
+  private:
+    bool _buffered;
+    unsigned int _pos;
+};
+
+// the parseInt() and parseFloat() the core had before, for comparison,
+// with a copy of Stream::timedPeek() which sketches can not call
+int timedPeekOld(Stream &s)
+{
+  unsigned long start = millis();
+  int c;
+
+  do {
+    c = s.peek();
+    if (c >= 0) return c;
+  } while (millis() - start < TIMEOUT);
+  return -1;
+}
+
+int peekNextDigitOld(Stream &s)
+{
+  int c;
+  while (1) {
+    c = timedPeekOld(s);
+    if (c < 0) return c;
+    if (c == '-') return c;
+    if (c >= '0' && c <= '9') return c;
+    s.read();
+  }
+}
+
+long parseIntOld(Stream &s)
+{
+  boolean isNegative = false;
+  long value = 0;
+  int c;
+
+  c = peekNextDigitOld(s);
+  if (c < 0) return 0;
+  do {
+    if (c == '-') isNegative = true;
+    else if (c >= '0' && c <= '9') value = value * 10 + c - '0';
+    s.read();
+    c = timedPeekOld(s);
+  } while (c >= '0' && c <= '9');
+  return isNegative ? -value : value;
+}
+
+float parseFloatOld(Stream &s)
+{
+  boolean isNegative = false;
+  boolean isFraction = false;
+  long value = 0;
+  char c;
+  float fraction = 1.0;
+
+  c = peekNextDigitOld(s);
+  if (c < 0) return 0;
+  do {
+    if (c == '-') isNegative = true;
+    else if (c == '.') isFraction = true;
+    else if (c >= '0' && c <= '9') {
+      value = value * 10 + c - '0';
+      if (isFraction) fraction *= 0.1;
+    }
+    s.read();
+    c = timedPeekOld(s);
+  } while ((c >= '0' && c <= '9') || c == '.');
+  if (isNegative) value = -value;
+  return isFraction ? value * fraction : value;
+}
+
+TextStream buffered(true);
+TextStream unbuffered(false);
+
+volatile long sinkLong;
+volatile float sinkFloat;
+
+// microseconds to parse the whole text, averaged over RUNS
+unsigned long timeFloat(TextStream &s, bool old)
+{
+  unsigned long start = micros();
+
+  for (int run = 0; run < RUNS; run++) {
+    s.rewind();
+    for (int i = 0; i < NUMBERS; i++)
+      sinkFloat = old ? parseFloatOld(s) : s.parseFloat();
+  }
+  return (micros() - start) / RUNS;
+}
+
+unsigned long timeInt(TextStream &s, bool old)
+{
+  unsigned long start = micros();
+
+  for (int run = 0; run < RUNS; run++) {
+    s.rewind();
+    for (int i = 0; i < NUMBERS; i++)
+      sinkLong = old ? parseIntOld(s) : s.parseInt();
+  }
+  return (micros() - start) / RUNS;
+}
+
+unsigned long timeFixed(TextStream &s)
+{
+  unsigned long start = micros();
+
+  for (int run = 0; run < RUNS; run++) {
+    s.rewind();
+    for (int i = 0; i < NUMBERS; i++)
+      sinkLong = s.parseFixed();
+  }
+  return (micros() - start) / RUNS;
+}
+
+void printTime(const char *label, unsigned long us)
+{
+  Serial.print(label);
+  Serial.print(us);
+  Serial.println(" us");
+}
+
+void setup()
+{
+  Serial.begin(9600);
+  buffered.setTimeout(TIMEOUT);
+  unbuffered.setTimeout(TIMEOUT);
+}
+
+void loop()
+{
+  TextStream oldStream(false);
+  int differ = 0;
+
+  // parseFloat() gathers the digits as one integer, so its result can be
+  // closer to the text than the old multiply per decimal, not further
+  buffered.rewind();
+  for (int i = 0; i < NUMBERS; i++) {
+    float f = buffered.parseFloat();
+    float fOld = parseFloatOld(oldStream);
+    if (f != fOld) {
+      Serial.print("float ");
+      Serial.print(i);
+      Serial.print(": ");
+      Serial.print(f, 6);
+      Serial.print(", old ");
+      Serial.println(fOld, 6);
+      differ++;
+    }
+  }
+  buffered.rewind();
+  oldStream.rewind();
+  for (int i = 0; i < NUMBERS; i++) {
+    long n = buffered.parseInt();
+    long nOld = parseIntOld(oldStream);
+    if (n != nOld) {
+      Serial.print("int ");
+      Serial.print(i);
+      Serial.print(": ");
+      Serial.print(n);
+      Serial.print(", old ");
+      Serial.println(nOld);
+      differ++;
+    }
+  }
+  Serial.print(differ);
+  Serial.println(" results differ");
+
+  Serial.print(NUMBERS);
+  Serial.println(" numbers per pass");
+  printTime("parseFloat(), buffered:   ", timeFloat(buffered, false));
+  printTime("parseFloat(), unbuffered: ", timeFloat(unbuffered, false));
+  printTime("old parseFloat():         ", timeFloat(unbuffered, true));
+  printTime("parseInt(), buffered:     ", timeInt(buffered, false));
+  printTime("parseInt(), unbuffered:   ", timeInt(unbuffered, false));
+  printTime("old parseInt():           ", timeInt(unbuffered, true));
+  printTime("parseFixed(), buffered:   ", timeFixed(buffered));
+
+  Serial.println();
+  delay(5000);
+}
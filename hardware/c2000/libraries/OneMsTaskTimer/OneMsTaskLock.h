@@ -0,0 +1,52 @@
+/*
+ OneMsTaskLock.h - interrupt lock around the OneMsTaskTimer task list
+
+ taskLock() turns interrupts off and returns how they were; taskUnlock()
+ puts them back that way. The library can then be called with interrupts
+ already off, or from a task callback inside the timer interrupt, without
+ turning them on behind the caller's back.
+
+ This library is free software; you can redistribute it and/or
+ modify it under the terms of the GNU Lesser General Public
+ License as published by the Free Software Foundation; either
+ version 2.1 of the License, or (at your option) any later version.
+ */
+
+#ifndef OneMsTaskLock_h
+#define OneMsTaskLock_h
+
+#include "Energia.h"
+
+#if defined(ti_sysbios_BIOS___VERS)
+#include <ti/sysbios/hal/Hwi.h>
+typedef UInt taskLockState;
+static inline taskLockState taskLock(void) { return Hwi_disable(); }
+static inline void taskUnlock(taskLockState key) { Hwi_restore(key); }
+
+#elif defined(__MSP430__)
+typedef uint16_t taskLockState;
+static inline taskLockState taskLock(void) {
+  taskLockState gie = __read_status_register() & GIE;
+  __disable_interrupt();
+  return gie;
+}
+static inline void taskUnlock(taskLockState gie) { __bis_SR_register(gie); }
+
+#elif defined(__TMS320C28XX__)
+// ST1 with INTM as it was before DINT
+typedef uint16_t taskLockState;
+static inline taskLockState taskLock(void) { return __disable_interrupts(); }
+static inline void taskUnlock(taskLockState st1) { __restore_interrupts(st1); }
+
+#else
+// TivaWare and CC3200 driverlib: noInterrupts() is IntMasterDisable(),
+// which returns true if PRIMASK was already set
+typedef bool taskLockState;
+static inline taskLockState taskLock(void) { return noInterrupts(); }
+static inline void taskUnlock(taskLockState wasDisabled) {
+  if (!wasDisabled)
+    interrupts();
+}
+#endif
+
+#endif
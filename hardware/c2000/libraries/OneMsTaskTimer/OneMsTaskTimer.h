@@ -57,6 +57,17 @@ How to use:
  
  Add a task to the list to be processed:
    OneMsTaskTimer::add(&myTask1); // 500ms period
+
+ Tasks are kept sorted by their next deadline, so each 1ms interrupt only
+ handles the tasks that are due. A task is added with optional flags:
+   OneMsTaskTimer::add(&myTask2, ONEMSTASK_ONESHOT);  // once, msecs from now
+   OneMsTaskTimer::add(&myTask3, ONEMSTASK_DEFERRED); // periodic, called from run()
+ Adding a task again re-arms it. Deferred tasks are not called in the ISR;
+ loop() calls them by calling:
+   OneMsTaskTimer::run();
+ myTask.overruns counts the calls a task missed: periods that were already
+ over, a deferred call still waiting for run(), or a callback that was still
+ running when its next deadline came.
   
  Then start the timer:
    OneMsTaskTimer::start();
@@ -82,18 +93,29 @@ How to use:
 
 #include <stdint.h>
 
+#define ONEMSTASK_ONESHOT   0x01  // call once, msecs after add()
+#define ONEMSTASK_DEFERRED  0x02  // call from OneMsTaskTimer::run() instead of the ISR
+#define ONEMSTASK_SCHEDULED 0x40  // internal
+#define ONEMSTASK_RUNNING   0x80  // internal
+
 typedef struct OneMsTaskTimer_t{
     uint32_t msecs;
     void (*func)();
     uint32_t count;
     OneMsTaskTimer_t * nextTask;
+    uint16_t overruns;
+    uint8_t flags;
+    volatile uint8_t pending;
+    OneMsTaskTimer_t * nextPending;
 } OneMsTaskTimer_t;
 
 
 namespace OneMsTaskTimer {
-//	extern volatile int8_t overflowing;
 	void add(OneMsTaskTimer_t * task);
+	void add(OneMsTaskTimer_t * task, uint8_t flags);
 	void remove(OneMsTaskTimer_t * task);
+	void run();
+	uint32_t tics();
 	void start();
 	void start(uint32_t timer_index);
 	void stop();
@@ -127,6 +127,26 @@ extern volatile boolean stay_asleep;
 void attachInterrupt(uint8_t, void (*)(void), int mode);
 void detachInterrupt(uint8_t);
 
+/* Pins of one port written or read together in a single register
+ * access. portGroupInit() returns 0, and leaves port at NOT_A_PORT, if
+ * the pins are not all on one port. The pins must already be set up
+ * with pinMode(); portWrite() changes only the bits in mask. */
+#define PORT_GROUP_AVAILABLE
+#define PORT_GROUP_SCATTERED 0xFF
+typedef struct {
+	uint8_t port;
+	uint8_t mask;		/* port bits of all pins in the group */
+	uint8_t shift;		/* value bit i is port bit shift + i, or PORT_GROUP_SCATTERED */
+	uint8_t count;
+	uint8_t bits[8];	/* port bit of each value bit */
+} PortGroup;
+
+uint8_t portGroupInit(PortGroup *group, const uint8_t *pins, uint8_t count);
+void portGroupWrite(const PortGroup *group, uint8_t value);
+uint8_t portGroupRead(const PortGroup *group);
+void portWrite(uint8_t port, uint8_t mask, uint8_t value);
+uint8_t portRead(uint8_t port);
+
 extern const uint8_t digital_pin_to_timer[];
 extern const uint8_t digital_pin_to_port[];
 extern const uint8_t digital_pin_to_bit_mask[];
@@ -147,6 +167,7 @@ extern const uint16_t digital_pin_to_pin_num[];
 #define digitalPinToADCIn(P)      ( digital_pin_to_analog_in[P] )
 #define portBASERegister(P)       ((volatile uint32_t *) port_to_base[P])
 #define portDATARegister(P)       ((volatile uint32_t *)( port_to_base[P] + 0x3FC ))
+#define portMaskedDATARegister(P, M) ((volatile uint32_t *)( port_to_base[P] + ((M) << 2) ))
 #define portDIRRegister(P)        ((volatile uint32_t *)( port_to_base[P] + 0x400 ))
 #define portIBERegister(P)        ((volatile uint32_t *)( port_to_base[P] + 0x408 ))
 #define portIEVRegister(P)        ((volatile uint32_t *)( port_to_base[P] + 0x40C ))
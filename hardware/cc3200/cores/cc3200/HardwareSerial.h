@@ -65,6 +65,8 @@ class HardwareSerial : public Stream
 		virtual int available(void);
 		virtual int peek(void);
 		virtual int read(void);
+		virtual int read(uint8_t *buffer, size_t size);
+		virtual size_t peekBuffer(const uint8_t **data);
 		virtual void flush(void);
 		void UARTIntHandler(void);
 		virtual size_t write(uint8_t c);
@@ -43,6 +43,10 @@ class Stream : public Print
     int timedRead();    // private method to read stream with timeout
     int timedPeek();    // private method to peek stream with timeout
     int peekNextDigit(); // returns the next numeric digit in the stream or -1 if timeout
+    size_t readAvailable(uint8_t *buffer, size_t length); // bulk read limited to available()
+    void skipBuffered(size_t count); // discards count bytes known to be buffered
+    int parseNumber(const char *skipChars, uint8_t maxFrac, unsigned long *intPart,
+                    unsigned long *frac, uint8_t *fracDigits); // engine behind parseInt(), parseFloat() and parseFixed()
 
   public:
     virtual int available() = 0;
@@ -50,6 +54,13 @@ class Stream : public Print
     virtual int peek() = 0;
     virtual void flush() = 0;
 
+    // bulk hooks; streams with a receive buffer override these so the
+    // helpers below can copy and scan buffered data instead of going
+    // through read() and the timeout one byte at a time
+    virtual int read(uint8_t *buffer, size_t length); // reads up to length bytes that are already available, never waits
+    virtual size_t peekBuffer(const uint8_t **data) { return 0; } // points data at the contiguous buffered bytes without consuming them
+    // returns how many there are, 0 if nothing is buffered or the stream has no buffer
+
     Stream() {_timeout=1000;}
 
 // parsing methods
@@ -71,7 +82,14 @@ class Stream : public Print
   // initial characters that are not digits (or the minus sign) are skipped
   // integer is terminated by the first character that is not a digit.
 
+  long parseInt(const char *skipChars); // as parseInt() but any of the skipChars inside the number are ignored
+  // e.g. parseInt(",_") reads "1,000_000" as 1000000
+
   float parseFloat();               // float version of parseInt
+  float parseFloat(const char *skipChars);
+
+  long parseFixed();                // as parseFloat() but returns Q16.16 fixed point, no floating point math
+  long parseFixed(const char *skipChars); // the integer part must fit in 15 bits, 5 decimals are kept
 
   size_t readBytes( char *buffer, size_t length); // read chars from stream into buffer
   // terminates if length characters have been read or timeout (see setTimeout)
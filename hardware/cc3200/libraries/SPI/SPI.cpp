@@ -52,11 +52,19 @@ static const unsigned long g_ulSSIPinModes[][4] = {
 SPIClass::SPIClass(void) {
 	SSIModule = BOOST_PACK_SPI;
 	SSIBitOrder = MSBFIRST;
+	queueHead = 0;
+	queueActive = 0;
+	queueHeld = 0;
+	queueRunning = 0;
 }
 
 SPIClass::SPIClass(uint8_t module) {
 	SSIModule = module;
 	SSIBitOrder = MSBFIRST;
+	queueHead = 0;
+	queueActive = 0;
+	queueHeld = 0;
+	queueRunning = 0;
 }
   
 void SPIClass::begin() {
@@ -88,6 +96,9 @@ void SPIClass::begin() {
 				SPI_WL_8));
 
 	MAP_SPIEnable(SSIBASE);
+
+	SSIDataMode = SPI_MODE0;
+	SSIDivider = 0;	/* set by the bit rate, not a divider */
 }
 
 void SPIClass::end()
@@ -110,6 +121,7 @@ void SPIClass::setDataMode(uint8_t mode)
 	MAP_PRCMPeripheralClkEnable(PRCM_GSPI, PRCM_RUN_MODE_CLK);
 	HWREG(SSIBASE + MCSPI_O_CH0CONF) &= ~SPI_MODE_MASK;
 	HWREG(SSIBASE + MCSPI_O_CH0CONF) |= mode;
+	SSIDataMode = mode;
 }
 
 void SPIClass::setClockDivider(uint8_t divider)
@@ -128,6 +140,7 @@ void SPIClass::setClockDivider(uint8_t divider)
 	HWREG(SSIBASE + MCSPI_O_CH0CTRL) &= ~SPI_EXTCLK_MASK;
 	HWREG(SSIBASE + MCSPI_O_CH0CTRL) |= ((_divider & 0x00000FF0) << 4);
 	SPIEnable(SSIBASE);
+	SSIDivider = divider;
 }
 
 uint8_t SPIClass::transfer(uint8_t data)
@@ -162,4 +175,168 @@ void SPIClass::setModule(uint8_t module) {
 	begin();
 }
 
+/*
+ * Transaction queue. The bus is run from the receive interrupt, one byte
+ * per interrupt: each byte received is stored and the next one sent.
+ */
+static SPIClass *g_pSPIQueueOwner;
+
+static void SPIQueueIntHandler(void)
+{
+	if(g_pSPIQueueOwner)
+		g_pSPIQueueOwner->handleInterrupt();
+}
+
+static inline uint8_t reverseBits(uint32_t data)
+{
+	asm("rbit %0, %1" : "=r" (data) : "r" (data));	// reverse order of 32 bits
+	return (uint8_t) (data >> 24);
+}
+
+void SPIClass::attachDevice(SPIDevice *device)
+{
+	pinMode(device->csPin, OUTPUT);
+	digitalWrite(device->csPin, HIGH);
+}
+
+void SPIClass::queue(SPITransaction *t)
+{
+	SPITransaction **link, **after = 0;
+	bool start = false;
+
+	t->done = 0;
+
+	tBoolean wasDisabled = MAP_IntMasterDisable();
+	/* Behind everything of the same or higher priority, but straight
+	 * after the device's own transactions if it has some queued there */
+	for(link = &queueHead; *link && (*link)->device->priority >= t->device->priority; link = &(*link)->next) {
+		if((*link)->device == t->device)
+			after = &(*link)->next;
+	}
+	if(after)
+		link = after;
+	t->next = *link;
+	*link = t;
+	if(!queueRunning) {
+		queueRunning = 1;
+		start = true;
+	}
+	if(!wasDisabled)
+		MAP_IntMasterEnable();
+
+	if(start)
+		runQueue();
+}
+
+bool SPIClass::queueBusy()
+{
+	return queueRunning;
+}
+
+void SPIClass::runQueue()
+{
+	SPITransaction *t, **link;
+
+	for(;;) {
+		tBoolean wasDisabled = MAP_IntMasterDisable();
+		/* while chip select is held only that device may use the bus */
+		for(link = &queueHead; *link && queueHeld && (*link)->device != queueHeld; link = &(*link)->next)
+			;
+		t = *link;
+		if(t)
+			*link = t->next;
+		else
+			queueRunning = 0;
+		if(!wasDisabled)
+			MAP_IntMasterEnable();
+		if(!t)
+			return;
+
+		applyDevice(t->device);
+		if(queueHeld != t->device)
+			digitalWrite(t->device->csPin, LOW);
+		queueActive = t;
+		if(startTransaction(t))
+			return;	/* finished from the interrupt */
+		finishTransaction(t);
+	}
+}
+
+void SPIClass::applyDevice(SPIDevice *device)
+{
+	if(device->dataMode != SSIDataMode)
+		setDataMode(device->dataMode);
+	if(device->clockDivider != SSIDivider)
+		setClockDivider(device->clockDivider);
+	SSIBitOrder = device->bitOrder;
+}
+
+bool SPIClass::startTransaction(SPITransaction *t)
+{
+	unsigned long data;
+
+	if(!t->count)
+		return false;
+
+	if(g_pSPIQueueOwner != this) {
+		g_pSPIQueueOwner = this;
+		MAP_SPIIntRegister(SSIBASE, SPIQueueIntHandler);
+	}
+
+	while(MAP_SPIDataGetNonBlocking(SSIBASE, &data));
+
+	queueIndex = 0;
+	MAP_SPIIntClear(SSIBASE, SPI_INT_RX_FULL);
+	MAP_SPIIntEnable(SSIBASE, SPI_INT_RX_FULL);
+	putByte(t);
+	return true;
+}
+
+void SPIClass::putByte(SPITransaction *t)
+{
+	uint8_t data = t->buf[queueIndex];
+
+	if(SSIBitOrder == LSBFIRST)
+		data = reverseBits(data);
+	MAP_SPIDataPutNonBlocking(SSIBASE, data);
+}
+
+void SPIClass::finishTransaction(SPITransaction *t)
+{
+	queueActive = 0;
+	if(t->flags & SPI_KEEP_CS) {
+		queueHeld = t->device;
+	} else {
+		digitalWrite(t->device->csPin, HIGH);
+		queueHeld = 0;
+	}
+	t->done = 1;
+	if(t->callback)
+		t->callback(t);
+}
+
+void SPIClass::handleInterrupt()
+{
+	SPITransaction *t = queueActive;
+	unsigned long data;
+
+	MAP_SPIIntClear(SSIBASE, SPI_INT_RX_FULL);
+	if(!t || !MAP_SPIDataGetNonBlocking(SSIBASE, &data)) {
+		if(!t)
+			MAP_SPIIntDisable(SSIBASE, SPI_INT_RX_FULL);
+		return;
+	}
+
+	if(!(t->flags & SPI_TX_ONLY))
+		t->buf[queueIndex] = (SSIBitOrder == LSBFIRST) ? reverseBits(data) : (uint8_t) data;
+	if(++queueIndex < t->count) {
+		putByte(t);
+		return;
+	}
+
+	MAP_SPIIntDisable(SSIBASE, SPI_INT_RX_FULL);
+	finishTransaction(t);
+	runQueue();
+}
+
 SPIClass SPI(0);
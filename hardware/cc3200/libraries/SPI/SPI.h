@@ -36,11 +36,57 @@
 #define MSBFIRST 1
 #define LSBFIRST 0
 
+/*
+ * Transaction queue for devices sharing the bus. Transactions run in
+ * order of device priority, those of one device are kept together, and
+ * the bus is only reconfigured when the settings change. Chip select is
+ * driven low for the transaction and high after it, unless SPI_KEEP_CS
+ * asks to hold it for the device's next transaction. The callback runs
+ * from the completion interrupt where the bus is interrupt or DMA driven.
+ * Do not call transfer() while the queue is busy.
+ */
+#define SPI_QUEUE_AVAILABLE
+
+#define SPI_TX_ONLY 0x01	// leave buf alone and drop the bytes received
+#define SPI_KEEP_CS 0x02	// keep chip select low after the transaction
+
+struct SPIDevice {
+	uint8_t csPin;
+	uint8_t dataMode;
+	uint8_t clockDivider;
+	uint8_t bitOrder;
+	uint8_t priority;	// higher runs first
+};
+
+struct SPITransaction {
+	SPIDevice *device;
+	uint8_t *buf;		// sent, then overwritten with the bytes received
+	uint16_t count;
+	uint8_t flags;
+	void (*callback)(SPITransaction *);
+	volatile uint8_t done;
+	SPITransaction *next;
+};
+
 class SPIClass
 {
 	private:
 		uint8_t SSIModule;
 		uint8_t SSIBitOrder;
+		uint8_t SSIDataMode;
+		uint8_t SSIDivider;
+
+		SPITransaction *queueHead;
+		SPITransaction * volatile queueActive;
+		SPIDevice *queueHeld;
+		volatile uint8_t queueRunning;
+		uint16_t queueIndex;
+
+		void runQueue();
+		void applyDevice(SPIDevice *device);
+		bool startTransaction(SPITransaction *t);
+		void finishTransaction(SPITransaction *t);
+		void putByte(SPITransaction *t);
 
 	public:
 		SPIClass(void);
@@ -57,6 +103,12 @@ class SPIClass
 
 		uint8_t transfer(uint8_t);
 		void setModule(uint8_t module);
+
+		void attachDevice(SPIDevice *device);
+		void queue(SPITransaction *t);
+		bool queueBusy();
+		// called from the SPI interrupt while the queue runs
+		void handleInterrupt();
 };
 
 extern SPIClass SPI;
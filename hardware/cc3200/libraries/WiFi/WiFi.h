@@ -51,6 +51,9 @@ private:
     static WiFiClient clients[MAX_SOCK_NUM];
     static int8_t role;
     static char fwVersion[WL_FW_VER_LENGTH];
+    static bool _pollActive;
+    static SlFdSet_t _polledSet;
+    static SlFdSet_t _readySet;
 public:
     static int16_t _handleArray[MAX_SOCK_NUM];
     static int16_t _portArray[MAX_SOCK_NUM];
@@ -88,6 +91,30 @@ public:
      * Get the first socket available
      */
     static uint8_t getSocket();
+
+    /*
+     * Check all open client, server and UDP sockets for pending data with a
+     * single sl_Select and cache the result until the next call. Sockets that
+     * were polled and found idle then answer available(), parsePacket() and
+     * server available() without an SPI round trip of their own. Client
+     * output held back by setNoDelay(false) for TCP_TX_COALESCE_MS is sent
+     * first.
+     *
+     * param timeout: time to wait for a socket to become readable in milliseconds
+     *
+     * return: number of readable sockets, 0 on timeout or a negative SimpleLink error
+     */
+    int poll(unsigned long timeout = 0);
+
+    /*
+     * Readiness cache maintained by poll(). _pollCovers() tells whether the
+     * last poll() included the handle, _pollReady() is true unless it did
+     * and found nothing to read.
+     */
+    static bool _pollCovers(int16_t handle);
+    static bool _pollReady(int16_t handle);
+    static void _pollIdle(int16_t handle);
+    static void _pollForget(int16_t handle);
     
     /*
      * Get firmware and driver version
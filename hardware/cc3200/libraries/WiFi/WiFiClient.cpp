@@ -41,6 +41,46 @@ extern "C" {
 #include "WiFiClient.h"
 #include "WiFiServer.h"
 
+//
+//coalescing state of each socket: the buffer, allocated the first time the
+//socket coalesces and kept for later connections on it, how much of it is
+//filled and when the first of those bytes was written. It belongs to the socket
+//rather than to the object since WiFiClient objects are copied around by value
+//(see ~WiFiClient), and so that WiFi.poll() can send what has waited too long
+//
+static struct {
+    uint8_t *buffer;
+    int fillLevel;
+    unsigned long firstWrite;
+} tx_sockets[MAX_SOCK_NUM];
+
+static uint8_t *txBuffer(int socketIndex)
+{
+    if (tx_sockets[socketIndex].buffer == NULL) {
+        tx_sockets[socketIndex].buffer = (uint8_t *)malloc(TCP_TX_BUFF_MAX_SIZE);
+    }
+    return tx_sockets[socketIndex].buffer;
+}
+
+//
+//sl_Send with a paced retry while SimpleLink applies flow control
+//
+static int slSend(int16_t handle, const uint8_t *buffer, size_t size)
+{
+    int iRet = sl_Send(handle, buffer, size, 0);
+
+    // Flow control signal; perform a paced-retry.
+    while (iRet == SL_EAGAIN) {
+        delay(10);
+#ifndef SL_PLATFORM_MULTI_THREADED$
+        /* HACK: required in nonos builds, otherwise we hang in this loop */
+        sl_Task();
+#endif
+        iRet = sl_Send(handle, buffer, size, 0);
+    }
+    return iRet;
+}
+
 //--tested, working--//
 //--client side--//
 WiFiClient::WiFiClient()
@@ -50,6 +90,7 @@ WiFiClient::WiFiClient()
     //
     rx_currentIndex = 0;
     rx_fillLevel = 0;
+    tx_coalesce = false;
     _socketIndex = NO_SOCKET_AVAIL;
     hasRootCA = false;
     sslVerifyStrict = false;
@@ -65,6 +106,7 @@ WiFiClient::WiFiClient(uint8_t socketIndex)
     //
     rx_currentIndex = 0;
     rx_fillLevel = 0;
+    tx_coalesce = false;
     _socketIndex = socketIndex;
 }
 
@@ -154,6 +196,8 @@ int WiFiClient::connect(IPAddress ip, uint16_t port)
     //
     _socketIndex = socketIndex;
     WiFiClass::_handleArray[socketIndex] = socketHandle;
+    WiFiClass::_pollForget(socketHandle);
+    _txForget(socketIndex);
     WiFiClass::_typeArray[socketIndex] = TYPE_TCP_CLIENT;
     WiFiClass::_portArray[socketIndex] = port;
     return true;
@@ -246,6 +290,8 @@ int WiFiClient::sslConnect(IPAddress ip, uint16_t port)
     //
     _socketIndex = socketIndex;
     WiFiClass::_handleArray[socketIndex] = socketHandle;
+    WiFiClass::_pollForget(socketHandle);
+    _txForget(socketIndex);
     WiFiClass::_typeArray[socketIndex] = TYPE_TCP_CLIENT;
     WiFiClass::_portArray[socketIndex] = port;
     return true;
@@ -351,20 +397,47 @@ size_t WiFiClient::write(const uint8_t *buffer, size_t size)
         return 0;
     }
 
+    if (!tx_coalesce) {
+        return send(buffer, size);
+    }
+
     //
-    //write the buffer to the socket
+    //send what has been waiting too long, or what the new data doesn't fit behind
     //
-    int iRet = sl_Send(WiFiClass::_handleArray[_socketIndex], buffer, size, 0);
+    int fillLevel = tx_sockets[_socketIndex].fillLevel;
+    if (fillLevel > 0 && ((millis() - tx_sockets[_socketIndex].firstWrite) >= TCP_TX_COALESCE_MS
+            || fillLevel + size > TCP_TX_BUFF_MAX_SIZE)) {
+        if (!flushTx()) {
+            return 0;
+        }
+    }
 
-    // Flow control signal; perform a paced-retry.
-    while (iRet == SL_EAGAIN) {
-        delay(10);
-#ifndef SL_PLATFORM_MULTI_THREADED$
-        /* HACK: required in nonos builds, otherwise we hang in this loop */
-        sl_Task();
-#endif
-        iRet = sl_Send(WiFiClass::_handleArray[_socketIndex], buffer, size, 0);
+    //
+    //writes as large as the buffer gain nothing from a copy, and without
+    //memory for the buffer the data goes out as it comes
+    //
+    uint8_t *tx_buffer = txBuffer(_socketIndex);
+    if (size >= TCP_TX_BUFF_MAX_SIZE || tx_buffer == NULL) {
+        return send(buffer, size);
+    }
+
+    if (tx_sockets[_socketIndex].fillLevel == 0) {
+        tx_sockets[_socketIndex].firstWrite = millis();
     }
+    memcpy(&tx_buffer[tx_sockets[_socketIndex].fillLevel], buffer, size);
+    tx_sockets[_socketIndex].fillLevel += size;
+    return size;
+}
+
+//
+//write the buffer to the socket, retrying while SimpleLink applies flow control
+//
+size_t WiFiClient::send(const uint8_t *buffer, size_t size)
+{
+    //
+    //write the buffer to the socket
+    //
+    int iRet = slSend(WiFiClass::_handleArray[_socketIndex], buffer, size);
 
     if ((iRet < 0) || (iRet != size)) {
         //
@@ -378,6 +451,65 @@ size_t WiFiClient::write(const uint8_t *buffer, size_t size)
     }
 }
 
+//
+//send the coalesced data, if any. Returns false if the connection died
+//
+boolean WiFiClient::flushTx()
+{
+    if (_socketIndex == NO_SOCKET_AVAIL || tx_sockets[_socketIndex].fillLevel == 0) {
+        return true;
+    }
+
+    //
+    //empty the buffer first: send() calls stop() on failure, which flushes again
+    //
+    int len = tx_sockets[_socketIndex].fillLevel;
+    tx_sockets[_socketIndex].fillLevel = 0;
+    return send(tx_sockets[_socketIndex].buffer, len) == (size_t)len;
+}
+
+//
+//called by WiFi.poll(): send the coalesced data that has waited
+//TCP_TX_COALESCE_MS. A failed send is left for the client's next call to find,
+//since the object that owns the socket is not at hand here
+//
+void WiFiClient::_txExpire()
+{
+    unsigned long now = millis();
+
+    for (uint8_t i = 0; i < MAX_SOCK_NUM; ++i) {
+        int len = tx_sockets[i].fillLevel;
+        if (len == 0 || (now - tx_sockets[i].firstWrite) < TCP_TX_COALESCE_MS) {
+            continue;
+        }
+        tx_sockets[i].fillLevel = 0;
+        if (WiFiClass::_handleArray[i] >= 0) {
+            slSend(WiFiClass::_handleArray[i], tx_sockets[i].buffer, len);
+        }
+    }
+}
+
+//
+//a new connection on the socket starts with an empty buffer
+//
+void WiFiClient::_txForget(uint8_t socketIndex)
+{
+    tx_sockets[socketIndex].fillLevel = 0;
+}
+
+void WiFiClient::setNoDelay(boolean noDelay)
+{
+    if (noDelay) {
+        flushTx();
+    }
+    tx_coalesce = !noDelay;
+}
+
+boolean WiFiClient::getNoDelay()
+{
+    return !tx_coalesce;
+}
+
 //--tested, working--//
 //--client and server side--//
 int WiFiClient::available()
@@ -388,6 +520,14 @@ int WiFiClient::available()
     if (_socketIndex == NO_SOCKET_AVAIL) {
         return 0;
     }
+
+    //
+    //a client that looks for a reply is done writing its request
+    //
+    flushTx();
+    if (_socketIndex == NO_SOCKET_AVAIL) {
+        return 0;
+    }
     
     //
     //if the buffer doesn't have any data in it or we've read everything
@@ -395,42 +535,26 @@ int WiFiClient::available()
     //
     int bytesLeft = rx_fillLevel - rx_currentIndex;
     if (bytesLeft <= 0) {
-        SlTimeval_t timeout;
-        memset(&timeout, 0, sizeof(SlTimeval_t));
-        timeout.tv_sec = 0;
-        timeout.tv_usec = 500;
-        SlFdSet_t readsds, errorsds;
-        SL_FD_ZERO(&readsds);
-        SL_FD_ZERO(&errorsds);
-        SL_FD_SET(WiFiClass::_handleArray[_socketIndex], &readsds);
-        SL_FD_SET(WiFiClass::_handleArray[_socketIndex], &errorsds);
-
-//        sl_Select(WiFiClass::_handleArray[_socketIndex] + 1, &readsds, NULL, &errorsds, &timeout);
-//        if(!SL_FD_ISSET(WiFiClass::_handleArray[_socketIndex], &readsds)) return 0;
+        //
+        //skip the SPI transaction if the last WiFi.poll() found nothing to read
+        //
+        if (!WiFiClass::_pollReady(WiFiClass::_handleArray[_socketIndex])) {
+            return 0;
+        }
 
         //
         //Receive any pending information into the buffer
-        //if the connection has died, call stop() to make the object aware it's dead
         //
-        int iRet = sl_Recv(WiFiClass::_handleArray[_socketIndex], rx_buffer, TCP_RX_BUFF_MAX_SIZE, 0);
-        if ((iRet <= 0)  &&  (iRet != SL_EAGAIN)) {
-            sl_Close(WiFiClass::_handleArray[_socketIndex]);
-
-            WiFiClass::_portArray[_socketIndex] = -1;
-            WiFiClass::_handleArray[_socketIndex] = -1;
-            WiFiClass::_typeArray[_socketIndex] = -1;
-            _socketIndex = NO_SOCKET_AVAIL;
-
-            memset(rx_buffer, 0, TCP_RX_BUFF_MAX_SIZE);
+        int iRet = receive(rx_buffer, TCP_RX_BUFF_MAX_SIZE);
+        if (iRet < 0) {
             return 0;
         }
         
         //
         //receive successful. Reset rx index pointer and set buffer fill level indicator
-        //(if SL_EAGAIN was received, the actual number of bytes received was zero, not -11)
         //
         rx_currentIndex = 0;
-        rx_fillLevel = (iRet != SL_EAGAIN) ? iRet : 0;
+        rx_fillLevel = iRet;
         bytesLeft = rx_fillLevel - rx_currentIndex;
     }
     
@@ -463,11 +587,33 @@ int WiFiClient::read(uint8_t* buf, size_t size)
     //
     // read up to the requested number of bytes into the buffer
     // uses direct buffer copies to speed things up
+    //
+    int len = rx_fillLevel - rx_currentIndex;
+
+    //
+    // with the internal buffer drained and a caller buffer at least as large,
+    // let SimpleLink write straight into it instead of going through rx_buffer
+    //
+    if (len <= 0 && size >= TCP_RX_BUFF_MAX_SIZE) {
+        flushTx();
+        if (_socketIndex == NO_SOCKET_AVAIL) {
+            return 0;
+        }
+        if (!WiFiClass::_pollReady(WiFiClass::_handleArray[_socketIndex])) {
+            return 0;
+        }
+        if (size > SL_TCP_RX_MAX_PAYLOAD) {
+            size = SL_TCP_RX_MAX_PAYLOAD;
+        }
+        len = receive(buf, size);
+        return (len < 0) ? 0 : len;
+    }
+
     if (!available()) {
         return 0;
     }
 
-    int len = rx_fillLevel - rx_currentIndex;
+    len = rx_fillLevel - rx_currentIndex;
     if (len > size) {
         len = size;
     }
@@ -490,13 +636,29 @@ int WiFiClient::peek()
     }
 }
 
+size_t WiFiClient::peekBuffer(const uint8_t **data)
+{
+    //
+    //expose the unread part of rx_buffer, receiving more first if it is empty
+    //
+    if (!available()) {
+        return 0;
+    }
+    *data = &rx_buffer[rx_currentIndex];
+    return rx_fillLevel - rx_currentIndex;
+}
+
 //--tested, working--//
 void WiFiClient::flush()
 {
     //
-    //clear out the buffer and reset all the buffer indicators
+    //send any coalesced output
+    //
+    flushTx();
+
+    //
+    //discard the buffered data by resetting the buffer indicators
     //
-    memset(rx_buffer, 0, TCP_RX_BUFF_MAX_SIZE);
     rx_fillLevel = 0;
     rx_currentIndex = 0;
 }
@@ -511,6 +673,14 @@ void WiFiClient::stop()
         return;
     }
     
+    //
+    //send any coalesced output before closing
+    //
+    flushTx();
+    if (_socketIndex == NO_SOCKET_AVAIL) {
+        return;
+    }
+
     //
     //disconnect, destroy the socket, and reset the socket tracking variables
     //in WiFiClass, but don't destroy any of the received data
@@ -530,6 +700,32 @@ void WiFiClient::stop()
     
 }
 
+//
+//receive pending data from the socket into buf. Returns the number of bytes
+//received (0 if nothing is pending) or -1 if the connection has died, in which
+//case the socket is closed to make the object aware it's dead
+//
+int WiFiClient::receive(uint8_t* buf, int size)
+{
+    int iRet = sl_Recv(WiFiClass::_handleArray[_socketIndex], buf, size, 0);
+    if (iRet == SL_EAGAIN) {
+        WiFiClass::_pollIdle(WiFiClass::_handleArray[_socketIndex]);
+        return 0;
+    }
+
+    if (iRet <= 0) {
+        sl_Close(WiFiClass::_handleArray[_socketIndex]);
+
+        WiFiClass::_portArray[_socketIndex] = -1;
+        WiFiClass::_handleArray[_socketIndex] = -1;
+        WiFiClass::_typeArray[_socketIndex] = -1;
+        _socketIndex = NO_SOCKET_AVAIL;
+        return -1;
+    }
+
+    return iRet;
+}
+
 //!! works, sort of, dependent on status(), which needs work !!//
 uint8_t WiFiClient::connected()
 {
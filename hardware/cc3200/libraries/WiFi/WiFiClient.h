@@ -24,7 +24,29 @@
 #include <Stream.h>
 #include <Client.h>
 
+//
+//Size of the per-client receive buffer, 255 bytes by default and at most
+//SL_TCP_RX_MAX_PAYLOAD (1460), the largest TCP payload SimpleLink hands back
+//in one sl_Recv. WiFiClass::clients[] holds MAX_SOCK_NUM copies of it.
+//It sizes a member of WiFiClient, so a #define in a sketch can not change
+//it; build everything with -DWIFI_TCP_RX_BUFFER_SIZE=<n> instead.
+//
+#define SL_TCP_RX_MAX_PAYLOAD 1460
+#if defined(WIFI_TCP_RX_BUFFER_SIZE)
+#define TCP_RX_BUFF_MAX_SIZE WIFI_TCP_RX_BUFFER_SIZE
+#else
 #define TCP_RX_BUFF_MAX_SIZE 255
+#endif
+#if TCP_RX_BUFF_MAX_SIZE > SL_TCP_RX_MAX_PAYLOAD
+#error "WIFI_TCP_RX_BUFFER_SIZE exceeds the SimpleLink TCP payload size"
+#endif
+
+//
+//Size of the transmit coalescing buffer used after setNoDelay(false), and the
+//longest time buffered data may wait for more writes before it is sent anyway
+//
+#define TCP_TX_BUFF_MAX_SIZE 255
+#define TCP_TX_COALESCE_MS 20
 
 //
 //Inhereting from stream (which inherits from print)
@@ -54,13 +76,33 @@ public:
     virtual int read();
     virtual int read(uint8_t* buf, size_t size);
     virtual int peek();
+    virtual size_t peekBuffer(const uint8_t **data);
     virtual void flush();
     virtual void stop();
     virtual uint8_t connected();
     virtual operator bool();
+
+    //
+    //With noDelay false, small writes are gathered and sent with one sl_Send
+    //when the buffer fills, on flush() or stop(), or as soon as the client
+    //calls available(), read() or connected(). Default is true.
+    //Data that has waited TCP_TX_COALESCE_MS is also sent by the next write()
+    //or WiFi.poll(), so a sketch that writes and then goes quiet should keep
+    //calling WiFi.poll() or call flush() for the last bytes to go out.
+    //
+    void setNoDelay(boolean noDelay);
+    boolean getNoDelay();
     
     friend class WiFiServer;
 
+    //
+    //Coalescing state is kept per socket. _txExpire() sends what has waited
+    //TCP_TX_COALESCE_MS on any socket and is called by WiFi.poll();
+    //_txForget() empties the buffer of a socket that gets a new connection.
+    //
+    static void _txExpire();
+    static void _txForget(uint8_t socketIndex);
+
     boolean sslIsVerified;
     
 protected:
@@ -68,9 +110,15 @@ protected:
     uint8_t rx_buffer[TCP_RX_BUFF_MAX_SIZE];
     int rx_fillLevel;
     int rx_currentIndex;
+    boolean tx_coalesce;
     boolean sslVerifyStrict;
     boolean hasRootCA;
     int32_t sslLastError;
+
+private:
+    int receive(uint8_t* buf, int size);
+    size_t send(const uint8_t* buffer, size_t size);
+    boolean flushTx();
 };
 
 #endif
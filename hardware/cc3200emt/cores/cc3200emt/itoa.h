@@ -35,6 +35,20 @@ extern char* utoa( unsigned long value, char *string, int radix ) ;
 extern char* ultoa( unsigned long value, char *string, int radix ) ;
 #endif /* 0 */
 
+/* Writes the digits of value backwards into the characters before end,
+ * without a terminating zero, and returns a pointer to the first digit.
+ * radix is 2 to 36; upper selects 'A'-'Z' over 'a'-'z' for digits >= 10. */
+extern char* utoa_digits( unsigned long value, char *end, int radix, int upper ) ;
+
+/* Writes value with prec (at most FTOA_MAX_PREC) decimals and a
+ * terminating zero to string, which must hold FTOA_BUF_SIZE characters.
+ * Returns the number of characters written, not counting the zero.
+ * ftoaf() does the math in single precision. */
+#define FTOA_MAX_PREC 9
+#define FTOA_BUF_SIZE (1 + 10 + 1 + FTOA_MAX_PREC + 1)
+extern int ftoa( double value, char *string, int prec ) ;
+extern int ftoaf( float value, char *string, int prec ) ;
+
 #ifdef __cplusplus
 } // extern "C"
 #endif // __cplusplus
@@ -387,6 +387,32 @@ int HardwareSerial::read(void)
 	return cChar;
 }
 
+// copy out of the ring in at most two pieces, never waits
+int HardwareSerial::read(uint8_t *buffer, size_t size)
+{
+    const uint8_t *data;
+    size_t count = 0, n;
+
+    while (count < size && (n = peekBuffer(&data)) > 0) {
+        if (n > size - count)
+            n = size - count;
+        memcpy(buffer + count, data, n);
+        count += n;
+        rxReadIndex = (rxReadIndex + n) % rxBufferSize;
+    }
+    return count;
+}
+
+// the bytes from rxReadIndex up to rxWriteIndex, or up to the end of the
+// ring if it wraps
+size_t HardwareSerial::peekBuffer(const uint8_t **data)
+{
+    unsigned long writeIndex = rxWriteIndex;
+
+    *data = &rxBuffer[rxReadIndex];
+    return (writeIndex >= rxReadIndex ? writeIndex : rxBufferSize) - rxReadIndex;
+}
+
 void HardwareSerial::flush()
 {
     while(!TX_BUFFER_EMPTY);
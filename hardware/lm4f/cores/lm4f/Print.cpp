@@ -24,8 +24,10 @@
 #include <stdio.h>
 #include <string.h>
 #include <math.h>
+#include <stdarg.h>
 #include "Energia.h"
 #include "Print.h"
+#include "itoa.h"
 
 // Public Methods //////////////////////////////////////////////////////////////
 
@@ -78,13 +80,12 @@ size_t Print::print(long n, int base)
 {
     if (base == 0) {
         return write(n);
-    } else if (base == 10) {
-        if (n < 0) {
-            int t = print('-');
-            n = -n;
-            return printNumber(n, 10) + t;
-        }
-        return printNumber(n, 10);
+    } else if (base == 10 && n < 0) {
+        // sign and digits go out in one write
+        char buf[8 * sizeof(long) + 1];
+        char *str = utoa_digits(-(unsigned long)n, &buf[sizeof(buf)], 10, 1);
+        *--str = '-';
+        return write((const uint8_t *)str, &buf[sizeof(buf)] - str);
     } else {
         return printNumber(n, base);
     }
@@ -202,103 +203,238 @@ size_t Print::println(const Printable& x)
     return n;
 }
 
-// Private Methods /////////////////////////////////////////////////////////////
-
-size_t Print::printNumber(unsigned long n, uint8_t base) {
-    char buf[8 * sizeof(long) + 1]; // Assumes 8-bit chars plus zero byte.
-    char *str = &buf[sizeof(buf) - 1];
+// printf() output is collected in a stack buffer of this size and handed
+// to write() a chunk at a time
+#ifndef PRINTF_BUF_SIZE
+#define PRINTF_BUF_SIZE 16
+#endif
 
-    *str = '\0';
+struct PrintfSink {
+    Print *out;
+    size_t n;
+    uint8_t len;
+    char buf[PRINTF_BUF_SIZE];
+};
 
-    // prevent crash if called with base == 1
-    if (base < 2) base = 10;
+static void printfFlush(PrintfSink &s)
+{
+    if (s.len) {
+        s.n += s.out->write((const uint8_t *)s.buf, s.len);
+        s.len = 0;
+    }
+}
 
-    do {
-        unsigned long m = n;
-        n /= base;
-        char c = m - base * n;
-        *--str = c < 10 ? c + '0' : c + 'A' - 10;
-    } while(n);
+static void printfPut(PrintfSink &s, char c, unsigned int count)
+{
+    while (count--) {
+        s.buf[s.len++] = c;
+        if (s.len == sizeof(s.buf)) printfFlush(s);
+    }
+}
 
-    return write(str);
+// a field padded to width, with zeros leading zeros from the precision;
+// long strings go to write() without a copy
+static void printfField(PrintfSink &s, const char *str, size_t len, unsigned int width, char pad, bool left, unsigned int zeros)
+{
+    unsigned int fill = width > len + zeros ? width - len - zeros : 0;
+
+    if (!left && pad == ' ') printfPut(s, ' ', fill);
+    // zero padding and the precision's zeros go between the sign and the digits
+    if ((pad == '0' || zeros) && len && *str == '-') {
+        printfPut(s, '-', 1);
+        str++;
+        len--;
+    }
+    if (!left && pad == '0') printfPut(s, '0', fill);
+    printfPut(s, '0', zeros);
+    if (s.len + len > sizeof(s.buf)) {
+        printfFlush(s);
+        s.n += s.out->write((const uint8_t *)str, len);
+    } else {
+        memcpy(&s.buf[s.len], str, len);
+        s.len += len;
+    }
+    if (left) printfPut(s, ' ', fill);
 }
 
-size_t Print::printFloat(double number, uint8_t digits) 
-{ 
-    size_t n = 0;
+// The precision of an integer conversion is its minimum number of digits
+// and turns off the '0' flag, as in C. Returns the zeros to add in front
+// of digits; a precision of 0 prints no digit for the value 0.
+static unsigned int printfPrecision(char *&digits, const char *end, int prec, char &pad)
+{
+    size_t n = end - digits;
 
-    // Handle negative numbers
-    if (number < 0.0)
-    {
-        n += print('-');
-        number = -number;
+    if (prec < 0) return 0;
+    pad = ' ';
+    if (prec == 0 && n == 1 && *digits == '0') {
+        digits++;
+        return 0;
     }
+    return (size_t)prec > n ? prec - n : 0;
+}
 
-    // Round correctly so that print(1.999, 2) prints as "2.00"
-    double rounding = 0.5;
-    for (uint8_t i=0; i<digits; ++i)
-        rounding /= 10.0;
+/*
+ * Formatted output without heap or sprintf: flags '-' and '0', width and
+ * precision (also '*'), the 'l' modifier and the conversions
+ * d i u x X o c s f %. The precision is the minimum number of digits for
+ * d i u x X o, the number of decimals for f and the maximum length for s. Floats are fixed point with at most FTOA_MAX_PREC
+ * decimals; build with PRINTF_NO_FLOAT to leave the float code out.
+ */
+size_t Print::printf(const char *format, ...)
+{
+    PrintfSink s;
+    va_list args;
+    char num[8 * sizeof(long) + 2];
+    const char *str;
+    size_t len;
+    unsigned int width, zeros;
+    int prec;
+    char pad;
+    bool left, islong;
+    char c;
+
+    s.out = this;
+    s.n = 0;
+    s.len = 0;
+
+    va_start(args, format);
+    while ((c = *format++) != 0) {
+        if (c != '%') {
+            printfPut(s, c, 1);
+            continue;
+        }
 
-    number += rounding;
+        left = false;
+        pad = ' ';
+        for (;; format++) {
+            if (*format == '-') left = true;
+            else if (*format == '0') pad = '0';
+            else break;
+        }
+        if (left) pad = ' ';
+
+        width = 0;
+        if (*format == '*') {
+            int w = va_arg(args, int);
+            if (w < 0) {
+                // a negative width argument is a '-' flag and a positive width
+                left = true;
+                pad = ' ';
+                w = -w;
+            }
+            width = w;
+            format++;
+        }
+        while (*format >= '0' && *format <= '9')
+            width = width * 10 + *format++ - '0';
+
+        prec = -1;
+        if (*format == '.') {
+            format++;
+            prec = 0;
+            if (*format == '*') {
+                prec = va_arg(args, int);
+                if (prec < 0) prec = -1; // taken as if the precision were omitted
+                format++;
+            }
+            while (*format >= '0' && *format <= '9')
+                prec = prec * 10 + *format++ - '0';
+        }
 
-    // Extract the integer part of the number and print it
-    unsigned long int_part = (unsigned long)number;
-    double remainder = number - (double)int_part;
-    n += print(int_part);
+        islong = false;
+        while (*format == 'l') {
+            islong = true;
+            format++;
+        }
 
-    // Print the decimal point, but only if there are digits beyond
-    if (digits > 0) {
-        n += print(".");
-    }
+        str = num;
+        zeros = 0;
+        switch (c = *format++) {
+        case 'd':
+        case 'i': {
+            long v = islong ? va_arg(args, long) : va_arg(args, int);
+            char *p = utoa_digits(v < 0 ? -(unsigned long)v : (unsigned long)v, &num[sizeof(num)], 10, 0);
+            zeros = printfPrecision(p, &num[sizeof(num)], prec, pad);
+            if (v < 0) *--p = '-';
+            str = p;
+            len = &num[sizeof(num)] - str;
+            break;
+        }
+        case 'u':
+        case 'x':
+        case 'X':
+        case 'o': {
+            unsigned long v = islong ? va_arg(args, unsigned long) : va_arg(args, unsigned int);
+            char *p = utoa_digits(v, &num[sizeof(num)], c == 'u' ? 10 : c == 'o' ? 8 : 16, c == 'X');
+            zeros = printfPrecision(p, &num[sizeof(num)], prec, pad);
+            str = p;
+            len = &num[sizeof(num)] - str;
+            break;
+        }
+        case 'c':
+            num[0] = va_arg(args, int);
+            len = 1;
+            break;
+        case 's':
+            str = va_arg(args, const char *);
+            if (!str) str = "(null)";
+            for (len = 0; str[len] && (prec < 0 || len < (size_t)prec); len++)
+                ;
+            pad = ' ';
+            break;
+#ifndef PRINTF_NO_FLOAT
+        case 'f':
+            len = ftoa(va_arg(args, double), num, prec < 0 ? 6 : prec);
+            break;
+#endif
+        case '%':
+            num[0] = '%';
+            len = 1;
+            break;
+        default:
+            // unknown conversion: print it as is
+            num[0] = '%';
+            num[1] = c;
+            len = c ? 2 : 1;
+            if (!c) format--;
+            width = 0;
+            break;
+        }
 
-    // Extract digits from the remainder one at a time
-    while (digits-- > 0)
-    {
-        remainder *= 10.0;
-        int toPrint = int(remainder);
-        n += print(toPrint);
-        remainder -= toPrint;
+        printfField(s, str, len, width, pad, left, zeros);
     }
+    va_end(args);
 
-    return n;
+    printfFlush(s);
+    return s.n;
 }
 
-size_t Print::printFloat(float number, uint8_t digits)
-{
-    size_t n = 0;
+// Private Methods /////////////////////////////////////////////////////////////
 
-    // Handle negative numbers
-    if (number < 0.0)
-    {
-        n += print('-');
-        number = -number;
-    }
+size_t Print::printNumber(unsigned long n, uint8_t base) {
+    char buf[8 * sizeof(long)]; // Assumes 8-bit chars.
+    char *str;
 
-    // Round correctly so that print(1.999, 2) prints as "2.00"
-    float rounding = 0.5;
-    for (uint8_t i=0; i<digits; ++i)
-        rounding /= 10.0;
+    // prevent crash if called with base == 1
+    if (base < 2) base = 10;
 
-    number += rounding;
+    str = utoa_digits(n, &buf[sizeof(buf)], base, 1);
 
-    // Extract the integer part of the number and print it
-    unsigned long int_part = (unsigned long)number;
-    float remainder = number - (float)int_part;
-    n += print(int_part);
+    return write((const uint8_t *)str, &buf[sizeof(buf)] - str);
+}
 
-    // Print the decimal point, but only if there are digits beyond
-    if (digits > 0) {
-        n += print(".");
-    }
+size_t Print::printFloat(double number, uint8_t digits)
+{
+    // rendered on the stack and written at once, at most FTOA_MAX_PREC digits
+    char buf[FTOA_BUF_SIZE];
 
-    // Extract digits from the remainder one at a time
-    while (digits-- > 0)
-    {
-        remainder *= 10.0;
-        int toPrint = int(remainder);
-        n += print(toPrint);
-        remainder -= toPrint;
-    }
+    return write((const uint8_t *)buf, ftoa(number, buf, digits));
+}
 
-    return n;
+size_t Print::printFloat(float number, uint8_t digits)
+{
+    // rendered on the stack and written at once, at most FTOA_MAX_PREC digits
+    char buf[FTOA_BUF_SIZE];
+
+    return write((const uint8_t *)buf, ftoaf(number, buf, digits));
 }
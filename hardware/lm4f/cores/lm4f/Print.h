@@ -70,6 +70,8 @@ class Print
     size_t print(float, int = 2);
     size_t print(const Printable&);
 
+    size_t printf(const char *format, ...) __attribute__ ((format (printf, 2, 3)));
+
     //size_t println(const __FlashStringHelper *);
     size_t println(const String &s);
     size_t println(const char[]);
@@ -110,26 +110,30 @@ String::String(unsigned long value, unsigned char base)
 String::String(float value, unsigned char decimalPlaces)
 {
 	init();
-	char buf[33];
-	*this = dtostrf(value, (decimalPlaces + 2), decimalPlaces, buf);
+	char buf[FTOA_BUF_SIZE];
+	ftoaf(value, buf, decimalPlaces);
+	*this = buf;
 }
 
 String::String(double value, unsigned char decimalPlaces)
 {
 	init();
-	char buf[33];
-	*this = dtostrf(value, (decimalPlaces + 2), decimalPlaces, buf);
+	char buf[FTOA_BUF_SIZE];
+	ftoa(value, buf, decimalPlaces);
+	*this = buf;
 }
 
 String::~String()
 {
-	free(buffer);
+	if (buffer != sso) free(buffer);
 }
 
 /*********************************************/
 /*  Memory Management                        */
 /*********************************************/
 
+unsigned long String::allocCount = 0;
+
 inline void String::init(void)
 {
 	buffer = NULL;
@@ -139,7 +143,7 @@ inline void String::init(void)
 
 void String::invalidate(void)
 {
-	if (buffer) free(buffer);
+	if (buffer && buffer != sso) free(buffer);
 	buffer = NULL;
 	capacity = len = 0;
 }
@@ -156,10 +160,40 @@ unsigned char String::reserve(unsigned int size)
 
 unsigned char String::changeBuffer(unsigned int maxStrLen)
 {
-	char *newbuffer = (char *)realloc(buffer, maxStrLen + 1);
+	char *newbuffer;
+	unsigned int newCapacity = maxStrLen;
+
+	// short strings live in the object itself
+	if (buffer == NULL && maxStrLen < STRING_SSO_SIZE) {
+		buffer = sso;
+		capacity = STRING_SSO_SIZE - 1;
+		return 1;
+	}
+
+	// grow by half the current capacity at least, so that building a
+	// string piece by piece takes a logarithmic number of allocations
+	if (buffer && newCapacity < capacity + (capacity >> 1))
+		newCapacity = capacity + (capacity >> 1);
+
+	for (;;) {
+		if (buffer == sso || buffer == NULL) {
+			newbuffer = (char *)malloc(newCapacity + 1);
+			if (newbuffer && buffer) {
+				memcpy(newbuffer, buffer, len);
+				newbuffer[len] = 0;
+			}
+		} else {
+			newbuffer = (char *)realloc(buffer, newCapacity + 1);
+		}
+		if (newbuffer || newCapacity == maxStrLen) break;
+		// no room to grow ahead, try the exact size
+		newCapacity = maxStrLen;
+	}
+
 	if (newbuffer) {
+		allocCount++;
 		buffer = newbuffer;
-		capacity = maxStrLen;
+		capacity = newCapacity;
 		return 1;
 	}
 	return 0;
@@ -200,10 +234,19 @@ void String::move(String &rhs)
 			len = rhs.len;
 			rhs.len = 0;
 			return;
-		} else {
+		} else if (buffer != sso) {
 			free(buffer);
 		}
 	}
+	if (rhs.buffer == rhs.sso) {
+		// an inline buffer can not be handed over, it fits ours though
+		buffer = sso;
+		capacity = STRING_SSO_SIZE - 1;
+		strcpy(buffer, rhs.buffer);
+		len = rhs.len;
+		rhs.len = 0;
+		return;
+	}
 	buffer = rhs.buffer;
 	capacity = rhs.capacity;
 	len = rhs.len;
@@ -324,16 +367,14 @@ unsigned char String::concat(unsigned long num)
 
 unsigned char String::concat(float num)
 {
-	char buf[20];
-	char* string = dtostrf(num, 4, 2, buf);
-	return concat(string, strlen(string));
+	char buf[FTOA_BUF_SIZE];
+	return concat(buf, ftoaf(num, buf, 2));
 }
 
 unsigned char String::concat(double num)
 {
-	char buf[20];
-	char* string = dtostrf(num, 4, 2, buf);
-	return concat(string, strlen(string));
+	char buf[FTOA_BUF_SIZE];
+	return concat(buf, ftoa(num, buf, 2));
 }
 
 unsigned char String::concat(const __FlashStringHelper * str)
@@ -66,6 +66,74 @@ extern void itoa( int n, char s[] )
 
 #else
 
+#if defined(__MSP430__)
+/* v / 10 with shifts and adds; the MSP430 has no divide instruction and a
+ * library call per digit is much slower. Returns the remainder. */
+static unsigned int udiv10( unsigned long v, unsigned long *q )
+{
+  unsigned long t;
+
+  t = (v >> 1) + (v >> 2);
+  t += t >> 4;
+  t += t >> 8;
+  t += t >> 16;
+  t >>= 3;
+  v -= (t << 3) + (t << 1);
+  if (v > 9)
+  {
+    t++;
+    v -= 10;
+  }
+  *q = t;
+  return v;
+}
+#else
+/* the compiler turns this into a multiplication by the reciprocal */
+static unsigned int udiv10( unsigned long v, unsigned long *q )
+{
+  *q = v / 10;
+  return v - *q * 10;
+}
+#endif
+
+extern char* utoa_digits( unsigned long value, char *end, int radix, int upper )
+{
+  char alpha = (upper ? 'A' : 'a') - 10;
+  unsigned int d;
+  unsigned int shift;
+
+  if (radix == 10)
+  {
+    do
+    {
+      *--end = udiv10(value, &value) + '0';
+    } while (value);
+  }
+  else if ((radix & (radix - 1)) == 0)
+  {
+    /* power of two: shift and mask */
+    for (shift = 0; (1 << shift) < radix; shift++)
+      ;
+    do
+    {
+      d = value & (radix - 1);
+      *--end = d < 10 ? d + '0' : d + alpha;
+      value >>= shift;
+    } while (value);
+  }
+  else
+  {
+    do
+    {
+      d = value % radix;
+      value /= radix;
+      *--end = d < 10 ? d + '0' : d + alpha;
+    } while (value);
+  }
+
+  return end;
+}
+
 extern char* itoa( int value, char *string, int radix )
 {
   return ltoa( value, string, radix ) ;
@@ -74,10 +142,7 @@ extern char* itoa( int value, char *string, int radix )
 extern char* ltoa( long value, char *string, int radix )
 {
   char tmp[33];
-  char *tp = tmp;
-  long i;
-  unsigned long v;
-  int sign;
+  char *tp;
   char *sp;
 
   if ( string == NULL )
@@ -90,32 +155,19 @@ extern char* ltoa( long value, char *string, int radix )
     return 0 ;
   }
 
-  sign = (radix == 10 && value < 0);
-  if (sign)
+  sp = string;
+  if (radix == 10 && value < 0)
   {
-    v = -value;
+    *sp++ = '-';
+    tp = utoa_digits(-(unsigned long)value, tmp + sizeof(tmp), radix, 0);
   }
   else
   {
-    v = (unsigned long)value;
+    tp = utoa_digits((unsigned long)value, tmp + sizeof(tmp), radix, 0);
   }
 
-  while (v || tp == tmp)
-  {
-    i = v % radix;
-    v = v / radix;
-    if (i < 10)
-      *tp++ = i+'0';
-    else
-      *tp++ = i + 'a' - 10;
-  }
-
-  sp = string;
-
-  if (sign)
-    *sp++ = '-';
-  while (tp > tmp)
-    *sp++ = *--tp;
+  while (tp < tmp + sizeof(tmp))
+    *sp++ = *tp++;
   *sp = 0;
 
   return string;
@@ -128,10 +180,8 @@ extern char* utoa( unsigned long value, char *string, int radix )
 
 extern char* ultoa( unsigned long value, char *string, int radix )
 {
-  char tmp[33];
-  char *tp = tmp;
-  long i;
-  unsigned long v = value;
+  char tmp[32];
+  char *tp;
   char *sp;
 
   if ( string == NULL )
@@ -143,26 +193,91 @@ extern char* ultoa( unsigned long value, char *string, int radix )
   {
     return 0;
   }
- 
-  while (v || tp == tmp)
-  {
-    i = v % radix;
-    v = v / radix;
-    if (i < 10)
-      *tp++ = i+'0';
-    else
-      *tp++ = i + 'a' - 10;
-  }
 
-  sp = string;
+  tp = utoa_digits(value, tmp + sizeof(tmp), radix, 0);
 
- 
-  while (tp > tmp)
-    *sp++ = *--tp;
+  sp = string;
+  while (tp < tmp + sizeof(tmp))
+    *sp++ = *tp++;
   *sp = 0;
 
   return string;
 }
+
+static const unsigned long ftoa_pow10[FTOA_MAX_PREC + 1] = {
+  1, 10, 100, 1000, 10000, 100000, 1000000, 10000000, 100000000, 1000000000
+};
+
+/* Renders the parts computed by ftoa()/ftoaf() */
+static int ftoa_parts( char *string, int neg, unsigned long whole, unsigned long frac, int prec )
+{
+  char *sp = string;
+  char *end = string + FTOA_BUF_SIZE - 1;
+  char *tp;
+
+  if (neg)
+    *sp++ = '-';
+
+  /* the decimals go right aligned at the end of the buffer, zero padded */
+  tp = end;
+  if (prec > 0)
+  {
+    tp = utoa_digits(frac, end, 10, 0);
+    while (tp > end - prec)
+      *--tp = '0';
+    *--tp = '.';
+  }
+  /* then the integer part is rendered in front of them */
+  tp = utoa_digits(whole, tp, 10, 0);
+
+  while (tp < end)
+    *sp++ = *tp++;
+  *sp = 0;
+
+  return sp - string;
+}
+
+static int ftoa_special( char *string, const char *text )
+{
+  strcpy(string, text);
+  return strlen(text);
+}
+
+/* Round correctly so that 1.999 with 2 decimals renders as "2.00", then
+ * take the decimals as one integer instead of digit by digit. */
+#define FTOA_BODY(type)                                                 \
+  unsigned long whole, frac;                                            \
+  int neg = 0;                                                          \
+                                                                        \
+  if (value != value) return ftoa_special(string, "nan");              \
+  if (value > 4294967040.0 || value < -4294967040.0)                   \
+    return ftoa_special(string, "ovf");                                 \
+  if (prec < 0) prec = 0;                                               \
+  if (prec > FTOA_MAX_PREC) prec = FTOA_MAX_PREC;                       \
+  if (value < 0)                                                        \
+  {                                                                     \
+    neg = 1;                                                            \
+    value = -value;                                                     \
+  }                                                                     \
+  value += (type)0.5 / (type)ftoa_pow10[prec];                               \
+  whole = (unsigned long)value;                                         \
+  frac = (unsigned long)((value - (type)whole) * (type)ftoa_pow10[prec]);    \
+  if (frac >= ftoa_pow10[prec])                                              \
+  {                                                                     \
+    frac -= ftoa_pow10[prec];                                                \
+    whole++;                                                            \
+  }                                                                     \
+  return ftoa_parts(string, neg, whole, frac, prec)
+
+extern int ftoa( double value, char *string, int prec )
+{
+  FTOA_BODY(double);
+}
+
+extern int ftoaf( float value, char *string, int prec )
+{
+  FTOA_BODY(float);
+}
 #endif /* 0 */
 
 #ifdef __cplusplus
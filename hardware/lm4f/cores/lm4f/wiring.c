@@ -33,21 +33,52 @@
 #include "inc/hw_timer.h"
 #include "driverlib/rom.h"
 #include "driverlib/rom_map.h"
+#include "driverlib/cpu.h"
 #include "driverlib/sysctl.h"
 #include "driverlib/timer.h"
 
-static void (*SysTickCbFuncs[8])(uint32_t ui32TimeMS);
+/*
+ * SysTick tasks: callbacks with their own period, called from the SysTick
+ * handler only when due. nextDue is the earliest deadline of all tasks, so
+ * ticks without a due task cost a single compare.
+ */
+#define SYSTICK_TASKS 8
+
+typedef struct {
+	void (*func)(uint32_t ui32TimeMS);
+	uint32_t period;      // ms between calls
+	uint32_t due;         // value of milliseconds at the next call
+	uint32_t last;        // value of milliseconds at the last call
+	uint8_t priority;     // lower runs first among the tasks due in a tick
+	uint32_t calls;
+	uint32_t cyclesMin;
+	uint32_t cyclesMax;
+	uint64_t cyclesTotal;
+} SysTickTask;
+
+static SysTickTask SysTickTasks[SYSTICK_TASKS];  // sorted by priority
+static uint8_t SysTickTaskCount = 0;
+static volatile uint32_t nextDue = 0;
+
+// DWT cycle counter, used to time the SysTick tasks
+#define DWT_CTRL                0xE0001000
+#define DWT_CTRL_CYCCNTENA      0x00000001
+#define DWT_CYCCNT              0xE0001004
+#define NVIC_DBG_INT_TRCENA     0x01000000  // Trace enable (DEMCR)
 
 #define SYSTICKHZ               1000UL
 #define SYSTICKMS               (1000UL / SYSTICKHZ)
 #define DEEPSLEEP_CPU		(16000000UL / 16UL)    // PIOSC / 16
 
-static inline void SysTickMode_DeepSleep(void);
-static inline void SysTickMode_DeepSleepCoarse(void);
+static inline uint32_t SysTickMode_DeepSleep(uint32_t ms);
 static inline void SysTickMode_Run(void);
 static void CPUwfi_safe(void);
 
 static volatile unsigned long milliseconds = 0;
+
+// Cumulative time spent in sleep by delay() and in deep sleep by sleep()
+static unsigned long lpm_millis[2];
+static unsigned int lpm_fract[2];
 #define SYSTICK_INT_PRIORITY    0x80
 void timerInit()
 {
@@ -74,6 +105,11 @@ void timerInit()
     MAP_SysTickIntEnable();
     MAP_IntMasterEnable();
 
+    // Cycle counter for the SysTick task statistics
+    HWREG(NVIC_DBG_INT) |= NVIC_DBG_INT_TRCENA;
+    HWREG(DWT_CYCCNT) = 0;
+    HWREG(DWT_CTRL) |= DWT_CTRL_CYCCNTENA;
+
     // PIOSC is used during Deep Sleep mode for wakeup
     MAP_SysCtlPIOSCCalibrate(SYSCTL_PIOSC_CAL_FACT);  // Factory-supplied calibration used
 }
@@ -111,11 +147,70 @@ void delayMicroseconds(unsigned int us)
 	} while(elapsedTime <= ticks);
 }
 
+static void lowPowerAccount(uint8_t mode, unsigned long ms, unsigned int us)
+{
+	unsigned int f = lpm_fract[mode] + us;
+
+	while (f >= 1000) {
+		f -= 1000;
+		ms++;
+	}
+	lpm_fract[mode] = f;
+	lpm_millis[mode] += ms;
+}
+
+unsigned long lowPowerTime(uint8_t mode)
+{
+	if (mode > LOW_POWER_DEEPSLEEP)
+		return 0;
+	return lpm_millis[mode];
+}
+
+void resetLowPowerTime(void)
+{
+	lpm_millis[LOW_POWER_SLEEP] = lpm_millis[LOW_POWER_DEEPSLEEP] = 0;
+	lpm_fract[LOW_POWER_SLEEP] = lpm_fract[LOW_POWER_DEEPSLEEP] = 0;
+}
+
 void delay(uint32_t millis)
 {
-	unsigned long i;
-	for(i=0; i<millis*2; i++){
-		delayMicroseconds(500);
+	unsigned long start, now, elapsed, tick;
+	bool wasDisabled;
+
+	// In a handler (a SysTick task too) or with PRIMASK set the SysTick
+	// interrupt can not run: busy wait on the counter as before
+	if ((HWREG(NVIC_INT_CTRL) & NVIC_INT_CTRL_VEC_ACT_M) || CPUprimask()) {
+		for (tick = 0; tick < millis * 2; tick++)
+			delayMicroseconds(500);
+		return;
+	}
+
+	start = micros();
+	while (millis > 0) {
+		tick = milliseconds;
+		now = micros();
+		elapsed = now - start;
+		if (elapsed >= 1000) {
+			millis--;
+			start += 1000;
+			continue;
+		}
+
+		// The delay ends before the next SysTick: busy wait the rest
+		if (millis == 1 && 1000 - elapsed < MAP_SysTickValueGet() / (F_CPU/1000000)) {
+			delayMicroseconds(1000 - elapsed);
+			break;
+		}
+
+		// Sleep (not deep sleep, peripherals keep their clocks) until the
+		// next SysTick or any other interrupt, unless a tick slipped in
+		wasDisabled = MAP_IntMasterDisable();
+		if (tick == milliseconds)
+			CPUwfi_safe();
+		if (!wasDisabled)
+			MAP_IntMasterEnable();
+
+		lowPowerAccount(LOW_POWER_SLEEP, 0, micros() - now);
 	}
 }
 
@@ -124,27 +219,29 @@ volatile boolean stay_asleep = false;
 
 void sleep(uint32_t ms)
 {
-	unsigned long i;
+	unsigned long start = milliseconds;
+	unsigned long slept, period;
 
-	i = milliseconds;
-	i += ms;
 	stay_asleep = true;
 
 	HWREG(NVIC_SYS_CTRL) |= NVIC_SYS_CTRL_SLEEPDEEP;
 
-	while ( stay_asleep && (milliseconds < i) ) {
+	while ( stay_asleep && (milliseconds - start < ms) ) {
 		MAP_IntMasterDisable();  // Set PRIMASK so CPU wakes on IRQ but ISRs don't execute until PRIMASK is cleared
-		SysTickMode_DeepSleep();
+		// One SysTick period for all the time left, as far as 24 bits reach
+		period = SysTickMode_DeepSleep(ms - (milliseconds - start));
 
 		CPUwfi_safe();
 
 		// Handle low-power SysTick triggers without using the default SysTickIntHandler
 		if (HWREG(NVIC_INT_CTRL) & NVIC_INT_CTRL_PENDSTSET) {
-			milliseconds += 100;
+			slept = period;
 			HWREG(NVIC_INT_CTRL) |= NVIC_INT_CTRL_PENDSTCLR;
 		} else {
-			milliseconds += ((DEEPSLEEP_CPU / (1000/100)) - HWREG(NVIC_ST_CURRENT)) / (DEEPSLEEP_CPU / 1000);
+			slept = (period * (DEEPSLEEP_CPU / 1000) - HWREG(NVIC_ST_CURRENT)) / (DEEPSLEEP_CPU / 1000);
 		}
+		milliseconds += slept;
+		lowPowerAccount(LOW_POWER_DEEPSLEEP, slept, 0);
 
 		// Restore SysTick to normal parameters in preparation for full-speed ISR execution
 		SysTickMode_Run();
@@ -157,91 +254,199 @@ void sleep(uint32_t ms)
 
 void sleepSeconds(uint32_t seconds)
 {
-	unsigned long i;
-
-	i = milliseconds;
-	i += seconds * 1000;
+	sleep(seconds * 1000);
+}
 
+void suspend(void)
+{
 	stay_asleep = true;
 
 	HWREG(NVIC_SYS_CTRL) |= NVIC_SYS_CTRL_SLEEPDEEP;
 
-	while ( stay_asleep && (milliseconds < i) ) {
+	while(stay_asleep) {
 		MAP_IntMasterDisable();  // Set PRIMASK so CPU wakes on IRQ but ISRs don't execute until PRIMASK is cleared
-		SysTickMode_DeepSleepCoarse();
+		MAP_SysTickDisable();  // Halt SysTick during suspend mode - millis will no longer increment
 
 		CPUwfi_safe();
 
-		// Handle low-power SysTick triggers without using the default SysTickIntHandler
-		if (HWREG(NVIC_INT_CTRL) & NVIC_INT_CTRL_PENDSTSET) {
-			milliseconds += 1000;
-			HWREG(NVIC_INT_CTRL) |= NVIC_INT_CTRL_PENDSTCLR;
-		} else {
-			milliseconds += (DEEPSLEEP_CPU - HWREG(NVIC_ST_CURRENT)) / (DEEPSLEEP_CPU / 1000);
-		}
-
-		// Restore SysTick to normal parameters in preparation for full-speed ISR execution
-		SysTickMode_Run();
+		MAP_SysTickEnable();   // Re-enable SysTick before ISRs start (in case ISR uses millis/micros)
 		MAP_IntMasterEnable();  // Clearing PRIMASK allows pending ISRs to run
 	}
 
 	HWREG(NVIC_SYS_CTRL) &= ~(NVIC_SYS_CTRL_SLEEPDEEP);
-	stay_asleep = false;
 }
 
-void suspend(void)
+static void SysTickUpdateDue(void)
 {
-	stay_asleep = true;
-
-	HWREG(NVIC_SYS_CTRL) |= NVIC_SYS_CTRL_SLEEPDEEP;
+	uint8_t i;
+	uint32_t due = milliseconds + 0x7FFFFFFF;
 
-	while(stay_asleep) {
-		MAP_IntMasterDisable();  // Set PRIMASK so CPU wakes on IRQ but ISRs don't execute until PRIMASK is cleared
-		MAP_SysTickDisable();  // Halt SysTick during suspend mode - millis will no longer increment
+	for (i = 0; i < SysTickTaskCount; i++) {
+		if ((int32_t)(SysTickTasks[i].due - due) < 0)
+			due = SysTickTasks[i].due;
+	}
+	nextDue = due;
+}
 
-		CPUwfi_safe();
+static int SysTickTaskFind(void (*userFunc)(uint32_t))
+{
+	uint8_t i;
 
-		MAP_SysTickEnable();   // Re-enable SysTick before ISRs start (in case ISR uses millis/micros)
-		MAP_IntMasterEnable();  // Clearing PRIMASK allows pending ISRs to run
+	for (i = 0; i < SysTickTaskCount; i++) {
+		if (SysTickTasks[i].func == userFunc)
+			return i;
 	}
+	return -1;
+}
 
-	HWREG(NVIC_SYS_CTRL) &= ~(NVIC_SYS_CTRL_SLEEPDEEP);
+/*
+ * Call userFunc every period ms from the SysTick handler. Tasks due in the
+ * same tick run in priority order, lowest value first. The argument passed
+ * to userFunc is the ms elapsed since its previous call.
+ * Returns -1 when all SYSTICK_TASKS slots are in use.
+ */
+int registerSysTickTask(void (*userFunc)(uint32_t), uint32_t period, uint8_t priority)
+{
+	SysTickTask task = { 0 };
+	bool wasDisabled;
+	int i;
+
+	unregisterSysTickCb(userFunc);
+	if (SysTickTaskCount == SYSTICK_TASKS)
+		return -1;
+
+	task.func = userFunc;
+	task.period = period ? period : 1;
+	task.priority = priority;
+	task.cyclesMin = 0xFFFFFFFF;
+
+	wasDisabled = MAP_IntMasterDisable();
+	task.last = milliseconds;
+	task.due = milliseconds + task.period;
+	for (i = SysTickTaskCount; i > 0 && SysTickTasks[i - 1].priority > priority; i--)
+		SysTickTasks[i] = SysTickTasks[i - 1];
+	SysTickTasks[i] = task;
+	SysTickTaskCount++;
+	SysTickUpdateDue();
+	if (!wasDisabled)
+		MAP_IntMasterEnable();
+
+	return 0;
 }
 
 void registerSysTickCb(void (*userFunc)(uint32_t))
 {
-	uint8_t i;
-	for (i=0; i<8; i++) {
-		if(!SysTickCbFuncs[i]) {
-			SysTickCbFuncs[i] = userFunc;
-			break;
-		}
+	registerSysTickTask(userFunc, SYSTICKMS, SYSTICK_PRIORITY_DEFAULT);
+}
+
+void unregisterSysTickCb(void (*userFunc)(uint32_t))
+{
+	bool wasDisabled;
+	int i;
+
+	wasDisabled = MAP_IntMasterDisable();
+	i = SysTickTaskFind(userFunc);
+	if (i >= 0) {
+		SysTickTaskCount--;
+		for (; i < SysTickTaskCount; i++)
+			SysTickTasks[i] = SysTickTasks[i + 1];
+		SysTickUpdateDue();
 	}
+	if (!wasDisabled)
+		MAP_IntMasterEnable();
 }
 
-void SysTickIntHandler(void)
+/*
+ * Execution time of userFunc in CPU cycles over all calls since it was
+ * registered or since resetSysTickTaskStats(). Returns -1 if userFunc is
+ * not registered.
+ */
+int getSysTickTaskStats(void (*userFunc)(uint32_t), SysTickTaskStats *stats)
 {
-	milliseconds++;
+	bool wasDisabled;
+	int i;
+
+	wasDisabled = MAP_IntMasterDisable();
+	i = SysTickTaskFind(userFunc);
+	if (i >= 0) {
+		stats->calls = SysTickTasks[i].calls;
+		stats->cyclesMin = SysTickTasks[i].calls ? SysTickTasks[i].cyclesMin : 0;
+		stats->cyclesMax = SysTickTasks[i].cyclesMax;
+		stats->cyclesAvg = SysTickTasks[i].calls ?
+			SysTickTasks[i].cyclesTotal / SysTickTasks[i].calls : 0;
+	}
+	if (!wasDisabled)
+		MAP_IntMasterEnable();
 
+	return i < 0 ? -1 : 0;
+}
+
+void resetSysTickTaskStats(void)
+{
+	bool wasDisabled;
 	uint8_t i;
-	for (i=0; i<8; i++) {
-		if (SysTickCbFuncs[i])
-			SysTickCbFuncs[i](SYSTICKMS);
+
+	wasDisabled = MAP_IntMasterDisable();
+	for (i = 0; i < SysTickTaskCount; i++) {
+		SysTickTasks[i].calls = 0;
+		SysTickTasks[i].cyclesMin = 0xFFFFFFFF;
+		SysTickTasks[i].cyclesMax = 0;
+		SysTickTasks[i].cyclesTotal = 0;
 	}
+	if (!wasDisabled)
+		MAP_IntMasterEnable();
 }
 
-__attribute__((always_inline))
-static inline void SysTickMode_DeepSleep(void)
+static void SysTickDispatch(void)
 {
-	HWREG(NVIC_ST_RELOAD) = DEEPSLEEP_CPU / (1000/100) - 1;
-	HWREG(NVIC_ST_CURRENT) = 0;  // Clear SysTick
+	uint32_t now = milliseconds;
+	uint32_t start, cycles;
+	SysTickTask *task;
+	uint8_t i;
+
+	for (i = 0; i < SysTickTaskCount; i++) {
+		task = &SysTickTasks[i];
+		if ((int32_t)(now - task->due) < 0)
+			continue;
+
+		// Next deadline from this one; after sleep() skip the ones missed
+		task->due += task->period;
+		if ((int32_t)(now - task->due) >= 0)
+			task->due = now + task->period;
+
+		start = HWREG(DWT_CYCCNT);
+		task->func(now - task->last);
+		cycles = HWREG(DWT_CYCCNT) - start;
+		task->last = now;
+
+		task->calls++;
+		task->cyclesTotal += cycles;
+		if (cycles < task->cyclesMin)
+			task->cyclesMin = cycles;
+		if (cycles > task->cyclesMax)
+			task->cyclesMax = cycles;
+	}
+	SysTickUpdateDue();
+}
+
+void SysTickIntHandler(void)
+{
+	milliseconds++;
+
+	if ((int32_t)(milliseconds - nextDue) >= 0)
+		SysTickDispatch();
 }
 
+/* Program a single SysTick period of ms milliseconds in deep sleep,
+ * clipped to the 24 bit reload. Returns the period actually programmed. */
 __attribute__((always_inline))
-static inline void SysTickMode_DeepSleepCoarse(void)
+static inline uint32_t SysTickMode_DeepSleep(uint32_t ms)
 {
-	HWREG(NVIC_ST_RELOAD) = DEEPSLEEP_CPU - 1;
+	if (ms > (NVIC_ST_RELOAD_M + 1) / (DEEPSLEEP_CPU / 1000))
+		ms = (NVIC_ST_RELOAD_M + 1) / (DEEPSLEEP_CPU / 1000);
+	HWREG(NVIC_ST_RELOAD) = ms * (DEEPSLEEP_CPU / 1000) - 1;
 	HWREG(NVIC_ST_CURRENT) = 0;  // Clear SysTick
+	return ms;
 }
 
 __attribute__((always_inline))
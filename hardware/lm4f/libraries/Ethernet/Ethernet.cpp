@@ -5,12 +5,14 @@
 #include <IPAddress.h>
 
 #define ETHERNET_INT_PRIORITY   0xC0
+// lwIP timers run every 100ms or slower; no need to service them every tick
+#define ETHERNET_TIMER_MS       10
 
 void EthernetClass::begin(uint8_t *mac_address, IPAddress local_ip, IPAddress dns_server, IPAddress gateway, IPAddress subnet)
 {
 	uint32_t ui32User0, ui32User1;
 
-	registerSysTickCb(lwIPTimer);
+	registerSysTickTask(lwIPTimer, ETHERNET_TIMER_MS, SYSTICK_PRIORITY_DEFAULT);
 	ROM_FlashUserGet(&ui32User0, &ui32User1);
 
 	/*
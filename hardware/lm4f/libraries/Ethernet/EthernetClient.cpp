@@ -251,6 +251,28 @@ int EthernetClient::port() {
 	return cs->port;
 }
 
+/* Move on to the next pbuf once the current one has been read.
+ * Called with the ethernet interrupt masked */
+void EthernetClient::consumed() {
+	/* Read any data still in the buffer regardless of connection state */
+	if ((cs->read == cs->p->len) && cs->p->next) {
+		cs->read = 0;
+		struct pbuf * q = (pbuf*)cs->p;
+		cs->p = cs->p->next;
+		/* Increase ref count on p->next
+		 * 1->3->1->etc */
+		pbuf_ref((pbuf*)cs->p);
+		/* Free p which decreases ref count of the chain
+		 * and frees up to p->next in this case
+		 * ...->1->1->etc */
+		pbuf_free(q);
+	} else if (cs->read == cs->p->len) {
+		cs->read = 0;
+		pbuf_free((pbuf*)cs->p);
+		cs->p = NULL;
+	}
+}
+
 int EthernetClient::readLocked() {
 	INT_PROTECT_INIT(oldLevel);
 
@@ -271,23 +293,7 @@ int EthernetClient::readLocked() {
 		tcp_recved((tcp_pcb*)cs->cpcb, cs->read);
 	}
 
-	/* Read any data still in the buffer regardless of connection state */
-	if ((cs->read == cs->p->len) && cs->p->next) {
-		cs->read = 0;
-		struct pbuf * q = (pbuf*)cs->p;
-		cs->p = cs->p->next;
-		/* Increase ref count on p->next
-		 * 1->3->1->etc */
-		pbuf_ref((pbuf*)cs->p);
-		/* Free p which decreases ref count of the chain
-		 * and frees up to p->next in this case
-		 * ...->1->1->etc */
-		pbuf_free(q);
-	} else if (cs->read == cs->p->len) {
-		cs->read = 0;
-		pbuf_free((pbuf*)cs->p);
-		cs->p = NULL;
-	}
+	consumed();
 
 	INT_UNPROTECT(oldLevel);
 
@@ -299,21 +305,34 @@ int EthernetClient::read() {
 }
 
 int EthernetClient::read(uint8_t *buf, size_t size) {
-	uint16_t i;
-	int b;
+	INT_PROTECT_INIT(oldLevel);
+	size_t count = 0, n;
 
 	if (available() <= 0)
 		return -1;
 
-	/* TODO: Replace lazy method with optimized on */
-	for (i = 0; i < size; i++) {
-		b = read();
-		if (b == -1)
-			break;
-		buf[i] = b;
+	/* protect the code from preemption of the ethernet interrupt servicing */
+	INT_PROTECT(oldLevel);
+
+	/* copy a pbuf payload at a time */
+	while (count < size && cs->p) {
+		n = cs->p->len - cs->read;
+		if (n > size - count)
+			n = size - count;
+		memcpy(buf + count, (uint8_t *) cs->p->payload + cs->read, n);
+		count += n;
+		cs->read += n;
+		consumed();
 	}
 
-	return i;
+	/* Indicate data was received only if still connected */
+	if (cs->cpcb && count) {
+		tcp_recved((tcp_pcb*)cs->cpcb, count);
+	}
+
+	INT_UNPROTECT(oldLevel);
+
+	return count;
 }
 
 int EthernetClient::peek() {
@@ -336,6 +355,21 @@ int EthernetClient::peek() {
 	return b;
 }
 
+/* The unread part of the current pbuf; it stays in place until read */
+size_t EthernetClient::peekBuffer(const uint8_t **data) {
+	INT_PROTECT_INIT(oldLevel);
+	size_t n = 0;
+
+	INT_PROTECT(oldLevel);
+	if (available()) {
+		*data = (const uint8_t *) cs->p->payload + cs->read;
+		n = cs->p->len - cs->read;
+	}
+	INT_UNPROTECT(oldLevel);
+
+	return n;
+}
+
 void EthernetClient::flush() {
 	INT_PROTECT_INIT(oldLevel);
 	/* protect code from preemption of the ethernet interrupt servicing */
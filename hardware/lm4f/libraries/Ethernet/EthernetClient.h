@@ -27,6 +27,7 @@ public:
 	virtual int port();
 	virtual int read(uint8_t *buf, size_t size);
 	virtual int peek();
+	virtual size_t peekBuffer(const uint8_t **data);
 	virtual void flush();
 	virtual void stop();
 	virtual uint8_t connected();
@@ -45,5 +46,6 @@ private:
 	struct client *cs;
 
 	int readLocked();
+	void consumed();
 };
 #endif
@@ -5,7 +5,10 @@
 EthernetUDP::EthernetUDP() {
 	_read = 0;
 	front = 0;
+	rear = 0;
 	count = 0;
+	depth = UDP_RX_MAX_PACKETS;
+	dropped = 0;
 	_p = NULL;
 }
 
@@ -14,7 +17,8 @@ void EthernetUDP::do_recv(void *arg, struct udp_pcb *upcb, struct pbuf *p, struc
 	EthernetUDP *udp = static_cast<EthernetUDP*>(arg);
 
 	/* No more space in the receive queue */
-	if(udp->count >= UDP_RX_MAX_PACKETS) {
+	if(udp->count >= udp->depth) {
+		udp->dropped++;
 		pbuf_free(p);
 		return;
 	}
@@ -151,8 +155,32 @@ size_t EthernetUDP::write(const uint8_t *buffer, size_t size)
 	return size;
 }
 
+bool EthernetUDP::dequeue(struct packet *pkt)
+{
+	/* No more packets in the queue */
+	if(!count)
+		return false;
+
+	/* Take the next packet from the front of the queue */
+	*pkt = packets[front];
+	packets[front].p = NULL;
+
+	count--;
+
+	/* Advance the front of the queue */
+	front++;
+
+	/* Wrap around if end of queue has been reached */
+	if(front == UDP_RX_MAX_PACKETS)
+		front = 0;
+
+	return true;
+}
+
 int EthernetUDP::parsePacket()
 {
+	struct packet pkt;
+
 	_read = 0;
 
 	/* Discard the current packet */
@@ -164,37 +192,77 @@ int EthernetUDP::parsePacket()
 		_destIP = IPAddress(IPADDR_NONE);
 	}
 
-	/* No more packets in the queue */
-	if(!count) {
+	if(!dequeue(&pkt))
 		return 0;
-	}
 
-	/* Take the next packet from the front of the queue */
-	_p = packets[front].p;
-	_remoteIP = packets[front].remoteIP;
-	_remotePort = packets[front].remotePort;
-	_destIP = packets[front].destIP;
+	_p = pkt.p;
+	_remoteIP = pkt.remoteIP;
+	_remotePort = pkt.remotePort;
+	_destIP = pkt.destIP;
 
-	count--;
+	/* Return the total len of the queue */
+	return _p->tot_len;
+}
 
-	/* Advance the front of the queue */
-	front++;
+int EthernetUDP::readPacket(uint8_t *buffer, size_t len, IPAddress *remoteIP, uint16_t *remotePort)
+{
+	struct pbuf *p = takePacket(remoteIP, remotePort);
+	u16_t copied;
 
-	/* Wrap around if end of queue has been reached */
-	if(front == UDP_RX_MAX_PACKETS)
-		front = 0;
+	if(!p)
+		return 0;
 
-	/* Return the total len of the queue */
-	return _p->tot_len;
+	if(len > p->tot_len)
+		len = p->tot_len;
+
+	/* Walks the pbuf chain with one memcpy per segment */
+	copied = pbuf_copy_partial(p, buffer, len, 0);
+	pbuf_free(p);
+
+	return copied;
 }
 
-int EthernetUDP::read()
+struct pbuf *EthernetUDP::takePacket(IPAddress *remoteIP, uint16_t *remotePort)
 {
-	if(!available()) return -1;
+	struct packet pkt;
 
-	uint8_t *buf = (uint8_t *)_p->payload;
-	uint8_t b = buf[_read];
-	_read = _read + 1;
+	if(!dequeue(&pkt))
+		return NULL;
+
+	_remoteIP = pkt.remoteIP;
+	_remotePort = pkt.remotePort;
+	_destIP = pkt.destIP;
+
+	if(remoteIP)
+		*remoteIP = pkt.remoteIP;
+	if(remotePort)
+		*remotePort = pkt.remotePort;
+
+	return pkt.p;
+}
+
+void EthernetUDP::releasePacket(struct pbuf *p)
+{
+	if(p)
+		pbuf_free(p);
+}
+
+void EthernetUDP::setRxQueueDepth(uint8_t packets)
+{
+	if(packets == 0)
+		packets = 1;
+
+	if(packets > UDP_RX_MAX_PACKETS)
+		packets = UDP_RX_MAX_PACKETS;
+
+	/* Packets already queued beyond the new depth are kept
+	 * and drain through parsePacket() as usual */
+	depth = packets;
+}
+
+void EthernetUDP::consume(uint16_t len)
+{
+	_read = _read + len;
 
 	if((_read == _p->len) && _p->next) {
 		_read = 0;
@@ -214,6 +282,15 @@ int EthernetUDP::read()
 		pbuf_free(_p);
 		_p = NULL;
 	}
+}
+
+int EthernetUDP::read()
+{
+	if(!available()) return -1;
+
+	uint8_t *buf = (uint8_t *)_p->payload;
+	uint8_t b = buf[_read];
+	consume(1);
 
 	return b;
 }
@@ -221,22 +298,24 @@ int EthernetUDP::read()
 
 int EthernetUDP::read(unsigned char* buffer, size_t len)
 {
-	uint16_t avail = available();
-	uint16_t i;
-	int b;
+	size_t copied = 0;
+	uint16_t chunk;
 
-	if(!avail)
+	if(!available())
 		return -1;
 
-	/* TODO: Replace lazy method with optimized on */
-	for(i = 0; i < len; i++) {
-		b = read();
-		if(b == -1)
-			break;
-		buffer[i] = b;
+	/* Copy a whole pbuf segment at a time */
+	while(copied < len && _p) {
+		chunk = _p->len - _read;
+		if(chunk > len - copied)
+			chunk = len - copied;
+
+		memcpy(buffer + copied, (uint8_t *)_p->payload + _read, chunk);
+		copied += chunk;
+		consume(chunk);
 	}
 
-	return i;
+	return copied;
 }
 
 int EthernetUDP::peek()
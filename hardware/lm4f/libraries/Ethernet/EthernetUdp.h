@@ -1,6 +1,8 @@
 #ifndef ethernetudp_h
 #define ethernetudp_h
 
+/* Capacity of the receive queue. It sizes a member of EthernetUDP,
+ * so it is fixed; lower the depth at runtime with setRxQueueDepth(). */
 #define UDP_RX_MAX_PACKETS 32
 #define UDP_TX_PACKET_MAX_SIZE 2048
 
@@ -20,6 +22,9 @@ private:
 	uint8_t front;
 	uint8_t rear;
 	uint8_t count;
+	uint8_t depth;
+	/* Datagrams freed because the receive queue was full */
+	uint32_t dropped;
 
 	struct udp_pcb *_pcb;
 	struct pbuf *_p;
@@ -36,6 +41,8 @@ private:
 
 	uint16_t _read;
 	uint16_t _write;
+	bool dequeue(struct packet *pkt);
+	void consume(uint16_t len);
 	static void do_recv(void *arg, struct udp_pcb *upcb, struct pbuf *p, struct ip_addr* addr, uint16_t port);
 	static void do_dns(const char *name, struct ip_addr *ipaddr, void *arg);
 public:
@@ -58,6 +65,22 @@ public:
 	virtual int peek();
 	virtual void flush();
 
+	/* Copy the next queued datagram into buffer in one pass.
+	 * Returns the number of bytes copied, 0 if the queue is empty.
+	 * Datagrams longer than len are truncated. */
+	int readPacket(uint8_t *buffer, size_t len, IPAddress *remoteIP = NULL, uint16_t *remotePort = NULL);
+	/* Zero-copy variant: hand the next queued pbuf chain to the caller,
+	 * who must give it back with releasePacket() once done with it. */
+	struct pbuf *takePacket(IPAddress *remoteIP = NULL, uint16_t *remotePort = NULL);
+	void releasePacket(struct pbuf *p);
+
+	/* Limit the queue to fewer than UDP_RX_MAX_PACKETS entries */
+	void setRxQueueDepth(uint8_t packets);
+	uint8_t rxQueueDepth() { return depth; };
+	uint8_t queuedPackets() { return count; };
+	uint32_t droppedPackets() { return dropped; };
+	void resetDroppedPackets() { dropped = 0; };
+
 	virtual IPAddress remoteIP() { return _remoteIP; };
 	virtual uint16_t remotePort() { return _remotePort; };
 	virtual IPAddress destIP() { return _destIP; };
@@ -148,11 +148,19 @@ static const unsigned long g_ulSSIPins[] = {
 SPIClass::SPIClass(void) {
 	SSIModule = NOT_ACTIVE;
 	SSIBitOrder = MSBFIRST;
+	queueHead = 0;
+	queueActive = 0;
+	queueHeld = 0;
+	queueRunning = 0;
 }
 
 SPIClass::SPIClass(uint8_t module) {
 	SSIModule = module;
 	SSIBitOrder = MSBFIRST;
+	queueHead = 0;
+	queueActive = 0;
+	queueHeld = 0;
+	queueRunning = 0;
 }
   
 void SPIClass::begin() {
@@ -203,6 +211,9 @@ void SPIClass::begin() {
 
 	ROM_SSIEnable(SSIBASE);
 
+	SSIDataMode = SPI_MODE0;
+	SSIDivider = 0;	// set by the bit rate, not a divider
+
 	//clear out any initial data that might be present in the RX FIFO
 	while(ROM_SSIDataGetNonBlocking(SSIBASE, &initialData));
 }
@@ -222,11 +233,13 @@ void SPIClass::setBitOrder(uint8_t bitOrder) {
 void SPIClass::setDataMode(uint8_t mode) {
 	HWREG(SSIBASE + SSI_O_CR0) &= ~(SSI_CR0_SPO | SSI_CR0_SPH);
 	HWREG(SSIBASE + SSI_O_CR0) |= mode;
+	SSIDataMode = mode;
 }
 
 void SPIClass::setClockDivider(uint8_t divider){
   //value must be even
   HWREG(SSIBASE + SSI_O_CPSR) = divider;
+  SSIDivider = divider;
 }
 
 uint8_t SPIClass::transfer(uint8_t data) {
@@ -255,4 +268,179 @@ void SPIClass::setModule(uint8_t module) {
 	begin();
 }
 
+//*****************************************************************************
+//
+// Transaction queue. The SSI FIFOs are kept topped up from the receive
+// interrupt: RXFF fires while four or more bytes wait, RXTO picks up the
+// last few once the line has been idle for 32 bit times.
+//
+//*****************************************************************************
+static SPIClass *g_pSSIQueueOwner[4];
+
+static void SSIQueueIntHandler(uint8_t ssi) {
+	if(g_pSSIQueueOwner[ssi])
+		g_pSSIQueueOwner[ssi]->handleInterrupt();
+}
+
+static void SSI0QueueIntHandler(void) { SSIQueueIntHandler(0); }
+static void SSI1QueueIntHandler(void) { SSIQueueIntHandler(1); }
+static void SSI2QueueIntHandler(void) { SSIQueueIntHandler(2); }
+static void SSI3QueueIntHandler(void) { SSIQueueIntHandler(3); }
+
+static void (* const g_pfnSSIQueueIntHandler[4])(void) = {
+	SSI0QueueIntHandler, SSI1QueueIntHandler,
+	SSI2QueueIntHandler, SSI3QueueIntHandler
+};
+
+static inline uint8_t reverseBits(uint32_t data) {
+	asm("rbit %0, %1" : "=r" (data) : "r" (data));	// reverse order of 32 bits
+	return (uint8_t) (data >> 24);
+}
+
+void SPIClass::attachDevice(SPIDevice *device) {
+	pinMode(device->csPin, OUTPUT);
+	digitalWrite(device->csPin, HIGH);
+}
+
+void SPIClass::queue(SPITransaction *t) {
+	SPITransaction **link, **after = 0;
+	bool start = false;
+
+	t->done = 0;
+
+	bool wasDisabled = ROM_IntMasterDisable();
+	// Behind everything of the same or higher priority, but straight
+	// after the device's own transactions if it has some queued there
+	for(link = &queueHead; *link && (*link)->device->priority >= t->device->priority; link = &(*link)->next) {
+		if((*link)->device == t->device)
+			after = &(*link)->next;
+	}
+	if(after)
+		link = after;
+	t->next = *link;
+	*link = t;
+	if(!queueRunning) {
+		queueRunning = 1;
+		start = true;
+	}
+	if(!wasDisabled)
+		ROM_IntMasterEnable();
+
+	if(start)
+		runQueue();
+}
+
+bool SPIClass::queueBusy() {
+	return queueRunning;
+}
+
+void SPIClass::runQueue() {
+	SPITransaction *t, **link;
+
+	for(;;) {
+		bool wasDisabled = ROM_IntMasterDisable();
+		// while chip select is held only that device may use the bus
+		for(link = &queueHead; *link && queueHeld && (*link)->device != queueHeld; link = &(*link)->next)
+			;
+		t = *link;
+		if(t)
+			*link = t->next;
+		else
+			queueRunning = 0;
+		if(!wasDisabled)
+			ROM_IntMasterEnable();
+		if(!t)
+			return;
+
+		applyDevice(t->device);
+		if(queueHeld != t->device)
+			digitalWrite(t->device->csPin, LOW);
+		queueActive = t;
+		if(startTransaction(t))
+			return;	// finished from the interrupt
+		finishTransaction(t);
+	}
+}
+
+void SPIClass::applyDevice(SPIDevice *device) {
+	if(device->dataMode != SSIDataMode)
+		setDataMode(device->dataMode);
+	if(device->clockDivider != SSIDivider)
+		setClockDivider(device->clockDivider);
+	SSIBitOrder = device->bitOrder;
+}
+
+bool SPIClass::startTransaction(SPITransaction *t) {
+	uint8_t ssi = (SSIBASE - SSI0_BASE) >> 12;
+	uint32_t data;
+
+	if(!t->count)
+		return false;
+
+	if(g_pSSIQueueOwner[ssi] != this) {
+		g_pSSIQueueOwner[ssi] = this;
+		SSIIntRegister(SSIBASE, g_pfnSSIQueueIntHandler[ssi]);
+	}
+
+	while(ROM_SSIDataGetNonBlocking(SSIBASE, &data));
+
+	queueTx = 0;
+	queueRx = 0;
+	fillFifo(t);
+	ROM_SSIIntClear(SSIBASE, SSI_RXTO | SSI_RXOR);
+	ROM_SSIIntEnable(SSIBASE, SSI_RXFF | SSI_RXTO);
+	return true;
+}
+
+void SPIClass::fillFifo(SPITransaction *t) {
+	uint32_t data;
+
+	// never more than the receive FIFO holds in flight
+	while(queueTx < t->count && queueTx - queueRx < 8) {
+		data = t->buf[queueTx];
+		if(SSIBitOrder == LSBFIRST)
+			data = reverseBits(data);
+		if(!ROM_SSIDataPutNonBlocking(SSIBASE, data))
+			break;
+		queueTx++;
+	}
+}
+
+void SPIClass::finishTransaction(SPITransaction *t) {
+	queueActive = 0;
+	if(t->flags & SPI_KEEP_CS) {
+		queueHeld = t->device;
+	} else {
+		digitalWrite(t->device->csPin, HIGH);
+		queueHeld = 0;
+	}
+	t->done = 1;
+	if(t->callback)
+		t->callback(t);
+}
+
+void SPIClass::handleInterrupt() {
+	SPITransaction *t = queueActive;
+	uint32_t data;
+
+	ROM_SSIIntClear(SSIBASE, SSI_RXTO | SSI_RXOR);
+	if(!t) {
+		ROM_SSIIntDisable(SSIBASE, SSI_RXFF | SSI_RXTO);
+		return;
+	}
+
+	while(ROM_SSIDataGetNonBlocking(SSIBASE, &data)) {
+		if(!(t->flags & SPI_TX_ONLY))
+			t->buf[queueRx] = (SSIBitOrder == LSBFIRST) ? reverseBits(data) : (uint8_t) data;
+		queueRx++;
+	}
+	fillFifo(t);
+
+	if(queueRx >= t->count) {
+		ROM_SSIIntDisable(SSIBASE, SSI_RXFF | SSI_RXTO);
+		finishTransaction(t);
+		runQueue();
+	}
+}
+
 SPIClass SPI;
@@ -80,6 +80,13 @@ int16_t WiFiClass::_typeArray[MAX_SOCK_NUM];
 int16_t WiFiClass::_serverPortArray[MAX_SOCK_NUM];
 WiFiClient WiFiClass::clients[MAX_SOCK_NUM];
 
+//
+//readiness cache filled in by poll()
+//
+bool WiFiClass::_pollActive = false;
+SlFdSet_t WiFiClass::_polledSet;
+SlFdSet_t WiFiClass::_readySet;
+
 //
 //initializing pins for cc3100 for launchpad+boosterpack arrangement
 //
@@ -185,6 +192,87 @@ uint8_t WiFiClass::getSocket()
     return NO_SOCKET_AVAIL;
 }
 
+int WiFiClass::poll(unsigned long timeout)
+{
+    //
+    //send coalesced client output that has waited long enough
+    //
+    WiFiClient::_txExpire();
+
+    //
+    //gather every open handle into one read set
+    //
+    int16_t maxHandle = -1;
+    SL_FD_ZERO(&_polledSet);
+    for (uint8_t i = 0; i < MAX_SOCK_NUM; ++i) {
+        if (_handleArray[i] >= 0) {
+            SL_FD_SET(_handleArray[i], &_polledSet);
+            if (_handleArray[i] > maxHandle) {
+                maxHandle = _handleArray[i];
+            }
+        }
+    }
+
+    if (maxHandle < 0) {
+        _pollActive = false;
+        return 0;
+    }
+
+    SlTimeval_t tv;
+    tv.tv_sec = timeout / 1000;
+    tv.tv_usec = (timeout % 1000) * 1000;
+
+    //
+    //sl_Select overwrites the set with the readable handles
+    //
+    _readySet = _polledSet;
+    int iRet = sl_Select(maxHandle + 1, &_readySet, NULL, NULL, &tv);
+    if (iRet < 0) {
+        //
+        //on error drop the cache so every socket goes back to polling itself
+        //
+        _pollActive = false;
+        return iRet;
+    }
+
+    if (iRet == 0) {
+        SL_FD_ZERO(&_readySet);
+    }
+
+    _pollActive = true;
+    return iRet;
+}
+
+bool WiFiClass::_pollCovers(int16_t handle)
+{
+    return _pollActive && SL_FD_ISSET(handle, &_polledSet);
+}
+
+bool WiFiClass::_pollReady(int16_t handle)
+{
+    if (!_pollCovers(handle)) {
+        return true;
+    }
+
+    return SL_FD_ISSET(handle, &_readySet);
+}
+
+void WiFiClass::_pollIdle(int16_t handle)
+{
+    if (_pollActive) {
+        SL_FD_CLR(handle, &_readySet);
+    }
+}
+
+void WiFiClass::_pollForget(int16_t handle)
+{
+    //
+    //a freshly created socket may reuse a polled handle, so its cached
+    //readiness no longer applies
+    //
+    SL_FD_CLR(handle, &_polledSet);
+}
+
 
 const char * WiFiClass::driverVersion()
 {
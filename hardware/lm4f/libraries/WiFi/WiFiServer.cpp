@@ -106,6 +106,7 @@ void WiFiServer::begin()
     //
     _socketIndex = socketIndex;
     WiFiClass::_handleArray[socketIndex] = socketHandle;
+    WiFiClass::_pollForget(socketHandle);
     WiFiClass::_portArray[socketIndex] = _port;
     WiFiClass::_typeArray[socketIndex] = TYPE_TCP_SERVER;
 }
@@ -129,9 +130,16 @@ WiFiClient WiFiServer::available(byte* status)
     
     //
     //get the client handle, if there's a queued client. If no client, return 0
+    //(a listening socket polled idle by WiFi.poll() has no queued client)
     //
     int socketHandle = WiFiClass::_handleArray[_socketIndex];
-    int clientHandle = sl_Accept(socketHandle, (SlSockAddr_t*)&clientAddress, &clientAddressSize);
+    int clientHandle = -1;
+    if (WiFiClass::_pollReady(socketHandle)) {
+        clientHandle = sl_Accept(socketHandle, (SlSockAddr_t*)&clientAddress, &clientAddressSize);
+        if (clientHandle < 0) {
+            WiFiClass::_pollIdle(socketHandle);
+        }
+    }
 
     //
     //We've successfully created a socket, so store everything in the wificlass
@@ -139,6 +147,8 @@ WiFiClient WiFiServer::available(byte* status)
     //
     if (clientHandle > 0) {
         WiFiClass::_handleArray[clientSocketIndex] = clientHandle;
+        WiFiClass::_pollForget(clientHandle);
+        WiFiClient::_txForget(clientSocketIndex);
         WiFiClass::_typeArray[clientSocketIndex] = TYPE_TCP_CONNECTED_CLIENT;
         WiFiClass::_portArray[clientSocketIndex] = sl_Htons(clientAddress.sin_port);
         WiFiClass::_serverPortArray[clientSocketIndex] = _port;
@@ -83,6 +83,7 @@ uint8_t WiFiUDP::begin(uint16_t port)
     //
     _socketIndex = socketIndex;
     WiFiClass::_handleArray[socketIndex] = socketHandle;
+    WiFiClass::_pollForget(socketHandle);
     WiFiClass::_portArray[socketIndex] = port;
     WiFiClass::_typeArray[socketIndex] = TYPE_UDP_PORT;
     return 1;
@@ -258,27 +259,37 @@ int WiFiUDP::parsePacket()
         return 0;
     }
     
+    int socketHandle = WiFiClass::_handleArray[_socketIndex];
+
     //
-    //the sl_select command blocks until something interesting happens or
-    //it times out (current timeout set for 10 ms, the minimum)
+    //a socket covered by the last WiFi.poll() already has its answer: skip the
+    //per-socket select when it is idle, and go straight to the read otherwise
     //
-    SlTimeval_t timeout;
-    timeout.tv_sec = 0;
-    timeout.tv_usec = 10000;
-    
-    int socketHandle = WiFiClass::_handleArray[_socketIndex];
-    
-    SlFdSet_t readSocketHandles, errorSocketHandles;
-    SL_FD_ZERO(&readSocketHandles);
-    SL_FD_ZERO(&errorSocketHandles);
-    SL_FD_SET(socketHandle, &readSocketHandles);
-    SL_FD_SET(socketHandle, &errorSocketHandles);
-    
-    int iRet = sl_Select(socketHandle+1, &readSocketHandles, NULL, &errorSocketHandles, &timeout);
-    if (iRet <= 0) {
+    if (!WiFiClass::_pollReady(socketHandle)) {
         return 0;
     }
 
+    if (!WiFiClass::_pollCovers(socketHandle)) {
+        //
+        //the sl_select command blocks until something interesting happens or
+        //it times out (current timeout set for 10 ms, the minimum)
+        //
+        SlTimeval_t timeout;
+        timeout.tv_sec = 0;
+        timeout.tv_usec = 10000;
+
+        SlFdSet_t readSocketHandles, errorSocketHandles;
+        SL_FD_ZERO(&readSocketHandles);
+        SL_FD_ZERO(&errorSocketHandles);
+        SL_FD_SET(socketHandle, &readSocketHandles);
+        SL_FD_SET(socketHandle, &errorSocketHandles);
+
+        int iRet = sl_Select(socketHandle+1, &readSocketHandles, NULL, &errorSocketHandles, &timeout);
+        if (iRet <= 0) {
+            return 0;
+        }
+    }
+
     //
     //Since we've reached this point, the sl_select command has indicated
     //that either we're going to get an error, or an immediate read
@@ -287,6 +298,11 @@ int WiFiUDP::parsePacket()
     int AddrSize = sizeof(address);
     int bytes = sl_RecvFrom(socketHandle, rx_buf, UDP_RX_PACKET_MAX_SIZE, 0, (SlSockAddr_t*)&address, (SlSocklen_t*)&AddrSize);
 
+    //
+    //one datagram per poll: further ones are picked up after the next WiFi.poll()
+    //
+    WiFiClass::_pollIdle(socketHandle);
+
     //
     //store the sender's address (sl_HtonX reorders bits to processor order)
     //!! Although this follows some examples (upd_socket), it goes against the
@@ -248,11 +248,28 @@ void pinMode_int(uint8_t, uint16_t);
 void digitalWrite(uint8_t, uint8_t);
 int digitalRead(uint8_t);
 void analogReadResolution(int res);
+/* With the cache on, analogRead() leaves the ADC and reference powered
+ * and set up between calls and only changes the channel when the pin
+ * changes. Turning it off powers the ADC down again. */
+#define ANALOG_READ_CACHE_AVAILABLE
+void analogReadCache(uint8_t enable);
 uint16_t analogRead(uint8_t);
 void analogWrite(uint8_t, int);
 void analogReference(uint16_t);
 void analogFrequency(uint32_t);
 void analogResolution(uint16_t);
+#if defined(__MSP430_HAS_ADC12_PLUS__) || defined(__MSP430_HAS_ADC12_B__)
+/* Timer triggered sampling of up to 16 pins into a ring of two blocks
+ * of blockLength raw results each, the pins interleaved. The callback
+ * gets each block as it fills, in interrupt context, and the block stays
+ * valid while the other one fills. rate is per pin; blockLength must be
+ * a multiple of count. Returns 0 if the arguments can not be met or
+ * the trigger timer is in use. */
+#define ANALOG_STREAM_AVAILABLE
+uint8_t analogStreamBegin(const uint8_t *pins, uint8_t count, uint32_t rate,
+	uint16_t *buffer, uint16_t blockLength, void (*callback)(uint16_t *block, uint16_t length));
+void analogStreamEnd(void);
+#endif
 
 
 
@@ -260,11 +277,100 @@ void delay(uint32_t milliseconds);
 void sleep(uint32_t milliseconds);
 void sleepSeconds(uint32_t seconds);
 void suspend(void);
+/* Milliseconds spent in LPM0 by delay() and in LPM3 by sleep() since
+ * reset or resetLowPowerTime(); other modes read 0. */
+#define LOW_POWER_SLEEP 0
+#define LOW_POWER_DEEPSLEEP 1
+unsigned long lowPowerTime(uint8_t mode);
+void resetLowPowerTime(void);
 extern volatile boolean stay_asleep;
 #define wakeup() { stay_asleep = false; }
 
 void attachInterrupt(uint8_t, void (*)(void), int mode);
 void detachInterrupt(uint8_t);
+#if defined(P1IV_) || defined(P1IV)
+/* Parts with PxIV only. interruptDebounce() drops edges that come within
+ * the given time of the last accepted edge on the pin, 0 turns it off.
+ * The latency hook runs before each callback with the pin and the
+ * microseconds since the port interrupt was entered. */
+#define INTERRUPT_DEBOUNCE_AVAILABLE
+void interruptDebounce(uint8_t pin, unsigned int microseconds);
+void attachInterruptLatencyHook(void (*hook)(uint8_t pin, unsigned int latency));
+#endif
+
+/* Pins of one port written or read together in a single register
+ * access. portGroupInit() returns 0, and leaves port at NOT_A_PORT, if
+ * the pins are not all on one port. The pins must already be set up
+ * with pinMode(); portWrite() changes only the bits in mask. */
+#define PORT_GROUP_AVAILABLE
+#define PORT_GROUP_SCATTERED 0xFF
+typedef struct {
+	uint8_t port;
+	uint8_t mask;		/* port bits of all pins in the group */
+	uint8_t shift;		/* value bit i is port bit shift + i, or PORT_GROUP_SCATTERED */
+	uint8_t count;
+	uint8_t bits[8];	/* port bit of each value bit */
+} PortGroup;
+
+uint8_t portGroupInit(PortGroup *group, const uint8_t *pins, uint8_t count);
+void portGroupWrite(const PortGroup *group, uint8_t value);
+uint8_t portGroupRead(const PortGroup *group);
+void portWrite(uint8_t port, uint8_t mask, uint8_t value);
+uint8_t portRead(uint8_t port);
+
+/* Timer allocation. A channel is one compare register, named as in
+ * digital_pin_to_timer (T0A0 .. T2B2). A timer runs in one mode at a
+ * time and its channels can only be claimed in that mode:
+ *   TIMER_MODE_UP          CCR0 sets one period for all channels (analogWrite)
+ *   TIMER_MODE_CONTINUOUS  each channel schedules its own compares (tone, Servo, ...)
+ *   TIMER_MODE_EXCLUSIVE   claimed through TxA0/TxB0, the whole timer is one owner's
+ * timerClaim() returns 0 if the channel or its timer is taken by someone
+ * else. timerOwner() tells who holds a channel, timerOwnerName() names it. */
+#define TIMER_OWNER_NONE      0
+#define TIMER_OWNER_TIMEBASE  1
+#define TIMER_OWNER_PWM       2
+#define TIMER_OWNER_TONE      3
+#define TIMER_OWNER_SERVO     4
+#define TIMER_OWNER_TASK      5
+#define TIMER_OWNER_ADC       6
+#define TIMER_OWNER_USER      7
+#define TIMER_MODE_NONE       0
+#define TIMER_MODE_UP         1
+#define TIMER_MODE_CONTINUOUS 2
+#define TIMER_MODE_EXCLUSIVE  3
+#define TIMER_CHANNELS        (T2B2 + 1)
+#define TIMER_CHANNEL_NONE    0xFF
+
+uint8_t timerClaim(uint8_t channel, uint8_t mode, uint8_t owner);
+void timerRelease(uint8_t channel, uint8_t owner);
+uint8_t timerOwner(uint8_t channel);
+const char *timerOwnerName(uint8_t owner);
+
+/* Timer_A channels shared in continuous mode at TIMER_COMPARE_FREQ.
+ * The core owns the interrupt vectors of the timers it hands out and calls
+ * each channel's handler at its compare; the handler returns the ticks
+ * until its next call, or 0 to give the channel up. timerCompareAttach()
+ * returns the channel, or TIMER_CHANNEL_NONE if none is free. Channels
+ * come from Timer0_A, and after timerCompareUseTimer1() preferably from
+ * Timer1_A, so that analogWrite() keeps the Timer0_A pins. A timer that
+ * does PWM is never taken, and while a timer hands out channels
+ * analogWrite() falls back to digital output on its pins. */
+#define TIMER_COMPARE_FREQ    (F_CPU / 8L)
+uint8_t timerCompareAttach(uint16_t (*handler)(uint8_t channel), uint16_t first, uint8_t owner);
+void timerCompareDetach(uint8_t channel);
+void timerCompareUseTimer1(void);
+
+#if defined(__MSP430_HAS_DMAX_3__) || defined(__MSP430_HAS_DMAX_6__)
+/* DMA channel allocation. The core owns the DMA interrupt vector and
+ * calls the handler of the channel that completed; the driver enables
+ * that interrupt itself with DMAIE. dmaClaim() selects the trigger
+ * (0..31, as in the DMAxTSEL field) and returns 0 if the channel is
+ * taken. dmaRelease() stops the channel and gives it back. On USB parts
+ * channel 0 is used by USBSerial without being claimed. */
+#define DMA_AVAILABLE
+uint8_t dmaClaim(uint8_t channel, uint8_t trigger, void (*handler)(uint8_t channel));
+void dmaRelease(uint8_t channel);
+#endif
 
 extern const uint8_t digital_pin_to_timer[];
 extern const uint8_t digital_pin_to_port[];
@@ -337,6 +443,7 @@ long map(long, long, long, long, long);
 #endif
 
 #include "pins_energia.h"
+#include "FastPin.h"
 
 #endif
 
@@ -0,0 +1,196 @@
+/*
+  ************************************************************************
+  *	FastPin.h
+  *
+  *	Compile-time digital I/O for the MSP430 core
+  *
+  ***********************************************************************
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General
+  Public License along with this library; if not, write to the
+  Free Software Foundation, Inc., 59 Temple Place, Suite 330,
+  Boston, MA  02111-1307  USA
+*/
+
+#ifndef FastPin_h
+#define FastPin_h
+
+/*
+ * When the pin is a constant, port and bit mask come from copies of the
+ * variant's tables that the compiler folds away, and the port registers
+ * are resolved by name, so a write is a single bis.b/bic.b on PxOUT.
+ * Pins that are not constant fall back to digitalWrite()/digitalRead().
+ */
+static const uint8_t fast_pin_to_port[] __attribute__((unused)) = DIGITAL_PIN_TO_PORT;
+static const uint8_t fast_pin_to_bit_mask[] __attribute__((unused)) = DIGITAL_PIN_TO_BIT_MASK;
+
+#define FAST_PORT_CASE(n, reg) case P##n: return (volatile uint8_t *)&P##n##reg;
+#ifdef __MSP430_HAS_PORT3_R__
+#define FAST_PORT3(reg) FAST_PORT_CASE(3, reg)
+#else
+#define FAST_PORT3(reg)
+#endif
+#ifdef __MSP430_HAS_PORT4_R__
+#define FAST_PORT4(reg) FAST_PORT_CASE(4, reg)
+#else
+#define FAST_PORT4(reg)
+#endif
+#ifdef __MSP430_HAS_PORT5_R__
+#define FAST_PORT5(reg) FAST_PORT_CASE(5, reg)
+#else
+#define FAST_PORT5(reg)
+#endif
+#ifdef __MSP430_HAS_PORT6_R__
+#define FAST_PORT6(reg) FAST_PORT_CASE(6, reg)
+#else
+#define FAST_PORT6(reg)
+#endif
+#ifdef __MSP430_HAS_PORT7_R__
+#define FAST_PORT7(reg) FAST_PORT_CASE(7, reg)
+#else
+#define FAST_PORT7(reg)
+#endif
+#ifdef __MSP430_HAS_PORT8_R__
+#define FAST_PORT8(reg) FAST_PORT_CASE(8, reg)
+#else
+#define FAST_PORT8(reg)
+#endif
+#ifdef __MSP430_HAS_PORT9_R__
+#define FAST_PORT9(reg) FAST_PORT_CASE(9, reg)
+#else
+#define FAST_PORT9(reg)
+#endif
+#ifdef __MSP430_HAS_PORT10_R__
+#define FAST_PORT10(reg) FAST_PORT_CASE(10, reg)
+#else
+#define FAST_PORT10(reg)
+#endif
+#ifdef __MSP430_HAS_PORT11_R__
+#define FAST_PORT11(reg) FAST_PORT_CASE(11, reg)
+#else
+#define FAST_PORT11(reg)
+#endif
+#ifdef __MSP430_HAS_PORT12_R__
+#define FAST_PORT12(reg) FAST_PORT_CASE(12, reg)
+#else
+#define FAST_PORT12(reg)
+#endif
+#ifdef __MSP430_HAS_PORTJ_R__
+#define FAST_PORTJ(reg) FAST_PORT_CASE(J, reg)
+#else
+#define FAST_PORTJ(reg)
+#endif
+
+#define FAST_PORT_CASES(reg) \
+	FAST_PORT_CASE(1, reg) FAST_PORT_CASE(2, reg) FAST_PORT3(reg) \
+	FAST_PORT4(reg) FAST_PORT5(reg) FAST_PORT6(reg) FAST_PORT7(reg) \
+	FAST_PORT8(reg) FAST_PORT9(reg) FAST_PORT10(reg) FAST_PORT11(reg) \
+	FAST_PORT12(reg) FAST_PORTJ(reg)
+
+static inline __attribute__((always_inline)) volatile uint8_t *fastPortOutputRegister(uint8_t port)
+{
+	switch (port) {
+	FAST_PORT_CASES(OUT)
+	}
+	return 0;
+}
+
+static inline __attribute__((always_inline)) volatile uint8_t *fastPortInputRegister(uint8_t port)
+{
+	switch (port) {
+	FAST_PORT_CASES(IN)
+	}
+	return 0;
+}
+
+/* non-zero if a peripheral function is selected for the pin, e.g. by analogWrite() */
+static inline __attribute__((always_inline)) uint8_t fastPinSelected(uint8_t port, uint8_t bit)
+{
+	uint8_t sel = 0;
+#if (defined(P1SEL_) || defined(P1SEL))
+	sel |= *portSel0Register(port);
+#endif
+#if (defined(P1SEL2_) || defined(P1SEL2))
+	sel |= *portSel2Register(port);
+#endif
+#if (defined(P1SEL0_) || defined(P1SEL0))
+	sel |= *portSel0Register(port);
+#endif
+#if (defined(P1SEL1_) || defined(P1SEL1))
+	sel |= *portSel1Register(port);
+#endif
+	return sel & bit;
+}
+
+/*
+ * As digitalWrite(), but the PxSEL registers are only written when the
+ * pin is not GPIO already.
+ */
+static inline __attribute__((always_inline)) void digitalWriteFast(uint8_t pin, uint8_t val)
+{
+	if (__builtin_constant_p(pin) && fast_pin_to_port[pin] != NOT_A_PORT
+	    && !fastPinSelected(fast_pin_to_port[pin], fast_pin_to_bit_mask[pin])) {
+		if (val == LOW)
+			*fastPortOutputRegister(fast_pin_to_port[pin]) &= ~fast_pin_to_bit_mask[pin];
+		else
+			*fastPortOutputRegister(fast_pin_to_port[pin]) |= fast_pin_to_bit_mask[pin];
+	} else {
+		digitalWrite(pin, val);
+	}
+}
+
+static inline __attribute__((always_inline)) int digitalReadFast(uint8_t pin)
+{
+	if (__builtin_constant_p(pin) && fast_pin_to_port[pin] != NOT_A_PORT
+	    && !fastPinSelected(fast_pin_to_port[pin], fast_pin_to_bit_mask[pin])) {
+		return (*fastPortInputRegister(fast_pin_to_port[pin]) & fast_pin_to_bit_mask[pin]) ? HIGH : LOW;
+	}
+	return digitalRead(pin);
+}
+
+#ifdef __cplusplus
+void fastPinNotAPort(void) __attribute__((error("FastPin<> used with a pin that has no port (e.g. VCC or GND)")));
+
+/*
+ * FastPin<P1_0>::high(), or FastPin<RED_LED> led; led.toggle();
+ * Writes and reads are single instructions on PxOUT/PxIN and leave PxSEL
+ * alone, so the pin must have been set up with mode() or pinMode().
+ * A pin without a port does not compile; built without optimization,
+ * where the tables are not folded, its writes do nothing and reads are LOW.
+ */
+template<uint8_t pin>
+class FastPin
+{
+	public:
+		static inline void mode(uint8_t mode) { pinMode(pin, mode); }
+		static inline void high(void) { if (hasPort()) *fastPortOutputRegister(fast_pin_to_port[pin]) |= fast_pin_to_bit_mask[pin]; }
+		static inline void low(void) { if (hasPort()) *fastPortOutputRegister(fast_pin_to_port[pin]) &= ~fast_pin_to_bit_mask[pin]; }
+		static inline void toggle(void) { if (hasPort()) *fastPortOutputRegister(fast_pin_to_port[pin]) ^= fast_pin_to_bit_mask[pin]; }
+		static inline void write(uint8_t val) { if (val == LOW) low(); else high(); }
+		static inline int read(void) { return (hasPort() && (*fastPortInputRegister(fast_pin_to_port[pin]) & fast_pin_to_bit_mask[pin])) ? HIGH : LOW; }
+
+	private:
+		/* the register lookup gives 0 for NOT_A_PORT, which is IE1 on the G2xx */
+		static inline __attribute__((always_inline)) bool hasPort(void)
+		{
+			if (fast_pin_to_port[pin] != NOT_A_PORT)
+				return true;
+#ifdef __OPTIMIZE__
+			fastPinNotAPort();
+#endif
+			return false;
+		}
+};
+#endif
+
+#endif
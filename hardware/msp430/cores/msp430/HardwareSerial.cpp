@@ -216,6 +216,32 @@ int HardwareSerial::read(void)
 	}
 }
 
+// copy out of the ring in at most two pieces, never waits
+int HardwareSerial::read(uint8_t *buffer, size_t size)
+{
+	const uint8_t *data;
+	size_t count = 0, n;
+
+	while (count < size && (n = peekBuffer(&data)) > 0) {
+		if (n > size - count)
+			n = size - count;
+		memcpy(buffer + count, data, n);
+		count += n;
+		_rx_buffer->tail = (unsigned int)(_rx_buffer->tail + n) % SERIAL_BUFFER_SIZE;
+	}
+	return count;
+}
+
+// the bytes from tail up to head, or up to the end of the ring if it wraps
+size_t HardwareSerial::peekBuffer(const uint8_t **data)
+{
+	unsigned int head = _rx_buffer->head;
+	unsigned int tail = _rx_buffer->tail;
+
+	*data = &_rx_buffer->buffer[tail];
+	return (head >= tail ? head : SERIAL_BUFFER_SIZE) - tail;
+}
+
 void HardwareSerial::flush()
 {
 	while (_tx_buffer->head != _tx_buffer->tail);
@@ -24,7 +24,6 @@
 #include "Stream.h"
 
 #define PARSE_TIMEOUT 1000  // default number of milli-seconds to wait
-#define NO_SKIP_CHAR  1  // a magic char not found in a valid ASCII numeric field
 
 // private method to read stream with timeout
 int Stream::timedRead()
@@ -64,9 +63,139 @@ int Stream::peekNextDigit()
   }
 }
 
+// private method to take whatever is buffered in one bulk read
+// asks for no more than available() so a blocking read(buffer, length)
+// implementation cannot stall the timeout handling
+size_t Stream::readAvailable(uint8_t *buffer, size_t length)
+{
+  int n = available();
+  if (n <= 0) return 0;
+  if ((size_t)n < length) length = n;
+  n = read(buffer, length);
+  return n > 0 ? n : 0;
+}
+
+// private method to drop bytes that peekBuffer() has shown to be there
+void Stream::skipBuffered(size_t count)
+{
+  uint8_t scratch[16];
+  int got;
+  while (count > 0) {
+    got = read(scratch, count < sizeof(scratch) ? count : sizeof(scratch));
+    if (got <= 0) break;
+    count -= got;
+  }
+}
+
+static const unsigned long parse_pow10[] = {
+  1UL, 10UL, 100UL, 1000UL, 10000UL, 100000UL,
+  1000000UL, 10000000UL, 100000000UL, 1000000000UL
+};
+
+// private method that scans a number for the parse functions
+// leading characters that are not digits or '-' are discarded, the number
+// ends at the first character that is not a digit, one of the skipChars
+// or, when maxFrac is not 0, the decimal point. Digits are gathered as
+// integers: the integer part in intPart, up to maxFrac decimals in frac
+// and their count in fracDigits. Buffered data is scanned in place and
+// only characters that are not buffered yet go through timedPeek().
+// returns -1 or 1 for the sign, 0 if it timed out before a digit
+int Stream::parseNumber(const char *skipChars, uint8_t maxFrac, unsigned long *intPart,
+                        unsigned long *frac, uint8_t *fracDigits)
+{
+  const uint8_t *data = NULL;
+  size_t n = 0, i = 0;   // buffered span and how much of it was scanned
+  unsigned long value = 0, decimals = 0;
+  uint8_t digits = 0;
+  boolean buffered = true;
+  boolean started = false;
+  boolean isFraction = false;
+  int sign = 1;
+  int c;
+
+  while (1) {
+    if (i == n && buffered) {
+      if (i)
+        skipBuffered(i);
+      i = 0;
+      n = peekBuffer(&data);
+      buffered = n > 0;  // once it runs dry, finish the number byte by byte
+    }
+    c = n ? data[i] : timedPeek();
+    if (c < 0)
+      break;  // timeout
+
+    if (c >= '0' && c <= '9') {
+      if (!isFraction)
+        value = value * 10 + c - '0';
+      else if (digits < maxFrac) {
+        decimals = decimals * 10 + c - '0';
+        digits++;
+      }
+      started = true;
+    } else if (!started) {
+      if (c == '-') {
+        sign = -1;
+        started = true;
+      }
+      // anything else ahead of the number is discarded
+    } else if (c == '.' && maxFrac) {
+      isFraction = true;
+    } else if (c == 0 || skipChars == NULL || strchr(skipChars, c) == NULL) {
+      break;  // first character that is not part of the number, left unread
+    }
+
+    // consume the character
+    if (n)
+      i++;
+    else
+      read();
+  }
+  skipBuffered(i);
+
+  *intPart = value;
+  *frac = decimals;
+  *fracDigits = digits;
+  return started ? sign : 0;
+}
+
+// one step of the findUntil matcher
+// returns 1 if the target is complete, -1 if the terminator is, 0 otherwise
+static int findStep(int c, char *target, size_t targetLen, size_t &index,
+                    char *terminator, size_t termLen, size_t &termIndex)
+{
+  if(c != target[index])
+    index = 0; // reset index if any char does not match
+
+  if( c == target[index]){
+    if(++index >= targetLen){ // return true if all chars in the target match
+      return 1;
+    }
+  }
+
+  if(termLen > 0 && c == terminator[termIndex]){
+    if(++termIndex >= termLen)
+      return -1;       // return false if terminate string found before target string
+  }
+  else
+    termIndex = 0;
+  return 0;
+}
+
 // Public Methods
 //////////////////////////////////////////////////////////////
 
+// default bulk read for streams without a buffer of their own
+// takes bytes from read() until it runs dry, never waits
+int Stream::read(uint8_t *buffer, size_t length)
+{
+  size_t count = 0;
+  int c;
+  while (count < length && (c = read()) >= 0)
+    buffer[count++] = (uint8_t)c;
+  return count;
+}
+
 void Stream::setTimeout(unsigned long timeout)  // sets the maximum number of milliseconds to wait
 {
   _timeout = timeout;
@@ -98,30 +227,36 @@ bool Stream::findUntil(char *target, size_t targetLen, char *terminator, size_t
 {
   size_t index = 0;  // maximum target string length is 64k bytes!
   size_t termIndex = 0;
-  int c;
+  const uint8_t *data;
+  size_t n, i;
+  int c, result;
   
   if( *target == 0)
     return true;   // return true if target is a null string
-  while( (c = timedRead()) > 0){
-    
-    if(c != target[index])
-      index = 0; // reset index if any char does not match
-    
-    if( c == target[index]){
-      //////Serial.print("found "); Serial.write(c); Serial.print("index now"); Serial.println(index+1);
-      if(++index >= targetLen){ // return true if all chars in the target match
-        return true;
+  while (1) {
+    // match against the buffered bytes first, then drop what was scanned
+    n = peekBuffer(&data);
+    if (n) {
+      result = 0;
+      for (i = 0; i < n && result == 0; ) {
+        c = data[i++];
+        if (c == 0)
+          result = -1;  // a null ends the search, as for timedRead() below
+        else
+          result = findStep(c, target, targetLen, index, terminator, termLen, termIndex);
       }
+      skipBuffered(i);
+      if (result)
+        return result > 0;
+      continue;
     }
-    
-    if(termLen > 0 && c == terminator[termIndex]){
-      if(++termIndex >= termLen)
-        return false;       // return false if terminate string found before target string
-    }
-    else
-      termIndex = 0;
+
+    if ((c = timedRead()) <= 0)
+      return false;
+    result = findStep(c, target, targetLen, index, terminator, termLen, termIndex);
+    if (result)
+      return result > 0;
   }
-  return false;
 }
 
 
@@ -130,83 +265,75 @@ bool Stream::findUntil(char *target, size_t targetLen, char *terminator, size_t
 // function is terminated by the first character that is not a digit.
 long Stream::parseInt()
 {
-  return parseInt(NO_SKIP_CHAR); // terminate on first non-digit character (or timeout)
+  return parseInt((const char *)NULL); // terminate on first non-digit character (or timeout)
 }
 
 // as above but a given skipChar is ignored
 // this allows format characters (typically commas) in values to be ignored
 long Stream::parseInt(char skipChar)
 {
-  boolean isNegative = false;
-  long value = 0;
-  int c;
+  char skipChars[2] = { skipChar, 0 };
+  return parseInt(skipChars);
+}
 
-  c = peekNextDigit();
-  // ignore non numeric leading characters
-  if(c < 0)
-    return 0; // zero returned if timeout
-
-  do{
-    if(c == skipChar)
-      ; // ignore this charactor
-    else if(c == '-')
-      isNegative = true;
-    else if(c >= '0' && c <= '9')        // is c a digit?
-      value = value * 10 + c - '0';
-    read();  // consume the character we got with peek
-    c = timedPeek();
-  }
-  while( (c >= '0' && c <= '9') || c == skipChar );
+// as above but any of the skipChars is ignored
+long Stream::parseInt(const char *skipChars)
+{
+  unsigned long value, frac;
+  uint8_t digits;
+  int sign = parseNumber(skipChars, 0, &value, &frac, &digits);
 
-  if(isNegative)
-    value = -value;
-  return value;
+  // zero returned if timeout
+  return sign < 0 ? -(long)value : (long)value;
 }
 
 
 // as parseInt but returns a floating point value
 float Stream::parseFloat()
 {
-  return parseFloat(NO_SKIP_CHAR);
+  return parseFloat((const char *)NULL);
 }
 
 // as above but the given skipChar is ignored
 // this allows format characters (typically commas) in values to be ignored
-float Stream::parseFloat(char skipChar){
-  boolean isNegative = false;
-  boolean isFraction = false;
-  long value = 0;
-  char c;
-  float fraction = 1.0;
-
-  c = peekNextDigit();
-    // ignore non numeric leading characters
-  if(c < 0)
-    return 0; // zero returned if timeout
-
-  do{
-    if(c == skipChar)
-      ; // ignore
-    else if(c == '-')
-      isNegative = true;
-    else if (c == '.')
-      isFraction = true;
-    else if(c >= '0' && c <= '9')  {      // is c a digit?
-      value = value * 10 + c - '0';
-      if(isFraction)
-         fraction *= 0.1;
-    }
-    read();  // consume the character we got with peek
-    c = timedPeek();
-  }
-  while( (c >= '0' && c <= '9')  || c == '.' || c == skipChar );
+float Stream::parseFloat(char skipChar)
+{
+  char skipChars[2] = { skipChar, 0 };
+  return parseFloat(skipChars);
+}
 
-  if(isNegative)
-    value = -value;
-  if(isFraction)
-    return value * fraction;
-  else
-    return value;
+// the digits are gathered as integers, so only the final conversion
+// uses floating point math
+float Stream::parseFloat(const char *skipChars)
+{
+  unsigned long value, frac;
+  uint8_t digits;
+  int sign = parseNumber(skipChars, 9, &value, &frac, &digits);
+  float result = value;
+
+  if (digits)
+    result += (float)frac / parse_pow10[digits];
+  return sign < 0 ? -result : result;
+}
+
+
+// as parseFloat but returns a Q16.16 fixed point value
+long Stream::parseFixed()
+{
+  return parseFixed((const char *)NULL);
+}
+
+long Stream::parseFixed(const char *skipChars)
+{
+  unsigned long value, frac;
+  uint8_t digits;
+  int sign = parseNumber(skipChars, 5, &value, &frac, &digits);
+
+  // scale the decimals to 5 digits, then frac / 100000 * 65536 rounded,
+  // done as (frac * 32768 + 25000) / 50000 to stay within 32 bits
+  frac *= parse_pow10[5 - digits];
+  value = (value << 16) + (((frac << 15) + 25000UL) / 50000UL);
+  return sign < 0 ? -(long)value : (long)value;
 }
 
 // read characters from stream into buffer
@@ -217,11 +344,17 @@ float Stream::parseFloat(char skipChar){
 size_t Stream::readBytes(char *buffer, size_t length)
 {
   size_t count = 0;
+  size_t n;
   while (count < length) {
+    // copy what is buffered, wait only once it runs dry
+    n = readAvailable((uint8_t *)buffer + count, length - count);
+    if (n) {
+      count += n;
+      continue;
+    }
     int c = timedRead();
     if (c < 0) break;
-    *buffer++ = (char)c;
-    count++;
+    buffer[count++] = (char)c;
   }
   return count;
 }
@@ -235,11 +368,27 @@ size_t Stream::readBytesUntil(char terminator, char *buffer, size_t length)
 {
   if (length < 1) return 0;
   size_t index = 0;
+  const uint8_t *data, *end;
+  size_t n;
+  int got;
   while (index < length) {
+    // look for the terminator in the buffered bytes and copy up to it
+    n = peekBuffer(&data);
+    if (n) {
+      if (n > length - index) n = length - index;
+      end = (const uint8_t *)memchr(data, terminator, n);
+      if (end) n = end - data;
+      got = n ? read((uint8_t *)buffer + index, n) : 0;
+      if (got > 0) index += got;
+      if (end && (size_t)got == n) {
+        read();  // consume the terminator
+        break;
+      }
+      if (got > 0) continue;
+    }
     int c = timedRead();
     if (c < 0 || c == terminator) break;
-    *buffer++ = (char)c;
-    index++;
+    buffer[index++] = (char)c;
   }
   return index; // return number of characters, not including null terminator
 }
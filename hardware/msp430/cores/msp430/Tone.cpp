@@ -1,7 +1,10 @@
 /* Tone.cpp
 
   A Tone Generator Library - Modified for Energia
-  Implements up to 3 (software) PWM outputs using TIMERA0 compare registers and IRQ. 
+  Implements up to 3 (software) PWM outputs on the Timer_A compare channels shared through
+  timerCompareAttach(), so tones can play while Servo and OneMsTaskTimer use the timer too.
+  While a tone plays, analogWrite() has no PWM on the pins of that timer: Timer0_A, or
+  Timer1_A once OneMsTaskTimer has started.
   Can use any digital output pin for pulse generation
  
   (c) 2012 - Peter Brier.
@@ -42,12 +45,12 @@ Version Modified By Date     Comments
 #include "Energia.h"
 
 // local funcions
-static void initTimers();
 static void setTimer(uint8_t n, unsigned int frequency, unsigned long duration);
 static void stopTimer(uint8_t n);
+static uint16_t toneHandler(uint8_t channel);
 
 // timer clock frequency set to clock/8, at F_CPU = 1MHZ this gives an output freq range of ~[1Hz ..65Khz] and at 16Mhz this is ~[16Hz .. 1MHz]
-#define F_TIMER (F_CPU/8L)
+#define F_TIMER TIMER_COMPARE_FREQ
 
 #ifdef __MSP430_HAS_TA3__
 #define AVAILABLE_TONE_PINS 3
@@ -63,10 +66,10 @@ static void stopTimer(uint8_t n);
 //  = 0 - stopped
 //  < 0 - infinitely (until stop() method called, or new play() called)
 
-static uint8_t tone_state = 0; // 0==not initialized, 1==timer running
 static uint8_t tone_pins[AVAILABLE_TONE_PINS] = { SETARRAY(255) };
 static uint8_t tone_bit[AVAILABLE_TONE_PINS] = { SETARRAY(255)  };
 volatile static uint8_t *tone_out[AVAILABLE_TONE_PINS] = { SETARRAY(0) };
+volatile static uint8_t tone_channel[AVAILABLE_TONE_PINS] = { SETARRAY(TIMER_CHANNEL_NONE) }; // compare channel while the tone plays
 static uint16_t tone_interval[AVAILABLE_TONE_PINS] = { SETARRAY(-1)  };
 static int16_t tone_periods[AVAILABLE_TONE_PINS] = { SETARRAY(0)  };
 
@@ -92,16 +95,14 @@ void tone(uint8_t _pin, unsigned int frequency, unsigned long duration)
     }
   }
 
-  // new tone pin, find empty timer and set it
+  // new tone pin, find a slot that is not playing and set it
   for (int i = 0; i < AVAILABLE_TONE_PINS; i++)
   {
-    if (tone_pins[i] == 255)      
+    if (tone_channel[i] == TIMER_CHANNEL_NONE)
     {
       tone_pins[i] = _pin;
       tone_bit[i] = digitalPinToBitMask(_pin);
       tone_out[i] = portOutputRegister(port); 
-      if ( tone_state == 0 ) 
-        initTimers();
       pinMode(_pin, OUTPUT);
       setTimer(i, frequency, duration);
       return; // we are done, timer set
@@ -128,29 +129,14 @@ void noTone(uint8_t _pin)
 }
 
 
-// Initialize the timers - Set mode and Enable IRQ
-static void inline initTimers()
-{
-  // disable IRQs
-  TA0CCTL0 = 0;
-  TA0CCTL1 = 0;
-#ifdef __MSP430_HAS_TA3__
-  TA0CCTL2 = 0;
-#endif
-  TA0CTL = TACLR + TASSEL_2 +  ID_3 + MC_2;       // clear counter, source=SMCLK/8, mode=continous count up
-  tone_state = 1;  // init is done
-}
-
-
 // Set the timer interval and duration
 // frequency in [Hz] and duration in [msec]
-// we initialize the timer match value only if the tone was not running already, to prevent glitches when re-programming a running tone
+// a compare channel is only attached if the tone was not running already, to prevent glitches when re-programming a running tone
 static void setTimer(uint8_t n, unsigned int frequency, unsigned long duration)
 {
   if ( frequency <= 0 ) 
   {
-    tone_interval[n] = 0;
-    tone_periods[n] = 0;
+    stopTimer(n);
     return;
   }
   tone_interval[n] = F_TIMER / (2L*frequency);
@@ -158,66 +144,43 @@ static void setTimer(uint8_t n, unsigned int frequency, unsigned long duration)
     tone_periods[n] = (duration * (F_TIMER/2)) / (1000L * tone_interval[n]);
   else
     tone_periods[n] = -1;
-  switch( n ) // enable IRQ and set next match time in various timer compare registers (if we where not enabled already)
-  {
-    case 0:
-      if ( ! (TA0CCTL0 & CCIE) ) TA0CCR0 = TA0R + tone_interval[0];  
-      TA0CCTL0 = CCIE;       
-      break;
-    case 1:
-      if ( !(TA0CCTL1 & CCIE) ) TA0CCR1 = TA0R + tone_interval[1]; 
-      TA0CCTL1 = CCIE; 
-      break;
-#ifdef __MSP430_HAS_TA3__
-    case 2:
-      if ( !(TA0CCTL2 & CCIE) ) TA0CCR2 = TA0R + tone_interval[2];  
-      TA0CCTL2 = CCIE;
-      break;
-#endif
-    }
+  if ( tone_channel[n] == TIMER_CHANNEL_NONE ) // no channel free: the tone is not played
+    tone_channel[n] = timerCompareAttach(toneHandler, tone_interval[n], TIMER_OWNER_TONE);
 } 
 
-/* stopTimer() - Disable timer IRQ */
-static void inline stopTimer(uint8_t n)
+/* stopTimer() - Give the compare channel back */
+static void stopTimer(uint8_t n)
 {
-  switch( n )
+  uint16_t globalInterruptState = __read_status_register() & GIE;
+  __disable_interrupt();
+  if ( tone_channel[n] != TIMER_CHANNEL_NONE )
   {
-    case 0: TA0CCTL0 = 0; break;
-    case 1: TA0CCTL1 = 0; break;
-#ifdef __MSP430_HAS_TA3__
-    case 2: TA0CCTL2 = 0; break;
-#endif
-  }  
-  *tone_out[n] &= ~tone_bit[n];
+    timerCompareDetach(tone_channel[n]);
+    tone_channel[n] = TIMER_CHANNEL_NONE;
+  }
+  if ( tone_out[n] )
+    *tone_out[n] &= ~tone_bit[n];
+  __bis_SR_register(globalInterruptState);
 }
 
 
 // Peform the isr magic, toggle output, decrease duation if > 0, and stop if duration == 0, continous if duration < 0
-// set new interval - defined as macro to limit ISR overhead (at the expense of some code size)
-#define isrTimer(n,ccr) do { \
-  *tone_out[n] ^= tone_bit[n]; \
-  if ( tone_periods[n] == 0 ) stopTimer(n);\
-  else if ( tone_periods[n] > 0) tone_periods[n]--; \
-  ccr += tone_interval[n]; \
-} while(0)
-
-
-// TIMERA vector (CCR0)
-__attribute__((interrupt(TIMER0_A0_VECTOR)))
-void TIMER0_A0_ISR(void)
+// returns the next interval, 0 gives the channel back
+static uint16_t toneHandler(uint8_t channel)
 {
-  isrTimer(0, TA0CCR0);
-}
+  uint8_t n;
 
-// TAIV vector (CCR1/CCR2)
-__attribute__((interrupt(TIMER0_A1_VECTOR)))
-void TIMER0_A1_ISR(void)
-{
-  switch ( TA0IV ) 
-  { 
-    case 0x2: isrTimer(1, TA0CCR1); break; // CCR1
-#ifdef __MSP430_HAS_TA3__
-    case 0x4: isrTimer(2, TA0CCR2); break; // CCR2
-#endif
-  }  
+  for (n = 0; n < AVAILABLE_TONE_PINS; n++)
+    if ( tone_channel[n] == channel ) break;
+  if ( n == AVAILABLE_TONE_PINS ) return 0;
+
+  *tone_out[n] ^= tone_bit[n];
+  if ( tone_periods[n] == 0 )
+  {
+    *tone_out[n] &= ~tone_bit[n];
+    tone_channel[n] = TIMER_CHANNEL_NONE;
+    return 0;
+  }
+  if ( tone_periods[n] > 0 ) tone_periods[n]--;
+  return tone_interval[n];
 }
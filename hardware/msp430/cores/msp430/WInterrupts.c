@@ -67,6 +67,30 @@ static volatile voidFuncPtr intFuncP4[NUM_INTS_PER_PORT];
 static volatile uint8_t intChangeVectP4 = 0x00;
 #endif
 
+#if defined(P1IV_) || defined(P1IV)
+/*
+ * Parts with PxIV dispatch one pending pin per read of the vector
+ * register, highest priority (lowest bit) first, and the read clears the
+ * pin's flag. The extra state for debounce and the latency hook is only
+ * kept on these parts.
+ */
+#define PORT_IV_DISPATCH
+#if defined(PORT4_VECTOR)
+#define NUM_INT_PORTS 4
+#elif defined(PORT3_VECTOR)
+#define NUM_INT_PORTS 3
+#elif defined(PORT2_VECTOR)
+#define NUM_INT_PORTS 2
+#else
+#define NUM_INT_PORTS 1
+#endif
+static uint8_t intPin[NUM_INT_PORTS][NUM_INTS_PER_PORT];
+static volatile uint8_t intDebounceVect[NUM_INT_PORTS];
+static uint16_t intDebounceTime[NUM_INT_PORTS][NUM_INTS_PER_PORT];
+static unsigned long intLastEdge[NUM_INT_PORTS][NUM_INTS_PER_PORT];
+static void (* volatile intLatencyHook)(uint8_t, unsigned int);
+#endif
+
 void attachInterrupt(uint8_t interruptNum, void (*userFunc)(void), int mode) {
 	uint8_t bit = digitalPinToBitMask(interruptNum);
 	uint8_t port = digitalPinToPort(interruptNum);
@@ -130,6 +154,10 @@ case P4:
 		break;
 	}
 
+#ifdef PORT_IV_DISPATCH
+	if (port <= NUM_INT_PORTS)
+		intPin[port - 1][bit_pos(bit)] = interruptNum;
+#endif
 	__eint();
 }
 
@@ -169,13 +197,88 @@ void detachInterrupt(uint8_t interruptNum) {
 	default:
 		break;
 	}
+
+#ifdef PORT_IV_DISPATCH
+	if (port <= NUM_INT_PORTS)
+		intDebounceVect[port - 1] &= ~bit;
+#endif
+}
+
+#ifdef PORT_IV_DISPATCH
+void interruptDebounce(uint8_t interruptNum, unsigned int microseconds)
+{
+	uint8_t bit = digitalPinToBitMask(interruptNum);
+	uint8_t port = digitalPinToPort(interruptNum);
+	unsigned long now = micros();
+
+	if ((port == NOT_A_PIN) || (port > NUM_INT_PORTS)) return;
+
+	uint16_t globalInterruptState = __read_status_register() & GIE;
+	__disable_interrupt();
+	intDebounceTime[port - 1][bit_pos(bit)] = microseconds;
+	// the next edge is accepted whenever it comes
+	intLastEdge[port - 1][bit_pos(bit)] = now - microseconds;
+	if (microseconds)
+		intDebounceVect[port - 1] |= bit;
+	else
+		intDebounceVect[port - 1] &= ~bit;
+	__bis_SR_register(globalInterruptState);
 }
 
+void attachInterruptLatencyHook(void (*hook)(uint8_t pin, unsigned int latency))
+{
+	intLatencyHook = hook;
+}
+
+static inline __attribute__((always_inline))
+void port_iv_dispatch(uint8_t p, volatile uint16_t *iv, volatile uint8_t *in,
+	volatile uint8_t *ies, volatile uint8_t *ifg,
+	volatile voidFuncPtr *func, volatile uint8_t *change)
+{
+	void (*hook)(uint8_t, unsigned int) = intLatencyHook;
+	unsigned long entry = 0;
+	uint16_t vector;
+	uint8_t i, bit;
+
+	// only pay for micros() when something uses the timestamp
+	if (intDebounceVect[p] || hook)
+		entry = micros();
+
+	while ((vector = *iv) != 0) {
+		i = (vector >> 1) - 1;
+		bit = BV(i);
+		// Follow the pin before running the callback, so an edge
+		// during the callback is latched. If the pin moved again
+		// before IES was flipped, set the flag to catch that edge.
+		if (*change & bit) {
+			*ies ^= bit;
+			if ((*in & bit) == (*ies & bit))
+				*ifg &= ~bit;
+			else
+				*ifg |= bit;
+		}
+		if (intDebounceVect[p] & bit) {
+			if (entry - intLastEdge[p][i] < intDebounceTime[p][i])
+				continue;
+			intLastEdge[p][i] = entry;
+		}
+		if (!func[i])
+			continue;
+		if (hook)
+			hook(intPin[p][i], micros() - entry);
+		func[i]();
+	}
+}
+#endif
+
 __attribute__((interrupt(PORT1_VECTOR)))
 void Port_1(void)
 {
-	uint8_t i;
 	boolean still_sleeping = stay_asleep;
+#if defined(P1IV_) || defined(P1IV)
+	port_iv_dispatch(0, &P1IV, &P1IN, &P1IES, &P1IFG, intFuncP1, &intChangeVectP1);
+#else
+	uint8_t i;
 
 	for(i = 0; i < 8; i++) {
 		if((P1IFG & BV(i)) && intFuncP1[i]) {
@@ -189,6 +292,7 @@ void Port_1(void)
 			}
 		}
 	}
+#endif
 
 	if (stay_asleep != still_sleeping) {
 		__bic_SR_register_on_exit(LPM4_bits);
@@ -199,8 +303,11 @@ void Port_1(void)
 __attribute__((interrupt(PORT2_VECTOR)))
 void Port_2(void)
 {
-	uint8_t i;
 	boolean still_sleeping = stay_asleep;
+#if defined(P2IV_) || defined(P2IV)
+	port_iv_dispatch(1, &P2IV, &P2IN, &P2IES, &P2IFG, intFuncP2, &intChangeVectP2);
+#else
+	uint8_t i;
 
 	for(i = 0; i < 8; i++) {
 		if((P2IFG & BV(i)) && intFuncP2[i]) {
@@ -214,6 +321,7 @@ void Port_2(void)
 			}
 		}
 	}
+#endif
 	if (stay_asleep != still_sleeping) {
 		__bic_SR_register_on_exit(LPM4_bits);
 	}
@@ -224,8 +332,11 @@ void Port_2(void)
 __attribute__((interrupt(PORT3_VECTOR)))
 void Port_3(void)
 {
-	uint8_t i;
 	boolean still_sleeping = stay_asleep;
+#if defined(P3IV_) || defined(P3IV)
+	port_iv_dispatch(2, &P3IV, &P3IN, &P3IES, &P3IFG, intFuncP3, &intChangeVectP3);
+#else
+	uint8_t i;
 
 	for(i = 0; i < 8; i++) {
 		if((P3IFG & BV(i)) && intFuncP3[i]) {
@@ -239,6 +350,7 @@ void Port_3(void)
 			}
 		}
 	}
+#endif
 	if (stay_asleep != still_sleeping) {
 		__bic_SR_register_on_exit(LPM4_bits);
 	}
@@ -249,8 +361,11 @@ void Port_3(void)
 __attribute__((interrupt(PORT4_VECTOR)))
 void Port_4(void)
 {
-	uint8_t i;
 	boolean still_sleeping = stay_asleep;
+#if defined(P4IV_) || defined(P4IV)
+	port_iv_dispatch(3, &P4IV, &P4IN, &P4IES, &P4IFG, intFuncP4, &intChangeVectP4);
+#else
+	uint8_t i;
 
 	for(i = 0; i < 8; i++) {
 		if((P4IFG & BV(i)) && intFuncP4[i]) {
@@ -264,6 +379,7 @@ void Port_4(void)
 			}
 		}
 	}
+#endif
 	if (stay_asleep != still_sleeping) {
 		__bic_SR_register_on_exit(LPM4_bits);
 	}
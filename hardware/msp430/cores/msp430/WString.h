@@ -37,6 +37,19 @@
 class __FlashStringHelper;
 #define F(string_literal) (reinterpret_cast<const __FlashStringHelper *>(PSTR(string_literal)))
 
+// Strings shorter than STRING_SSO_SIZE are stored inside the String
+// object and do not allocate any heap memory. The size is part of the
+// String layout, so a #define in a sketch can not change it; build
+// everything with -DWSTRING_SSO_SIZE=<n> instead.
+#if defined(WSTRING_SSO_SIZE)
+#define STRING_SSO_SIZE WSTRING_SSO_SIZE
+#else
+#define STRING_SSO_SIZE 8
+#endif
+#if STRING_SSO_SIZE < 1
+#error "WSTRING_SSO_SIZE must be at least 1"
+#endif
+
 // An inherited class for holding the result of a concatenation.  These
 // result objects are assumed to be writable by subsequent concatenations.
 class StringSumHelper;
@@ -187,10 +200,15 @@ public:
 	long toInt(void) const;
 	float toFloat(void) const;
 
+	// heap allocations made by all Strings so far
+	static unsigned long allocations(void) {return allocCount;}
+
 protected:
 	char *buffer;	        // the actual char array
 	unsigned int capacity;  // the array length minus one (for the '\0')
 	unsigned int len;       // the String length (not counting the '\0')
+	char sso[STRING_SSO_SIZE];  // buffer points here while the string is short
+	static unsigned long allocCount;
 protected:
 	void init(void);
 	void invalidate(void);
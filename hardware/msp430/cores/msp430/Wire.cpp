@@ -47,6 +47,8 @@ uint8_t TwoWire::txAddress = 0;
 uint8_t TwoWire::txBuffer[BUFFER_LENGTH];
 uint8_t TwoWire::txBufferIndex = 0;
 uint8_t TwoWire::txBufferLength = 0;
+const uint8_t *TwoWire::txTail = 0;
+size_t TwoWire::txTailLength = 0;
 
 uint8_t TwoWire::transmitting = 0;
 void (*TwoWire::user_onRequest)(void);
@@ -109,6 +111,13 @@ uint8_t TwoWire::requestFrom(uint8_t address, uint8_t quantity)
   return requestFrom((uint8_t)address, (uint8_t)quantity, (uint8_t)true);
 }
 
+// reads quantity bytes straight into buffer, bypassing rxBuffer
+// and its length limit. Returns the number of bytes read.
+size_t TwoWire::requestFrom(uint8_t address, uint8_t *buffer, size_t quantity, uint8_t sendStop)
+{
+  return twi_readFrom(address, buffer, quantity, sendStop);
+}
+
 uint8_t TwoWire::requestFrom(int address, int quantity)
 {
   return requestFrom((uint8_t)address, (uint8_t)quantity, (uint8_t)true);
@@ -128,6 +137,7 @@ void TwoWire::beginTransmission(uint8_t address)
   // reset tx buffer iterator vars
   txBufferIndex = 0;
   txBufferLength = 0;
+  txTailLength = 0;
 }
 
 void TwoWire::beginTransmission(int address)
@@ -150,11 +160,13 @@ void TwoWire::beginTransmission(int address)
 //
 uint8_t TwoWire::endTransmission(uint8_t sendStop)
 {
-  // transmit buffer (blocking)
-  int8_t ret = twi_writeTo(txAddress, txBuffer, txBufferLength, 1, sendStop);
+  // transmit buffer, followed by the bytes written in place (blocking)
+  int8_t ret = twi_writeTo2(txAddress, txBuffer, txBufferLength,
+                            (uint8_t *)txTail, txTailLength, sendStop);
   // reset tx buffer iterator vars
   txBufferIndex = 0;
   txBufferLength = 0;
+  txTailLength = 0;
   // indicate that we are done transmitting
   transmitting = 0;
   return ret;
@@ -175,8 +187,8 @@ size_t TwoWire::write(uint8_t data)
 {
   if(transmitting){
   // in master transmitter mode
-    // don't bother if buffer is full
-    if(txBufferLength >= BUFFER_LENGTH){
+    // don't bother if buffer is full, or would be sent out of order
+    if(txBufferLength >= BUFFER_LENGTH || txTailLength){
       setWriteError();
       return 0;
     }
@@ -200,8 +212,19 @@ size_t TwoWire::write(const uint8_t *data, size_t quantity)
 {
   if(transmitting){
   // in master transmitter mode
-    for(size_t i = 0; i < quantity; ++i){
-      write(data[i]);
+    if(txBufferLength + quantity > BUFFER_LENGTH){
+      // too long for the buffer: sent in place by endTransmission(),
+      // so data must not change until then
+      if(txTailLength){
+        setWriteError();
+        return 0;
+      }
+      txTail = data;
+      txTailLength = quantity;
+    }else{
+      for(size_t i = 0; i < quantity; ++i){
+        write(data[i]);
+      }
     }
   }else{
   // in slave send mode
@@ -306,6 +329,18 @@ void TwoWire::onRequest( void (*function)(void) )
   user_onRequest = function;
 }
 
+// queues a master transfer and returns at once, see twi_request in twi.h
+// for the fields. Completion is signalled by done or the callback.
+void TwoWire::queue(WireTransaction *transaction)
+{
+  twi_queue(transaction);
+}
+
+// true while queued transfers are pending
+uint8_t TwoWire::queueBusy(void)
+{
+  return twi_queueBusy();
+}
 
 void TwoWire::setModule(uint8_t i2cModule)
 {
@@ -33,8 +33,27 @@
 #include <inttypes.h>
 #include "Stream.h"
 #include <msp430.h>
+extern "C" {
+  #include "twi.h"
+}
 
+// Size of the rx and tx buffers, at most 255. Longer transfers can
+// use write(buffer, length) and requestFrom(address, buffer, length),
+// which do not go through these buffers.
+// The buffers live in Wire.cpp, so a #define in a sketch can not resize
+// them; build everything with -DWIRE_BUFFER_LENGTH=<n> instead (with the
+// makefile build: EXTRA_CFLAGS=-DWIRE_BUFFER_LENGTH=<n>).
+#if defined(WIRE_BUFFER_LENGTH)
+#define BUFFER_LENGTH WIRE_BUFFER_LENGTH
+#else
 #define BUFFER_LENGTH 16
+#endif
+#if BUFFER_LENGTH > 255
+#error "WIRE_BUFFER_LENGTH must be 255 or less"
+#endif
+
+// A transfer for Wire.queue(): write then read in one bus tenure
+typedef struct twi_request WireTransaction;
 
 class TwoWire : public Stream
 {
@@ -47,6 +66,8 @@ class TwoWire : public Stream
     static uint8_t txBuffer[];
     static uint8_t txBufferIndex;
     static uint8_t txBufferLength;
+    static const uint8_t *txTail;
+    static size_t txTailLength;
 
     static uint8_t transmitting;
     static void (*user_onRequest)(void);
@@ -67,6 +88,7 @@ class TwoWire : public Stream
     uint8_t requestFrom(uint8_t, uint8_t, uint8_t);
     uint8_t requestFrom(int, int);
     uint8_t requestFrom(int, int, int);
+    size_t requestFrom(uint8_t, uint8_t *, size_t, uint8_t sendStop = true);
     virtual size_t write(uint8_t);
     virtual size_t write(const uint8_t *, size_t);
     virtual int available(void);
@@ -87,6 +109,8 @@ class TwoWire : public Stream
     inline size_t write(unsigned int n) { return write((uint8_t)n); }
     inline size_t write(int n) { return write((uint8_t)n); }
     using Print::write;
+    void queue(WireTransaction *);
+    uint8_t queueBusy(void);
     void setModule(uint8_t i2cModule);
 };
 
@@ -1,10 +1,66 @@
+#include <float.h>
+#include "atof.h"
+
 #define white_space(c) ((c) == ' ' || (c) == '\t')
 #define valid_digit(c) ((c) >= '0' && (c) <= '9')
 
-double atof (const char *p)
+// significant digits kept in the 64-bit mantissa, later ones only scale
+#define ATOF_MAX_DIGITS 19
+// beyond the double range in either direction
+#define ATOF_MAX_EXP 511
+
+// mantissa * 10 as shifts, avoiding a 64-bit multiply on 16-bit parts
+#define mul10(m) (((m) << 3) + ((m) << 1))
+
+// 10^(2^i) as far as double reaches: up to 10^256, or 10^32 where double
+// is 32 bits as with mspgcc. With a 53-bit double the first five are exact,
+// so every power up to 10^22 is.
+#if DBL_MAX_10_EXP >= 256
+#define ATOF_POW10_TOP 8
+#else
+#define ATOF_POW10_TOP 5
+#endif
+
+static const double atof_pow10[ATOF_POW10_TOP + 1] = {
+    1e1, 1e2, 1e4, 1e8, 1e16, 1e32,
+#if ATOF_POW10_TOP == 8
+    1e64, 1e128, 1e256
+#endif
+};
+
+double atof_scale(double mantissa, int exp10)
+{
+    double scale = 1.0;
+    unsigned int expon = exp10 < 0 ? -exp10 : exp10;
+    const double *pow10 = atof_pow10;
+
+    if (expon > ATOF_MAX_EXP) expon = ATOF_MAX_EXP;
+
+    // Near the ends of the range 10^expon itself would overflow while the
+    // result does not, so take the largest table power out first.
+
+    while (expon > DBL_MAX_10_EXP) {
+        mantissa = exp10 < 0 ? mantissa / atof_pow10[ATOF_POW10_TOP]
+                             : mantissa * atof_pow10[ATOF_POW10_TOP];
+        expon -= 1U << ATOF_POW10_TOP;
+    }
+
+    // Build 10^expon from the table, then apply it in one step.
+
+    for (; expon; expon >>= 1, pow10++) {
+        if (expon & 1) scale *= *pow10;
+    }
+
+    return exp10 < 0 ? mantissa / scale : mantissa * scale;
+}
+
+double atof_parse(const char *s, const char **end)
 {
-    int frac;
-    double sign, value, scale;
+    const char *p = s;
+    unsigned long long mantissa = 0;
+    int digits = 0, exp10 = 0;
+    int negative = 0, found = 0;
+    double value;
 
     // Skip leading white space, if any.
 
@@ -14,66 +70,82 @@ double atof (const char *p)
 
     // Get sign, if any.
 
-    sign = 1.0;
     if (*p == '-') {
-        sign = -1.0;
+        negative = 1;
         p += 1;
 
     } else if (*p == '+') {
         p += 1;
     }
 
-    // Get digits before decimal point or exponent, if any.
+    // Get digits before decimal point, if any.
 
-    for (value = 0.0; valid_digit(*p); p += 1) {
-        value = value * 10.0 + (*p - '0');
+    for (; valid_digit(*p); p += 1) {
+        found = 1;
+        if (digits < ATOF_MAX_DIGITS) {
+            mantissa = mul10(mantissa) + (*p - '0');
+            if (mantissa) digits += 1;
+        } else {
+            exp10 += 1;
+        }
     }
 
-    // Get digits after decimal point, if any.
+    // Get digits after decimal point, if any, into the same mantissa.
 
     if (*p == '.') {
-        double pow10 = 10.0;
         p += 1;
-        while (valid_digit(*p)) {
-            value += (*p - '0') / pow10;
-            pow10 *= 10.0;
-            p += 1;
+        for (; valid_digit(*p); p += 1) {
+            found = 1;
+            if (digits < ATOF_MAX_DIGITS) {
+                mantissa = mul10(mantissa) + (*p - '0');
+                if (mantissa) digits += 1;
+                exp10 -= 1;
+            }
         }
     }
 
+    if (!found) {
+        if (end) *end = s;
+        return 0.0;
+    }
+
     // Handle exponent, if any.
 
-    frac = 0;
-    scale = 1.0;
     if ((*p == 'e') || (*p == 'E')) {
-        unsigned int expon;
+        const char *q = p + 1;
+        unsigned int expon = 0;
+        int expNegative = 0;
 
         // Get sign of exponent, if any.
 
-        p += 1;
-        if (*p == '-') {
-            frac = 1;
-            p += 1;
+        if (*q == '-') {
+            expNegative = 1;
+            q += 1;
 
-        } else if (*p == '+') {
-            p += 1;
+        } else if (*q == '+') {
+            q += 1;
         }
 
         // Get digits of exponent, if any.
 
-        for (expon = 0; valid_digit(*p); p += 1) {
-            expon = expon * 10 + (*p - '0');
+        if (valid_digit(*q)) {
+            for (; valid_digit(*q); q += 1) {
+                if (expon < ATOF_MAX_EXP) expon = expon * 10 + (*q - '0');
+            }
+            exp10 += expNegative ? -(int)expon : (int)expon;
+            p = q;
         }
-        if (expon > 308) expon = 308;
-
-        // Calculate scaling factor.
-
-        while (expon >= 50) { scale *= 1E50; expon -= 50; }
-        while (expon >=  8) { scale *= 1E8;  expon -=  8; }
-        while (expon >   0) { scale *= 10.0; expon -=  1; }
     }
 
+    if (end) *end = p;
+
     // Return signed and scaled floating point result.
 
-    return sign * (frac ? (value / scale) : (value * scale));
+    value = mantissa ? atof_scale((double)mantissa, exp10) : 0.0;
+    return negative ? -value : value;
+}
+
+double atof (const char *p)
+{
+    return atof_parse(p, 0);
 }
@@ -25,8 +25,19 @@ extern "C"{
 
 extern double atof (const char *p);
 
+/* As atof(), and if end is not NULL sets it to the first character after
+ * the number, or to s if there was none. Up to 19 significant digits are
+ * gathered as an integer and scaled once by a power of ten. */
+extern double atof_parse (const char *s, const char **end);
+
+/* mantissa * 10^exp10 with a single multiply or divide; with a 64-bit
+ * double, exact for integer mantissas below 2^53 and |exp10| <= 22. Lets
+ * parsers that read character by character share the scaling step with
+ * atof(). */
+extern double atof_scale (double mantissa, int exp10);
+
 #ifdef __cplusplus
 } // extern "C"
 #endif // __cplusplus
 
-#endif // _ITOA_
+#endif // _ATOF_
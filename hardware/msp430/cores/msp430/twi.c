@@ -53,9 +53,11 @@ static volatile uint8_t twi_inRepStart;         // in the middle of a repeated s
 static void (*twi_onSlaveTransmit)(void);
 static void (*twi_onSlaveReceive)(uint8_t*, int);
 
-static uint8_t twi_masterBuffer[TWI_BUFFER_LENGTH];
-static volatile uint8_t twi_masterBufferIndex;
-static uint8_t twi_masterBufferLength;
+static uint8_t *twi_masterBuffer;               // caller's buffer, used in place
+static volatile uint16_t twi_masterBufferIndex;
+static uint16_t twi_masterBufferLength;
+static uint8_t *twi_masterTail;                 // second buffer of twi_writeTo2()
+static uint16_t twi_masterTailLength;
 
 static uint8_t twi_txBuffer[TWI_BUFFER_LENGTH];
 static volatile uint8_t twi_txBufferIndex;
@@ -68,6 +70,27 @@ static volatile uint8_t twi_rxBufferIndex;
 
 static volatile uint8_t twi_error;
 
+static struct twi_request * volatile twi_queueHead;  // request on the bus
+static struct twi_request *twi_queueTail;
+static volatile uint8_t twi_readAfterWrite;     // queued request still has to read
+static volatile uint8_t twi_queueStarted;       // the head request is on the bus
+static volatile uint8_t twi_blocking;           // a blocking transfer owns the bus
+static uint16_t twi_queueService(void);
+static void twi_queueStart(struct twi_request *);
+
+#if defined(__MSP430_HAS_EUSCI_B0__) || defined(__MSP430_HAS_EUSCI_B1__)
+static uint8_t twi_autoStop;                    // byte counter generates the stop
+#endif
+#if defined(TWI_DMA_AVAILABLE)
+#ifndef TWI_DMA_RX_TRIGGER
+#define TWI_DMA_RX_TRIGGER 18                   // UCB0RXIFG0
+#endif
+#ifndef TWI_DMA_TX_TRIGGER
+#define TWI_DMA_TX_TRIGGER 19                   // UCB0TXIFG0
+#endif
+static uint16_t twi_dmaLength;                  // bytes given to DMA channel 0, 0 if idle
+#endif
+
 #if defined(__MSP430_HAS_USI__)
 static uint8_t twi_slarw;
 static uint8_t twi_my_addr;
@@ -400,25 +423,85 @@ void twi_setAddress(uint8_t address)
 }
 
 /*
- * Function twi_readFrom
- * Desc     attempts to become twi bus master and read a
- *          series of bytes from a device on the bus
+ * Function twi_masterNextSegment
+ * Desc     moves a master write on to the second array of twi_writeTo2()
+ *          once the first one is sent
+ * Input    none
+ * Output   none
+ */
+static inline void twi_masterNextSegment(void)
+{
+	if (twi_masterBufferIndex == twi_masterBufferLength && twi_masterTailLength) {
+		twi_masterBuffer = twi_masterTail;
+		twi_masterBufferIndex = 0;
+		twi_masterBufferLength = twi_masterTailLength;
+		twi_masterTailLength = 0;
+	}
+}
+
+#if defined(TWI_DMA_AVAILABLE)
+/*
+ * Function twi_dmaStart
+ * Desc     lets DMA channel 0 move the data bytes of a master transfer
+ *          instead of the isr. Only used with the automatic stop, so the
+ *          transfer still ends with the stop interrupt.
+ * Input    data: pointer to byte array
+ *          length: number of bytes
+ *          transmit: true for a write, false for a read
+ * Output   0 if channel 0 is taken and the isr has to move the bytes
+ */
+static uint8_t twi_dmaStart(uint8_t* data, uint16_t length, uint8_t transmit)
+{
+	if (!dmaClaim(0, transmit ? TWI_DMA_TX_TRIGGER : TWI_DMA_RX_TRIGGER, 0))
+		return 0;
+	twi_dmaLength = length;
+	DMA0SZ = length;
+	if (transmit) {
+		__data16_write_addr((unsigned short) &DMA0SA, (unsigned long) data);
+		__data16_write_addr((unsigned short) &DMA0DA, (unsigned long) &UCB0TXBUF);
+		DMA0CTL = DMADT_0 + DMASRCINCR_3 + DMADSTINCR_0 + DMASBDB + DMAEN;
+		UCBxIE &= ~UCTXIE0;
+	} else {
+		__data16_write_addr((unsigned short) &DMA0SA, (unsigned long) &UCB0RXBUF);
+		__data16_write_addr((unsigned short) &DMA0DA, (unsigned long) data);
+		DMA0CTL = DMADT_0 + DMASRCINCR_0 + DMADSTINCR_3 + DMASBDB + DMAEN;
+		UCBxIE &= ~UCRXIE0;
+	}
+	return 1;
+}
+
+/*
+ * Function twi_dmaStop
+ * Desc     called from the isr when a DMA transfer ends, by stop or NACK.
+ *          Brings the buffer index up to date and hands the data bytes
+ *          back to the isr.
+ * Input    none
+ * Output   none
+ */
+static void twi_dmaStop(void)
+{
+	uint16_t left = (DMA0CTL & DMAEN) ? DMA0SZ : 0;
+
+	dmaRelease(0);
+	twi_masterBufferIndex = twi_dmaLength - left;
+	twi_dmaLength = 0;
+	UCBxIE |= (UCRXIE0|UCTXIE0);
+}
+#endif
+
+/*
+ * Function twi_masterStartRead
+ * Desc     sets up the module as master receiver and sends the start
+ *          condition, the isr reads the bytes straight into data
  * Input    address: 7bit i2c device address
  *          data: pointer to byte array
  *          length: number of bytes to read into array
- * Output   number of bytes read
+ * Output   none
  */
-uint8_t twi_readFrom(uint8_t address, uint8_t* data, uint8_t length, uint8_t sendStop)
+static void twi_masterStartRead(uint8_t address, uint8_t* data, uint16_t length)
 {
-	uint8_t i;
+	twi_error = TWI_ERRROR_NO_ERROR;
 
-#if (DEFAULT_I2C == -1)
-	if (I2C_baseAddress == -1)
-	{
-		i2c_sw_read(address, length, data, sendStop);
-		return length;
-	}
-#endif
 #if defined(__MSP430_HAS_USI__)
 	/* Disable START condition interrupt */
 	USICTL1 &= ~USISTTIE;
@@ -444,18 +527,23 @@ uint8_t twi_readFrom(uint8_t address, uint8_t* data, uint8_t length, uint8_t sen
     UCBxCTLW0 |= (UCMST);                     // I2C Master, synchronous mode
     UCBxCTLW0 &= ~(UCTR);                     // Configure in receive mode
     UCBxI2CSA = address;                      // Set Slave Address
-    UCBxTBCNT = length;                       // set number of bytes to transmit
+    twi_autoStop = (length > 0) && (length <= 255);
+    if (twi_autoStop) {
+        UCBxTBCNT = length;                   // set number of bytes to receive
+        UCBxCTLW1 |= UCASTP_2;                // do generate Stop after last Byte
+    } else {
+        UCBxTBCNT = 0;
+        UCBxCTLW1 &= ~UCASTP_2;               // Stop is generated in the isr
+    }
     UCBxCTLW0 &= ~UCSWRST;                    // Clear SW reset, resume operation
     UCBxIE |= (UCRXIE0|UCALIE|UCNACKIE|UCSTTIE|UCSTPIE); // Enable I2C interrupts
 #endif
-	// ensure data will fit into buffer
-	if(TWI_BUFFER_LENGTH < length){
-		return 0;
-	}
 
 	// initialize buffer iteration vars
+	twi_masterBuffer = data;
 	twi_masterBufferIndex = 0;
 	twi_masterBufferLength = length-1;  // This is not intuitive, read on...
+	twi_masterTailLength = 0;
 	// On receive, the previously configured ACK/NACK setting is transmitted in
 	// response to the received byte before the interrupt is signalled.
 	// Therefor we must actually set NACK when the _next_ to last byte is
@@ -483,55 +571,33 @@ uint8_t twi_readFrom(uint8_t address, uint8_t* data, uint8_t length, uint8_t sen
 #endif
 #if defined(__MSP430_HAS_EUSCI_B0__) || defined(__MSP430_HAS_EUSCI_B1__)
     twi_state =  TWI_MRX;                     // Master receive mode
+#if defined(TWI_DMA_AVAILABLE)
+    if (twi_autoStop && length >= TWI_DMA_MIN_SIZE && I2C_baseAddress == UCB0_BASE)
+        twi_dmaStart(data, length, false);
+#endif
     //while (UCBxCTLW0 & UCTXSTP);              // Ensure stop condition got sent
     UCBxCTLW0 |= UCTXSTT;                     // I2C start condition
 #endif
-
-	/* Wait in low power mode for read operation to complete */
-	while(twi_state != TWI_IDLE){
-		__bis_SR_register(LPM0_bits);
-	}
-
-	if (twi_masterBufferIndex < length)
-		length = twi_masterBufferIndex;
-
-	for(i = 0; i < length; ++i){
-		data[i] = twi_masterBuffer[i];
-	}
-
-#if defined(__MSP430_HAS_USCI__) || defined(__MSP430_HAS_USCI_B0__) || defined(__MSP430_HAS_USCI_B1__)
-	/* Ensure stop condition got sent before we exit. */
-	while (UCBxCTL1 & UCTXSTP);
-#endif
-	return length;
 }
 
 /*
- * Function twi_writeTo
- * Desc     attempts to become twi bus master and write a
- *          series of bytes to a device on the bus
+ * Function twi_masterStartWrite
+ * Desc     sets up the module as master transmitter and sends the start
+ *          condition, the isr sends the bytes straight from data
  * Input    address: 7bit i2c device address
  *          data: pointer to byte array
  *          length: number of bytes in array
- *          wait: boolean indicating to wait for write or not
- * Output   0 .. success
- *          1 .. length to long for buffer
- *          2 .. address send, NACK received
- *          3 .. data send, NACK received
- *          4 .. other twi error (lost bus arbitration, bus error, ..)
+ *          tail: pointer to byte array sent after data, or NULL
+ *          tailLength: number of bytes in tail
+ *          sendStop: end with a stop, otherwise with a repeated start
+ * Output   none
  */
-uint8_t twi_writeTo(uint8_t address, uint8_t* data, uint8_t length, uint8_t wait, uint8_t sendStop)
+static void twi_masterStartWrite(uint8_t address, uint8_t* data, uint16_t length,
+	uint8_t* tail, uint16_t tailLength, uint8_t sendStop)
 {
-	uint8_t i;
 	twi_error = TWI_ERRROR_NO_ERROR;
 	twi_sendStop = sendStop;
 
-#if (DEFAULT_I2C == -1)	
-	if (I2C_baseAddress == -1)
-	{
-		return (i2c_sw_write(address, length, data, sendStop));
-	}
-#endif
 #if defined(__MSP430_HAS_USI__)
 	/* Disable START condition interrupt */
 	USICTL1 &= ~USISTTIE;
@@ -556,29 +622,24 @@ uint8_t twi_writeTo(uint8_t address, uint8_t* data, uint8_t length, uint8_t wait
     UCBxCTLW0 |= UCSWRST;                     // Enable SW reset
     UCBxCTLW0 |= (UCMST | UCTR);              //  I2C Master, transmit mode
     UCBxI2CSA = address;                      // Set Slave Address
-    UCBxTBCNT = length;                       // set number of bytes to transmit
-	if((sendStop) && (length > 0)) {
+    twi_autoStop = (sendStop) && (length + tailLength > 0) && (length + tailLength <= 255);
+	if(twi_autoStop) {
+		UCBxTBCNT = length + tailLength;      // set number of bytes to transmit
 		UCBxCTLW1 |= UCASTP_2;                // do generate Stop after last Byte to send
 	} else {
+		UCBxTBCNT = 0;
 		UCBxCTLW1 &= ~UCASTP_2;               // do not generate Stop
 	}
     UCBxCTLW0 &= ~UCSWRST;                    // Clear SW reset, resume operation
     UCBxIE |= (UCRXIE|UCTXIE0|UCALIE|UCNACKIE|UCSTPIE); // Enable I2C interrupts
 #endif
 
-	/* Ensure data will fit into buffer */
-	if(length > TWI_BUFFER_LENGTH){
-		return TWI_ERROR_BUF_TO_LONG;
-	}
-
-
 	/* initialize buffer iteration vars */
+	twi_masterBuffer = data;
 	twi_masterBufferIndex = 0;
 	twi_masterBufferLength = length;
-
-	for(i = 0; i < length; ++i){
-		twi_masterBuffer[i] = data[i];
-	}
+	twi_masterTail = tail;
+	twi_masterTailLength = tailLength;
 
 #if defined(__MSP430_HAS_USI__)
 	/* build sla+w, slave device address + w bit */
@@ -595,9 +656,146 @@ uint8_t twi_writeTo(uint8_t address, uint8_t* data, uint8_t length, uint8_t wait
 #endif
 #if defined(__MSP430_HAS_EUSCI_B0__) || defined(__MSP430_HAS_EUSCI_B1__)
     twi_state =  TWI_MTX;                     // Master Transmit mode
+#if defined(TWI_DMA_AVAILABLE)
+    if (twi_autoStop && tailLength == 0 && length >= TWI_DMA_MIN_SIZE && I2C_baseAddress == UCB0_BASE)
+        twi_dmaStart(data, length, true);
+#endif
     //while (UCBxCTLW0 & UCTXSTP);           // Ensure stop condition got sent
     UCBxCTLW0 |= UCTXSTT;                  // I2C start condition
 #endif
+}
+
+/*
+ * Function twi_waitQueue
+ * Desc     waits until all queued requests are done, so that a blocking
+ *          transfer does not cut into them, and takes the bus for it.
+ *          Returns with interrupts disabled, so that a request queued
+ *          from an interrupt can not start before the blocking transfer.
+ * Input    none
+ * Output   the interrupt state to hand to twi_releaseQueue
+ */
+static uint16_t twi_waitQueue(void)
+{
+	uint16_t globalInterruptState = __read_status_register() & GIE;
+
+	__disable_interrupt();
+	while(twi_queueHead != NULL){
+		__bis_SR_register(LPM0_bits + GIE);   // sleep and enable at once
+		__disable_interrupt();
+	}
+	twi_blocking = true;
+	return(globalInterruptState);
+}
+
+/*
+ * Function twi_releaseQueue
+ * Desc     ends a blocking transfer once its result has been read and
+ *          starts a request that was queued while it ran
+ * Input    globalInterruptState: as returned by twi_waitQueue
+ * Output   none
+ */
+static void twi_releaseQueue(uint16_t globalInterruptState)
+{
+	__disable_interrupt();
+	twi_blocking = false;
+	if (twi_queueHead != NULL && !twi_queueStarted && twi_state == TWI_IDLE)
+		twi_queueStart(twi_queueHead);
+	__bis_SR_register(globalInterruptState);
+}
+
+/*
+ * Function twi_readFrom
+ * Desc     attempts to become twi bus master and read a
+ *          series of bytes from a device on the bus
+ * Input    address: 7bit i2c device address
+ *          data: pointer to byte array
+ *          length: number of bytes to read into array
+ * Output   number of bytes read
+ */
+uint16_t twi_readFrom(uint8_t address, uint8_t* data, uint16_t length, uint8_t sendStop)
+{
+	uint16_t globalInterruptState;
+
+#if (DEFAULT_I2C == -1)
+	if (I2C_baseAddress == -1)
+	{
+		i2c_sw_read(address, length, data, sendStop);
+		return length;
+	}
+#endif
+	globalInterruptState = twi_waitQueue();
+	twi_masterStartRead(address, data, length);
+	__bis_SR_register(globalInterruptState);
+
+	/* Wait in low power mode for read operation to complete */
+	while(twi_state != TWI_IDLE){
+		__bis_SR_register(LPM0_bits);
+	}
+
+	if (twi_masterBufferIndex < length)
+		length = twi_masterBufferIndex;
+
+#if defined(__MSP430_HAS_USCI__) || defined(__MSP430_HAS_USCI_B0__) || defined(__MSP430_HAS_USCI_B1__)
+	/* Ensure stop condition got sent before we exit. */
+	while (UCBxCTL1 & UCTXSTP);
+#endif
+	twi_releaseQueue(globalInterruptState);
+	return length;
+}
+
+/*
+ * Function twi_writeTo
+ * Desc     attempts to become twi bus master and write a
+ *          series of bytes to a device on the bus
+ * Input    address: 7bit i2c device address
+ *          data: pointer to byte array
+ *          length: number of bytes in array
+ *          wait: boolean indicating to wait for write or not
+ * Output   0 .. success
+ *          1 .. length to long for buffer
+ *          2 .. address send, NACK received
+ *          3 .. data send, NACK received
+ *          4 .. other twi error (lost bus arbitration, bus error, ..)
+ */
+uint8_t twi_writeTo(uint8_t address, uint8_t* data, uint16_t length, uint8_t wait, uint8_t sendStop)
+{
+	return twi_writeTo2(address, data, length, NULL, 0, sendStop);
+}
+
+/*
+ * Function twi_writeTo2
+ * Desc     as twi_writeTo, but sends the bytes of two arrays one after
+ *          the other in the same transfer, without copying them
+ * Input    address: 7bit i2c device address
+ *          data: pointer to first byte array
+ *          length: number of bytes in first array
+ *          tail: pointer to second byte array
+ *          tailLength: number of bytes in second array
+ *          sendStop: end with a stop, otherwise with a repeated start
+ * Output   as twi_writeTo
+ */
+uint8_t twi_writeTo2(uint8_t address, uint8_t* data, uint16_t length,
+	uint8_t* tail, uint16_t tailLength, uint8_t sendStop)
+{
+	uint16_t globalInterruptState;
+	uint8_t status;
+
+#if (DEFAULT_I2C == -1)	
+	if (I2C_baseAddress == -1)
+	{
+		if (tailLength == 0)
+			return (i2c_sw_write(address, length, data, sendStop));
+		status = i2c_sw_write(address, length, data, false);
+		if (status == TWI_ERROR_ADDR_NACK)
+			return status;
+		if (i2c_sw_writeMore(tailLength, tail, sendStop))
+			status = TWI_ERROR_DATA_NACK;
+		return status;
+	}
+#endif
+	globalInterruptState = twi_waitQueue();
+	twi_masterStartWrite(address, data, length, tail, tailLength, sendStop);
+	__bis_SR_register(globalInterruptState);
 
 	/* Wait for the transaction to complete */
 	while(twi_state != TWI_IDLE) {
@@ -614,7 +812,183 @@ uint8_t twi_writeTo(uint8_t address, uint8_t* data, uint8_t length, uint8_t wait
 	}
 #endif
 
-	return twi_error;
+	status = twi_error;
+	twi_releaseQueue(globalInterruptState);
+	return status;
+}
+
+/*
+ * Function twi_queueStart
+ * Desc     starts the first phase of a queued request
+ * Input    request: request at the head of the queue
+ * Output   none
+ */
+static void twi_queueStart(struct twi_request *request)
+{
+	twi_queueStarted = true;
+	if (request->txLength || !request->rxLength) {
+		twi_readAfterWrite = (request->rxLength != 0);
+		twi_masterStartWrite(request->address, request->txBuffer, request->txLength, NULL, 0, !twi_readAfterWrite);
+	} else {
+		twi_readAfterWrite = false;
+		twi_masterStartRead(request->address, request->rxBuffer, request->rxLength);
+	}
+}
+
+#if defined(__MSP430_HAS_USCI__) || defined(__MSP430_HAS_USCI_B0__) || defined(__MSP430_HAS_USCI_B1__) \
+ || defined(__MSP430_HAS_EUSCI_B0__) || defined(__MSP430_HAS_EUSCI_B1__)
+/*
+ * Function twi_masterRepeatedStart
+ * Desc     called from the isr once the write phase of a queued request
+ *          is sent, turns the bus around for the read phase without
+ *          releasing it
+ * Input    none
+ * Output   none
+ */
+static void twi_masterRepeatedStart(void)
+{
+	struct twi_request *request = twi_queueHead;
+
+	twi_readAfterWrite = false;
+	twi_masterBuffer = request->rxBuffer;
+	twi_masterBufferIndex = 0;
+	twi_masterBufferLength = request->rxLength - 1;
+	twi_state = TWI_MRX;
+
+#if defined(__MSP430_HAS_USCI__)
+	UCxIFG &= ~UCBxTXIFG;                     // Nothing more to send
+	UCxIE |= UCBxRXIE;
+#elif defined(__MSP430_HAS_USCI_B0__) || defined(__MSP430_HAS_USCI_B1__)
+	UCBxIFG &= ~UCTXIFG;                      // Nothing more to send
+	UCBxIE |= UCRXIE;
+#endif
+#if defined(__MSP430_HAS_EUSCI_B0__) || defined(__MSP430_HAS_EUSCI_B1__)
+	UCBxCTLW0 &= ~UCTR;                       // Configure in receive mode
+	UCBxCTLW0 |= UCTXSTT;                     // I2C repeated start condition
+	if (request->rxLength == 1) {
+		while (UCBxCTLW0 & UCTXSTT);          // Wait for the address to be sent
+		UCBxCTLW0 |= UCTXSTP;                 // Stop after the only byte
+	}
+#else
+	UCBxCTL1 &= ~UCTR;                        // Configure in receive mode
+	UCBxCTL1 |= UCTXSTT;                      // I2C repeated start condition
+	if (request->rxLength == 1) {
+		while (UCBxCTL1 & UCTXSTT);           // Wait for the address to be sent
+		UCBxCTL1 |= UCTXSTP;                  // Stop after the only byte
+	}
+#endif
+}
+#endif
+
+/*
+ * Function twi_queueService
+ * Desc     called at the end of every I2C interrupt. When the request at
+ *          the head of the queue is done it is completed and the next
+ *          one is started.
+ * Input    none
+ * Output   true if a request was completed, to leave low power mode
+ */
+static uint16_t twi_queueService(void)
+{
+	struct twi_request *request = twi_queueHead;
+
+	if (request == NULL || twi_state != TWI_IDLE)
+		return(false);
+
+	if (!twi_queueStarted) {
+		/* Queued while the bus was busy. After a slave transfer start it
+		 * now; a blocking transfer starts it once it has its result. */
+		if (!twi_blocking)
+			twi_queueStart(request);
+		return(false);
+	}
+
+	if (twi_readAfterWrite && twi_error == TWI_ERRROR_NO_ERROR) {
+		/* The USI write phase ends with a stop; read in a new transfer */
+		twi_readAfterWrite = false;
+		twi_masterStartRead(request->address, request->rxBuffer, request->rxLength);
+		return(false);
+	}
+	twi_readAfterWrite = false;
+
+#if defined(__MSP430_HAS_USCI__) || defined(__MSP430_HAS_USCI_B0__) || defined(__MSP430_HAS_USCI_B1__)
+	/* A stop still in progress would be cut off by the next start */
+	while (UCBxCTL1 & UCTXSTP);
+#endif
+#if defined(__MSP430_HAS_EUSCI_B0__) || defined(__MSP430_HAS_EUSCI_B1__)
+	while (UCBxCTLW0 & UCTXSTP);
+	UCBxIFG &= ~UCSTPIFG;                     // Already accounted for
+#endif
+
+	twi_queueHead = request->next;
+	twi_queueStarted = false;
+	request->status = twi_error;
+	request->done = true;
+	if (request->callback)
+		request->callback(request);
+
+	/* The callback may have queued, and so started, a request itself */
+	if (twi_queueHead != NULL && twi_state == TWI_IDLE)
+		twi_queueStart(twi_queueHead);
+	return(true);
+}
+
+/*
+ * Function twi_queue
+ * Desc     adds a master transfer to the queue and returns at once. The
+ *          transfer runs from the I2C interrupt after the ones ahead of it.
+ *          With the software I2C the transfer is done before returning.
+ * Input    request: transfer to run, see twi.h
+ * Output   none
+ */
+void twi_queue(struct twi_request *request)
+{
+	uint16_t globalInterruptState;
+
+	request->status = TWI_ERRROR_NO_ERROR;
+	request->done = false;
+	request->next = NULL;
+
+#if (DEFAULT_I2C == -1)
+	if (I2C_baseAddress == -1)
+	{
+		if (request->txLength || !request->rxLength)
+			request->status = i2c_sw_write(request->address, request->txLength, request->txBuffer, !request->rxLength);
+		if (request->rxLength && request->status == TWI_ERRROR_NO_ERROR)
+			i2c_sw_read(request->address, request->rxLength, request->rxBuffer, true);
+		request->done = true;
+		if (request->callback)
+			request->callback(request);
+		return;
+	}
+#endif
+
+	globalInterruptState = __read_status_register() & GIE;
+	__disable_interrupt();
+
+	if (twi_queueHead == NULL) {
+		twi_queueHead = request;
+	} else {
+		twi_queueTail->next = request;
+	}
+	twi_queueTail = request;
+
+	/* Otherwise started when the transfer on the bus is done */
+	if (twi_queueHead == request && twi_state == TWI_IDLE && !twi_blocking)
+		twi_queueStart(request);
+
+	__bis_SR_register(globalInterruptState);
+}
+
+/*
+ * Function twi_queueBusy
+ * Desc     tells if queued requests are still pending
+ * Input    none
+ * Output   1 while the queue is not empty
+ */
+uint8_t twi_queueBusy(void)
+{
+	return (twi_queueHead != NULL);
 }
 
 /*
@@ -733,6 +1107,8 @@ mtpd:
 			break;
 		}
 
+		twi_masterNextSegment();
+
 		if(twi_masterBufferIndex == twi_masterBufferLength) {
 			USICTL0 |= USIOE;
 			USISRL = 0x00;
@@ -795,6 +1171,9 @@ mtre:
 	/* Clear counter interrupt */
 	USICTL1 &= ~USIIFG;
 
+	if (twi_queueService())
+		__bic_SR_register_on_exit(LPM4_bits);
+
 }
 #endif /* __MSP430_HAS_USI__ */
 
@@ -843,6 +1222,7 @@ uint16_t i2c_txrx_isr(void)  // RX/TX Service
 #endif
 		/* Master transmit mode */
 		if (twi_state == TWI_MTX) {
+			twi_masterNextSegment();
 			// if there is data to send, send it, otherwise stop 
 			if(twi_masterBufferIndex < twi_masterBufferLength){
 				// Copy data to output register and ack.
@@ -851,6 +1231,10 @@ uint16_t i2c_txrx_isr(void)  // RX/TX Service
 				if (twi_sendStop) {
 					/* All done. Generate STOP condition and IDLE */
 					UCBxCTL1 |= UCTXSTP;
+				} else if (twi_readAfterWrite) {
+					/* Queued write-then-read, go on reading */
+					twi_masterRepeatedStart();
+					return(false);
 				} else {
 					twi_inRepStart = true;  // we're gonna send the START
 					// don't enable the interrupt. We'll generate the start, but we 
@@ -872,6 +1256,8 @@ uint16_t i2c_txrx_isr(void)  // RX/TX Service
 			}
 		}
 	}
+	if (twi_queueService())
+		stay_active = true;
 	return(stay_active);
 }
 
@@ -905,8 +1291,17 @@ uint16_t i2c_state_isr(void)  // I2C Service
 			twi_error = TWI_ERROR_ADDR_NACK;
 		else
 			twi_error = TWI_ERROR_DATA_NACK;
-		//twi_state = TWI_IDLE;
-		//stay_active = true;
+		if (twi_state == TWI_MTX || twi_state == TWI_MRX) {
+			/* The master has to end the transfer itself */
+			UCBxCTL1 |= UCTXSTP;
+#if defined(__MSP430_HAS_USCI__)
+			UCxIFG &= ~UCBxTXIFG;
+#else
+			UCBxIFG &= ~UCTXIFG;
+#endif
+			twi_state = TWI_IDLE;
+			stay_active = true;
+		}
 	}
 	/* Start condition interrupt flag.
 	 * UCSTTIFG is automatically cleared if a STOP condition is received. */
@@ -957,6 +1352,8 @@ uint16_t i2c_state_isr(void)  // I2C Service
 		twi_state =  TWI_IDLE;
 		stay_active = true;
 	}
+	if (twi_queueService())
+		stay_active = true;
 	return(stay_active);
 }
 #endif
@@ -998,14 +1395,18 @@ uint16_t eusci_isr_handler(void)
 
       break;
     case USCI_I2C_UCNACKIFG:   // USCI I2C Mode: UCNACKIFG
+#if defined(TWI_DMA_AVAILABLE)
+		if (twi_dmaLength)
+			twi_dmaStop();
+#endif
 		if (twi_masterBufferIndex == 0) // when no data, we received the address
 			twi_error = TWI_ERROR_ADDR_NACK;
 	    else
 			twi_error = TWI_ERROR_DATA_NACK;
         // leave slave receiver state
         twi_state = TWI_IDLE;
-		if (UCBxTBCNT == 0) 
-			UCBxCTLW0 |= UCTXSTP;                // Generate I2C stop condition manually
+		// the automatic stop only follows the last byte, not a NACK
+		UCBxCTLW0 |= UCTXSTP;                    // Generate I2C stop condition manually
 		exit_lpm = 1; //__bic_SR_register_on_exit(LPM4_bits); // Exit LPM
       break;
     case USCI_I2C_UCSTTIFG:    // USCI I2C Mode: UCSTTIFG
@@ -1034,6 +1435,10 @@ uint16_t eusci_isr_handler(void)
       break;
     case USCI_I2C_UCSTPIFG:    // USCI I2C Mode: UCSTPIFG
         //UCBxIFG &= ~UCSTPIFG;
+#if defined(TWI_DMA_AVAILABLE)
+		if (twi_dmaLength)
+			twi_dmaStop();
+#endif
 		if (twi_state ==  TWI_SRX){
 			// callback to user defined callback
 			twi_onSlaveReceive(twi_rxBuffer, twi_rxBufferIndex);
@@ -1064,7 +1469,7 @@ uint16_t eusci_isr_handler(void)
 		//UCBxIFG &= ~UCRXIFG;                  // Clear USCI_B0 TX int flag
 		if (twi_state ==  TWI_MRX) {      // Master receive mode
 			twi_masterBuffer[twi_masterBufferIndex++] = UCBxRXBUF; // Get RX data
-			if(twi_masterBufferIndex == twi_masterBufferLength )
+			if(twi_masterBufferIndex == twi_masterBufferLength && !twi_autoStop)
 				UCBxCTLW0 |= UCTXSTP;  // Generate I2C stop condition
 			if(twi_masterBufferIndex > twi_masterBufferLength ) {
 				twi_state = TWI_IDLE; //Idle
@@ -1084,6 +1489,7 @@ uint16_t eusci_isr_handler(void)
     case USCI_I2C_UCTXIFG0:    // USCI I2C Mode: UCTXIFG0
 		//UCBxIFG &= ~UCTXIFG;                  // Clear USCI_B0 TX int flag
 		if (twi_state == TWI_MTX) {      // Master transmit mode
+			twi_masterNextSegment();
 			// if there is data to send, send it, otherwise stop
 			if(twi_masterBufferIndex < twi_masterBufferLength){
 				// copy data to output register and ack
@@ -1092,6 +1498,8 @@ uint16_t eusci_isr_handler(void)
 			   if (twi_sendStop) {
 				 if (UCBxTBCNT == 0) 
 					 UCBxCTLW0 |= UCTXSTP;                // Generate I2C stop condition manually
+			   } else if (twi_readAfterWrite) {
+				 twi_masterRepeatedStart();  // queued write-then-read, go on reading
 			   } else {
 				 twi_inRepStart = true;   // we're gonna send the START
 				 // don't enable the interrupt. We'll generate the start, but we
@@ -1119,6 +1527,8 @@ uint16_t eusci_isr_handler(void)
     case USCI_I2C_UCBIT9IFG:   // USCI I2C Mode: UCBIT9IFG
       break;
 	}
+	if (twi_queueService())
+		exit_lpm = 1;
 	return (exit_lpm);
 }
 
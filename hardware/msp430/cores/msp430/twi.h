@@ -48,10 +48,20 @@
 #define TWI_FREQ 100000L
 #endif
 
+/* size of the slave buffers; master transfers use the caller's buffer */
 #ifndef TWI_BUFFER_LENGTH
 #define TWI_BUFFER_LENGTH 16
 #endif
 
+/* eUSCI_B0 master transfers of this many bytes or more, up to 255 and
+ * ending with a stop, are moved by DMA channel 0 when it can be claimed */
+#if (defined(__MSP430_HAS_DMAX_3__) || defined(__MSP430_HAS_DMAX_6__)) && defined(__MSP430_HAS_EUSCI_B0__)
+#define TWI_DMA_AVAILABLE
+#ifndef TWI_DMA_MIN_SIZE
+#define TWI_DMA_MIN_SIZE 16
+#endif
+#endif
+
 
 #define TWI_READY 0
 #define TWI_MRX   1
@@ -87,19 +97,41 @@
 #define TWI_ERROR_DATA_NACK 3
 #define TWI_ERROR_OTHER 4
 
+/*
+ * A master transfer for twi_queue(). The txLength bytes are written first
+ * and, when rxLength is not 0, rxLength bytes are then read behind a
+ * repeated start. Both buffers are used in place and must stay valid until
+ * done is set. status is one of the TWI_ERROR codes above. The callback,
+ * if any, runs in interrupt context and may queue further requests.
+ */
+#define TWI_QUEUE_AVAILABLE
+struct twi_request {
+	uint8_t address;
+	uint8_t *txBuffer;
+	uint16_t txLength;
+	uint8_t *rxBuffer;
+	uint16_t rxLength;
+	void (*callback)(struct twi_request *);
+	volatile uint8_t status;
+	volatile uint8_t done;
+	struct twi_request *next;
+};
 
 
 void twi_setModule(uint8_t _i2cModule);
 void twi_init(void);
 void twi_setAddress(uint8_t);
-uint8_t twi_readFrom(uint8_t, uint8_t*, uint8_t, uint8_t);
-uint8_t twi_writeTo(uint8_t, uint8_t*, uint8_t, uint8_t, uint8_t);
+uint16_t twi_readFrom(uint8_t, uint8_t*, uint16_t, uint8_t);
+uint8_t twi_writeTo(uint8_t, uint8_t*, uint16_t, uint8_t, uint8_t);
+uint8_t twi_writeTo2(uint8_t, uint8_t*, uint16_t, uint8_t*, uint16_t, uint8_t);
 uint8_t twi_transmit(const uint8_t*, uint8_t);
 void twi_attachSlaveRxEvent( void (*)(uint8_t*, int) );
 void twi_attachSlaveTxEvent( void (*)(void) );
 void twi_reply(uint8_t);
 void twi_stop(void);
 void twi_releaseBus(void);
+void twi_queue(struct twi_request *);
+uint8_t twi_queueBusy(void);
 
 #endif
 
@@ -89,6 +89,20 @@ uint8_t i2c_sw_write(uint8_t slaveAddress,
    return (status);
 }
 
+/* continues a write started with i2c_sw_write(..., sendStop = 0) */
+uint8_t i2c_sw_writeMore(uint16_t numBytes, uint8_t* data, uint8_t sendStop)
+{        
+   uint16_t i;
+   uint8_t status = 0;
+   
+   for (i = 0; i < numBytes; i++) {
+	   status |= i2c_sw_txByte(*data++);    // Send data and ack
+   }
+   if (sendStop) i2c_sw_stop();             // Send Stop condition
+   if (status) return (TWI_ERROR_DATA_NACK);
+   return (status);
+}
+
 uint8_t i2c_sw_start(uint8_t address, uint8_t rw)               // Set up start condition for I2C
 {
   pinMode(TWISDA, OUTPUT);
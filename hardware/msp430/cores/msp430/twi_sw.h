@@ -30,6 +30,7 @@
 void i2c_sw_init(void);
 uint8_t i2c_sw_read(uint8_t slaveAddress, uint16_t numBytes, uint8_t* data, uint8_t sendStop);
 uint8_t i2c_sw_write(uint8_t slaveAddress, uint16_t numBytes, uint8_t* data, uint8_t sendStop);
+uint8_t i2c_sw_writeMore(uint16_t numBytes, uint8_t* data, uint8_t sendStop);
 
 #endif //#ifndef I2C_SW_MASTER_H
 
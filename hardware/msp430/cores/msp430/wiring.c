@@ -30,18 +30,93 @@
 */
 #include "Energia.h"
 
+#if defined(TIMEBASE_TIMER)
+// A board may set TIMEBASE_TIMER in pins_energia.h to keep time with a free
+// Timer_A instead of the WDT: the timer counts SMCLK divided down to 1MHz in
+// continuous mode, so micros() reads the counter directly and the overflow
+// ISR only runs every 65536us.
+#if TIMEBASE_TIMER == 1
+#define TIMEBASE_CTL TA1CTL
+#define TIMEBASE_R TA1R
+#define TIMEBASE_EX0 TA1EX0
+#define TIMEBASE_IV TA1IV
+#define TIMEBASE_IV_TAIFG TA1IV_TAIFG
+#define TIMEBASE_CCTL0 TA1CCTL0
+#define TIMEBASE_CCR0 TA1CCR0
+#define TIMEBASE_A0_VECTOR TIMER1_A0_VECTOR
+#define TIMEBASE_A1_VECTOR TIMER1_A1_VECTOR
+#endif
+#if TIMEBASE_TIMER == 2
+#define TIMEBASE_CTL TA2CTL
+#define TIMEBASE_R TA2R
+#define TIMEBASE_EX0 TA2EX0
+#define TIMEBASE_IV TA2IV
+#define TIMEBASE_IV_TAIFG TA2IV_TAIFG
+#define TIMEBASE_CCTL0 TA2CCTL0
+#define TIMEBASE_CCR0 TA2CCR0
+#define TIMEBASE_A0_VECTOR TIMER2_A0_VECTOR
+#define TIMEBASE_A1_VECTOR TIMER2_A1_VECTOR
+#endif
+#ifndef TIMEBASE_CTL
+// wiring_timer.c reserves only Timer1_A or Timer2_A for the timebase
+#error "TIMEBASE_TIMER must select Timer1_A or Timer2_A"
+#endif
+
+// split F_CPU/1MHz over the input divider (ID) and the expansion divider (IDEX)
+#define TIMEBASE_DIV (F_CPU / 1000000L)
+#if (TIMEBASE_DIV % 8) == 0
+#define TIMEBASE_ID ID_3
+#define TIMEBASE_IDEX (TIMEBASE_DIV / 8 - 1)
+#elif (TIMEBASE_DIV % 4) == 0
+#define TIMEBASE_ID ID_2
+#define TIMEBASE_IDEX (TIMEBASE_DIV / 4 - 1)
+#elif (TIMEBASE_DIV % 2) == 0
+#define TIMEBASE_ID ID_1
+#define TIMEBASE_IDEX (TIMEBASE_DIV / 2 - 1)
+#else
+#define TIMEBASE_ID ID_0
+#define TIMEBASE_IDEX (TIMEBASE_DIV - 1)
+#endif
+#if TIMEBASE_IDEX > 7
+#error "F_CPU can not be divided down to 1MHz for the timer timebase"
+#endif
+
+// delay() busy waits instead of sleeping for less than this many us
+#define TIMEBASE_MIN_SLEEP 16
+
+#define MICROSECONDS_PER_WDT_OVERFLOW 65536L
+
+// time spent in sleep() while the timebase timer is halted
+volatile unsigned long timebase_sleep_us = 0;
+#else
 // the clock source is set so that watch dog timer (WDT) ticks every clock
 // cycle (F_CPU), and the watch dog timer ISR is called every 512 ticks
 // for F_CPU < 8MHz and every 8192 ticks for F_CPU > 8MHz.
 #if F_CPU < 8000000L
 #define TICKS_PER_WDT_OVERFLOW 512
+#define WDT_INTERVAL WDT_MDLY_0_5
 #else
 #define TICKS_PER_WDT_OVERFLOW 8192
+#define WDT_INTERVAL WDT_MDLY_8
 #endif
 
 // the whole number of microseconds per WDT overflow
 #define MICROSECONDS_PER_WDT_OVERFLOW (clockCyclesToMicroseconds(TICKS_PER_WDT_OVERFLOW))
 
+// delay() stretches the interval to SMCLK/32768 while enough of the delay
+// is left, so the CPU wakes WDT_LONG_RATIO times less often; each long
+// interval counts as that many overflows
+#define WDT_LONG_INTERVAL WDT_MDLY_32
+#define WDT_LONG_RATIO (32768 / TICKS_PER_WDT_OVERFLOW)
+#define LONG_MILLIS_INC (MICROSECONDS_PER_WDT_OVERFLOW * WDT_LONG_RATIO / 1000)
+#define LONG_FRACT_INC (MICROSECONDS_PER_WDT_OVERFLOW * WDT_LONG_RATIO % 1000)
+
+// overflows per WDT interrupt (1 or WDT_LONG_RATIO), and the long
+// intervals delay() still wants
+volatile uint8_t wdt_tick_len = 1;
+volatile unsigned int wdt_long_ticks = 0;
+#endif
+
 // the whole number of milliseconds per WDT overflow
 #define MILLIS_INC (MICROSECONDS_PER_WDT_OVERFLOW / 1000)
 
@@ -60,8 +135,16 @@ volatile uint8_t sleeping = false;
 volatile boolean stay_asleep = false;
 volatile uint16_t vlo_freq = 0;
 
+// Cumulative time spent in LPM0 by delay() and in LPM3 by sleep()
+#define LOW_POWER_SLOT_LPM0 0
+#define LOW_POWER_SLOT_LPM3 1
+static unsigned long lpm_millis[2];
+static unsigned int lpm_fract[2];
+
 void initClocks(void);
 void enableWatchDogIntervalMode(void);
+static void startTimebase(void);
+static void stopTimebase(void);
 
 void enableXtal()
 {
@@ -208,7 +291,7 @@ void init()
 {
         disableWatchDog();
 	initClocks();
-        enableWatchDogIntervalMode();
+        startTimebase();
 
 #ifdef __MSP430_HAS_USB__
 	/* Enable access to USB registers */
@@ -242,6 +325,10 @@ void enableWatchDogIntervalMode(void)
 #else
 	WDTCTL = WDTPW | WDTTMSEL | WDTCNTCL | WDT_MDLY_8;
 #endif
+#if !defined(TIMEBASE_TIMER)
+	wdt_tick_len = 1;
+	wdt_long_ticks = 0;
+#endif
 
 	/* WDT interrupt enable */
 #ifdef __MSP430_HAS_SFR__
@@ -251,6 +338,35 @@ void enableWatchDogIntervalMode(void)
 #endif	
 }
 
+/* Start (or resume) whatever drives millis() and micros() */
+static void startTimebase(void)
+{
+#if defined(TIMEBASE_TIMER)
+	/* The WDT is only used for timekeeping while in sleep() */
+	disableWatchDog();
+
+	if (!(TIMEBASE_CTL & MC_3)) {
+		if (!(TIMEBASE_CTL & TAIE)) {
+			/* First start: SMCLK / TIMEBASE_DIV = 1MHz, overflow interrupt on */
+			TIMEBASE_EX0 = TIMEBASE_IDEX;
+			TIMEBASE_CTL = TASSEL_2 | TIMEBASE_ID | TACLR | TAIE;
+		}
+		/* Continuous mode; TAR keeps its value across stopTimebase() */
+		TIMEBASE_CTL |= MC_2;
+	}
+#else
+	enableWatchDogIntervalMode();
+#endif
+}
+
+/* Halt the SMCLK timebase before sleep() takes over with the ACLK WDT */
+static void stopTimebase(void)
+{
+#if defined(TIMEBASE_TIMER)
+	TIMEBASE_CTL &= ~MC_3;
+#endif
+}
+
 void initClocks(void)
 {
 
@@ -455,6 +571,65 @@ void initClocks(void)
 	enableXtal();
 }
 
+#if defined(TIMEBASE_TIMER)
+unsigned long micros()
+{
+	unsigned long m;
+	unsigned long s;
+	uint16_t t;
+
+	// disable interrupts to ensure consistent readings
+	// safe SREG to avoid issues if interrupts were already disabled
+	uint16_t oldSREG = READ_SR;
+	__dint();
+
+	t = TIMEBASE_R;
+	m = wdt_overflow_count;
+	// an overflow that happened after interrupts were disabled
+	// has not been counted yet
+	if ((TIMEBASE_CTL & TAIFG) && t < 0x8000)
+		m++;
+	s = timebase_sleep_us;
+
+	WRITE_SR(oldSREG);	// safe to enable interrupts again
+
+	// The counter ticks every microsecond, so the overflow count
+	// supplies the upper 16 bits
+	return ((m << 16) | t) + s;
+}
+
+unsigned long millis()
+{
+	unsigned long m;
+	unsigned int f;
+	uint16_t t;
+
+	// disable interrupts to ensure consistent readings
+	// safe SREG to avoid issues if interrupts were already disabled
+	uint16_t oldSREG = READ_SR;
+	__dint();
+
+	t = TIMEBASE_R;
+	m = wdt_millis;
+	f = wdt_fract;
+	if ((TIMEBASE_CTL & TAIFG) && t < 0x8000) {
+		m += MILLIS_INC;
+		f += FRACT_INC;
+	}
+
+	WRITE_SR(oldSREG);	// safe to enable interrupts again
+
+	// add the part of the current overflow period elapsed so far
+	m += t / 1000;
+	f += t % 1000;
+	while (f >= FRACT_MAX) {
+		f -= FRACT_MAX;
+		m++;
+	}
+
+	return m;
+}
+#else
 unsigned long micros()
 {
 	unsigned long m;
@@ -472,7 +647,8 @@ unsigned long micros()
 	// have to approximate microseconds from overflows and
 	// fractional milliseconds.
 	// With an WDT interval of SMCLK/512, precision is +/- 256/SMCLK,
-	// for example +/-256us @1MHz and +/-16us @16MHz
+	// for example +/-256us @1MHz and +/-16us @16MHz. While delay()
+	// runs long intervals, an ISR sees it move in steps of SMCLK/32768.
 
 	return (m * MICROSECONDS_PER_WDT_OVERFLOW);
 }
@@ -493,6 +669,8 @@ unsigned long millis()
  	return m;
 }
 
+#endif
+
 /* Delay for the given number of microseconds.  Assumes a 1, 8 or 16 MHz clock. */
 void delayMicroseconds(unsigned int us)
 {
@@ -576,66 +754,81 @@ void delayMicroseconds(unsigned int us)
         );
 }
 
-void sleepSeconds(uint32_t seconds)
+static void lowPowerAccount(uint8_t slot, unsigned long ms, unsigned int us)
 {
-	uint32_t start = millis();
-	sleeping = true;
-	stay_asleep = true;
-
-	if(vlo_freq) {
-		SMILLIS_INC = 8192 / (vlo_freq/1000);
-		SFRACT_INC = 300;
-	} else {
-		SMILLIS_INC = 250;
-		SFRACT_INC = 0;
-	}
+	unsigned int f = lpm_fract[slot] + us;
 
-	// Activate WDT in ACLK Interval mode
-	WDTCTL = WDT_ADLY_250;
-
-	while(stay_asleep && (millis() - start <= seconds * 1000)) {
-		/* Wait for WDT interrupt in LPM3
-		 * A user's ISR may abort this sleep using wakeup().
-		 */
-		__bis_status_register(LPM3_bits+GIE);
+	while (f >= FRACT_MAX) {
+		f -= FRACT_MAX;
+		ms++;
 	}
-
-	sleeping = false;
-	stay_asleep = false;
-
-	// Re-activate WDT in SMCLK Interval mode
-	enableWatchDogIntervalMode();
+	lpm_fract[slot] = f;
+	lpm_millis[slot] += ms;
 }
 
-void sleep(uint32_t milliseconds)
+unsigned long lowPowerTime(uint8_t mode)
 {
-	if(milliseconds >= 1000) {
-		uint16_t seconds = milliseconds/1000;
-		sleepSeconds(seconds);
-		milliseconds = milliseconds - (seconds * 1000);
-	}
+	if (mode == LOW_POWER_SLEEP)
+		return lpm_millis[LOW_POWER_SLOT_LPM0];
+	if (mode == LOW_POWER_DEEPSLEEP)
+		return lpm_millis[LOW_POWER_SLOT_LPM3];
+	/* suspend() halts every clock, so time in LPM4 can not be measured */
+	return 0;
+}
 
-	if(milliseconds == 0)
-		return;
+void resetLowPowerTime(void)
+{
+	lpm_millis[LOW_POWER_SLOT_LPM0] = lpm_millis[LOW_POWER_SLOT_LPM3] = 0;
+	lpm_fract[LOW_POWER_SLOT_LPM0] = lpm_fract[LOW_POWER_SLOT_LPM3] = 0;
+}
 
-	if(vlo_freq) {
-		SMILLIS_INC = 64 / (vlo_freq/1000);
-		SFRACT_INC = 500;
-	} else {
-		SMILLIS_INC = 1;
-		SFRACT_INC = 950;
-	}
+/* WDT intervals in ACLK cycles, longest first. sleep() picks the longest
+ * one that does not overshoot the time left, so it wakes up as seldom as
+ * possible instead of on every 1.9ms tick. */
+static const struct {
+	uint16_t wdtctl;
+	uint16_t cycles;
+} sleep_intervals[] = {
+	{ WDT_ADLY_1000, 32768 },
+	{ WDT_ADLY_250, 8192 },
+	{ WDT_ADLY_16, 512 },
+	{ WDT_ADLY_1_9, 64 },
+};
+#define SLEEP_INTERVALS (sizeof(sleep_intervals) / sizeof(sleep_intervals[0]))
+
+static void sleepMillis(uint32_t milliseconds)
+{
+	uint16_t aclk = vlo_freq ? vlo_freq : 32768;
+	uint32_t start = millis();
+	uint32_t elapsed, left;
+	uint8_t i, current = SLEEP_INTERVALS;
 
-	// Activate WDT in ACLK Interval mode
-	WDTCTL = WDT_ADLY_1_9;
+	// Stop the timebase timer if any; the WDT in ACLK interval mode keeps time below
+	stopTimebase();
 
 	sleeping = true;
 	stay_asleep = true;
-	uint32_t start = millis();
 
-	while(stay_asleep && (millis() - start < milliseconds)) {
+	while(stay_asleep && ((elapsed = millis() - start) < milliseconds)) {
+		left = milliseconds - elapsed;
+		for (i = 0; i < SLEEP_INTERVALS - 1; i++) {
+			if ((uint32_t)sleep_intervals[i].cycles * 1000 / aclk <= left)
+				break;
+		}
+
+		/* Interrupts stay off from the interval switch until LPM3 is entered */
+		__dint();
+		if (i != current) {
+			uint32_t t = (uint32_t)sleep_intervals[i].cycles * 1000;
+			SMILLIS_INC = t / aclk;
+			SFRACT_INC = (t % aclk) * 1000 / aclk;
+			WDTCTL = sleep_intervals[i].wdtctl;
+			current = i;
+		}
+
 		/* Wait for WDT interrupt in LPM3.
-		 * A user's ISR may abort this sleep using wakeup().
+		 * A user's ISR may abort this sleep using wakeup(); the part of
+		 * the interval slept so far is then not added to millis().
 		 */
 		__bis_status_register(LPM3_bits+GIE);
 	}
@@ -643,14 +836,27 @@ void sleep(uint32_t milliseconds)
 	sleeping = false;
 	stay_asleep = false;
 
-	// Re-activate WDT in SMCLK Interval mode
-	enableWatchDogIntervalMode();
+	lowPowerAccount(LOW_POWER_SLOT_LPM3, millis() - start, 0);
+
+	// Re-activate WDT in SMCLK Interval mode (or the timebase timer)
+	startTimebase();
+}
+
+void sleepSeconds(uint32_t seconds)
+{
+	sleepMillis(seconds * 1000);
+}
+
+void sleep(uint32_t milliseconds)
+{
+	sleepMillis(milliseconds);
 }
 
 void suspend(void)
 {
 	// Stop WDT for now
 	WDTCTL = WDTPW | WDTHOLD;
+	stopTimebase();
 
 	sleeping = true;
 	stay_asleep = true;
@@ -664,33 +870,111 @@ void suspend(void)
 
 	sleeping = false;
 
-	// Re-activate WDT in SMCLK Interval mode
-	enableWatchDogIntervalMode();
+	// Re-activate WDT in SMCLK Interval mode (or the timebase timer)
+	startTimebase();
 }
 
+#if defined(TIMEBASE_TIMER)
+void delay(uint32_t milliseconds)
+{
+	uint32_t start = micros();
+	uint32_t now, elapsed, left;
+
+	while(milliseconds > 0) {
+		now = micros();
+		elapsed = now - start;
+		if (elapsed >= 1000) {
+			milliseconds--;
+			start += 1000;
+			continue;
+		}
+
+		/* Time left, capped to what fits a 16 bit compare */
+		left = (milliseconds < 65) ? milliseconds * 1000 - elapsed : 0xFFF0;
+		if (left < TIMEBASE_MIN_SLEEP)
+			continue;
+
+		/* Arm CCR0 once for the end of the delay (or of the compare range)
+		 * and sleep in LPM0 until then. GIE and LPM0 are set by the same
+		 * instruction, so an early compare can not slip in between. */
+		__dint();
+		TIMEBASE_CCR0 = TIMEBASE_R + (uint16_t)left;
+		TIMEBASE_CCTL0 = CCIE;
+		__bis_status_register(LPM0_bits+GIE);
+
+		elapsed = micros() - now;
+		lowPowerAccount(LOW_POWER_SLOT_LPM0, elapsed / 1000, elapsed % 1000);
+	}
+	TIMEBASE_CCTL0 = 0;
+}
+#else
 /* (ab)use the WDT */
 void delay(uint32_t milliseconds)
 {
 	uint32_t start = micros();
+	uint32_t now, elapsed, left, ticks;
+
 	while(milliseconds > 0) {
-		if ((micros() - start) >= 1000) {
+		/* Interrupts stay off from reading the time until LPM0 is
+		 * entered, so a tick can not slip in between and be slept over */
+		__dint();
+		now = micros();
+		elapsed = now - start;
+		if (elapsed >= 1000) {
+			__eint();
 			milliseconds--;
 			start += 1000;
+			continue;
 		}
+
+		/* Whole WDT intervals left after the current one. Ask the WDT
+		 * ISR for as many long intervals as fit; it switches at its next
+		 * tick, so no part of an interval is lost. The rest of the delay
+		 * runs on short intervals as before. */
+		left = (milliseconds < 60000) ? milliseconds * 1000 - elapsed : 60000000;
+		ticks = left / MICROSECONDS_PER_WDT_OVERFLOW;
+		if (ticks > WDT_LONG_RATIO && wdt_tick_len == 1 && !wdt_long_ticks)
+			wdt_long_ticks = (ticks - 1) / WDT_LONG_RATIO;
+
 		__bis_status_register(LPM0_bits+GIE);
+
+		elapsed = micros() - now;
+		lowPowerAccount(LOW_POWER_SLOT_LPM0, elapsed / 1000, elapsed % 1000);
 	}
+	wdt_long_ticks = 0;
 }
 
+#endif
+
 __attribute__((interrupt(WDT_VECTOR)))
 void watchdog_isr (void)
 {
+#if defined(TIMEBASE_TIMER)
+	/* Timekeeping is up to the timer outside of sleep() */
+	if (!sleeping)
+		return;
+#endif
+
 	// copy these to local variables so they can be stored in registers
 	// (volatile variables must be read from memory on every access)
 	unsigned long m = wdt_millis;
 	unsigned int f = wdt_fract;
 
-	m += sleeping ? SMILLIS_INC:MILLIS_INC;
-	f += sleeping ? SFRACT_INC:FRACT_INC;
+#if defined(TIMEBASE_TIMER)
+	m += SMILLIS_INC;
+	f += SFRACT_INC;
+#else
+	if (sleeping) {
+		m += SMILLIS_INC;
+		f += SFRACT_INC;
+	} else if (wdt_tick_len == 1) {
+		m += MILLIS_INC;
+		f += FRACT_INC;
+	} else {
+		m += LONG_MILLIS_INC;
+		f += LONG_FRACT_INC;
+	}
+#endif
 	if (f >= FRACT_MAX) {
 		f -= FRACT_MAX;
 		m += 1;
@@ -698,8 +982,62 @@ void watchdog_isr (void)
 
 	wdt_fract = f;
 	wdt_millis = m;
-	wdt_overflow_count++;
+#if defined(TIMEBASE_TIMER)
+	/* Only runs during sleep(): keep micros() moving while the timer is halted */
+	timebase_sleep_us += (unsigned long)SMILLIS_INC * 1000 + SFRACT_INC;
+#else
+	wdt_overflow_count += wdt_tick_len;
+
+	/* Switch between short and long intervals for delay() right at the
+	 * end of one, clearing the counter loses only the ISR latency */
+	if (!sleeping) {
+		if (wdt_long_ticks) {
+			wdt_long_ticks--;
+			if (wdt_tick_len == 1) {
+				WDTCTL = WDT_LONG_INTERVAL;
+				wdt_tick_len = WDT_LONG_RATIO;
+			}
+		} else if (wdt_tick_len != 1) {
+			WDTCTL = WDT_INTERVAL;
+			wdt_tick_len = 1;
+		}
+	}
+#endif
 
         /* Exit from LMP3 on reti (this includes LMP0) */
         __bic_status_register_on_exit(LPM3_bits);
 }
+
+#if defined(TIMEBASE_TIMER)
+__attribute__((interrupt(TIMEBASE_A1_VECTOR)))
+void timebase_isr (void)
+{
+	if (TIMEBASE_IV != TIMEBASE_IV_TAIFG)
+		return;
+
+	unsigned long m = wdt_millis;
+	unsigned int f = wdt_fract;
+
+	m += MILLIS_INC;
+	f += FRACT_INC;
+	if (f >= FRACT_MAX) {
+		f -= FRACT_MAX;
+		m += 1;
+	}
+
+	wdt_fract = f;
+	wdt_millis = m;
+	wdt_overflow_count++;
+
+	/* Let a delay() whose CCR0 compare was missed re-evaluate */
+	__bic_status_register_on_exit(LPM0_bits);
+}
+
+__attribute__((interrupt(TIMEBASE_A0_VECTOR)))
+void timebase_compare_isr (void)
+{
+	/* delay() wake up */
+	TIMEBASE_CCTL0 &= ~CCIE;
+	__bic_status_register_on_exit(LPM0_bits);
+}
+#endif
@@ -64,6 +64,12 @@
 #define ADCxMEM0 ADC12MEM0 
 #define DEFAULT_READ_RESOLUTION 12
 #endif
+#if defined(__MSP430_HAS_ADC12_PLUS__)
+#define ADC12IFG_CLEAR() (ADC12IFG = 0)
+#endif
+#if defined(__MSP430_HAS_ADC12_B__)
+#define ADC12IFG_CLEAR() (ADC12IFGR0 = 0)
+#endif
 #if defined(__MSP430_HAS_ADC__)
 #define REFV_MAP(x) ((x>>8) & 0x70)
 //#define REF_MAP(x)  (x & 0x31)
@@ -72,6 +78,18 @@
 
 static int _readResolution = DEFAULT_READ_RESOLUTION;
 
+/* What analogRead() left the ADC set up for when analogReadCache() is on */
+#define ADC_CHANNEL_NONE 0xFF                   // ADC off or used by something else
+static uint8_t adc_cache;
+#if defined(__MSP430_HAS_ADC10__) || defined(__MSP430_HAS_ADC10_B__) || defined(__MSP430_HAS_ADC12_PLUS__) || defined(__MSP430_HAS_ADC12_B__) || defined(__MSP430_HAS_ADC__)
+static uint8_t adc_channel = ADC_CHANNEL_NONE;
+static uint16_t adc_reference;
+#endif
+
+#define ADC_SETUP 0                             // set up ADC and reference from scratch
+#define ADC_MUX   1                             // only the channel changed
+#define ADC_READY 2                             // nothing changed
+
 #if defined(__MSP430_HAS_ADC10__) || defined(__MSP430_HAS_ADC10_B__) || defined(__MSP430_HAS_ADC__)
 uint16_t analog_reference = DEFAULT, analog_period = F_CPU/490, analog_div = ID_0, analog_res=0xFF; // devide clock with 0, 2, 4, 8
 #endif
@@ -129,17 +147,32 @@ void analogResolution(uint16_t res)
 //Arduino specifies ~490 Hz for analog out PWM so we follow suit.
 #define PWM_PERIOD analog_period // F_CPU/490
 #define PWM_DUTY(x) ( (unsigned long)x*PWM_PERIOD / (unsigned long)analog_res )
+
+// the timer channel of a pin, whichever PxSEL setting maps it
+static uint8_t pwmChannel(uint8_t pin)
+{
+	uint8_t channel = digitalPinToTimer(pin);
+
+	if (channel >= T0A0_SEL01)
+		channel -= (T0A0_SEL01 - T0A0);
+	else if (channel >= T0A0_SEL1)
+		channel -= (T0A0_SEL1 - T0A0);
+	return channel;
+}
+
 void analogWrite(uint8_t pin, int val)
 {
     pinMode(pin, OUTPUT); // pin as output
 
  	if (val == 0)
 	{
+		timerRelease(pwmChannel(pin), TIMER_OWNER_PWM);
 		digitalWrite(pin, LOW); // set pin to LOW when duty cycle is 0
                                         // digitalWrite will take care of invalid pins
 	}
 	else if (val == analog_res)
 	{
+		timerRelease(pwmChannel(pin), TIMER_OWNER_PWM);
 		digitalWrite(pin, HIGH); // set pin HIGH when duty cycle is 255
                                          // digitalWrite will take care of invalid pins
 	}
@@ -164,6 +197,10 @@ void analogWrite(uint8_t pin, int val)
 				pinMode_int(pin, OUTPUT | PORT_SELECTION0 | PORT_SELECTION1);
 				pin2timer -= (T0A0_SEL01 - T0A0);    // correct offset
 			}
+			// the timer runs in up mode with one period for all its PWM pins,
+			// so it can not also serve tone(), Servo or a running analogStream
+			if (!timerClaim(pin2timer, TIMER_MODE_UP, TIMER_OWNER_PWM))
+				pin2timer = NOT_ON_TIMER;
 			switch(pin2timer) {                     // which timer and CCR?
  			//case: T0A0                            // CCR0 used as period register
 			case T0A1:                              // TimerA0 / CCR1
@@ -320,10 +357,213 @@ static inline uint32_t mapResolution(uint32_t value, uint32_t from, uint32_t to)
 		return value << (to-from);
 }
 
+#if defined(ANALOG_STREAM_AVAILABLE)
+/*
+ * Streaming: the ADC12 runs a repeated sequence over its memory slots,
+ * each slot one conversion started by a rising edge of a timer output
+ * (ADC12SHS), so conversions are evenly spaced. The pin sequence is
+ * repeated across as many slots as fit and divide the block, and only
+ * the last slot interrupts, which copies all slots to the ring.
+ * F5529: TB0.1, FR5969/FR6989: TA1.1. The timer is claimed for the
+ * stream, so analogWrite() on its pins falls back to digital meanwhile.
+ */
+#define ANALOG_STREAM_SLOTS 16
+#define ANALOG_STREAM_MAX_CONVERSIONS 100000L  // per second, with 16 ADC12CLK sample time
+#if defined(__MSP430_HAS_ADC12_PLUS__)
+#ifndef ANALOG_STREAM_SHS
+#define ANALOG_STREAM_SHS   ADC12SHS_3          // TB0 CCR1 output
+#define ANALOG_STREAM_CHANNEL T0B0
+#define ANALOG_STREAM_CTL   TB0CTL
+#define ANALOG_STREAM_CCR0  TB0CCR0
+#define ANALOG_STREAM_CCTL1 TB0CCTL1
+#define ANALOG_STREAM_CCR1  TB0CCR1
+#define ANALOG_STREAM_START (TBSSEL_2 | MC_1 | TBCLR)
+#endif
+#define ANALOG_STREAM_IE    ADC12IE
+#endif
+#if defined(__MSP430_HAS_ADC12_B__)
+#ifndef ANALOG_STREAM_SHS
+#define ANALOG_STREAM_SHS   ADC12SHS_3          // TA1 CCR1 output
+#define ANALOG_STREAM_CHANNEL T1A0
+#define ANALOG_STREAM_CTL   TA1CTL
+#define ANALOG_STREAM_CCR0  TA1CCR0
+#define ANALOG_STREAM_CCTL1 TA1CCTL1
+#define ANALOG_STREAM_CCR1  TA1CCR1
+#define ANALOG_STREAM_START (TASSEL_2 | MC_1 | TACLR)
+#endif
+#define ANALOG_STREAM_IE    ADC12IER0
+#endif
+
+static uint16_t *stream_buffer;
+static uint16_t stream_block;
+static volatile uint16_t stream_index;
+static volatile uint8_t stream_slots;           // 0 while not streaming
+static void (*stream_callback)(uint16_t *block, uint16_t length);
+
+uint8_t analogStreamBegin(const uint8_t *pins, uint8_t count, uint32_t rate,
+	uint16_t *buffer, uint16_t blockLength, void (*callback)(uint16_t *block, uint16_t length))
+{
+	uint32_t period;
+	uint16_t divider = ID_0;
+	uint8_t repeat, slot, channel;
+
+	if (count == 0 || count > ANALOG_STREAM_SLOTS || blockLength == 0 || blockLength % count)
+		return 0;
+	if (rate == 0 || rate * count > ANALOG_STREAM_MAX_CONVERSIONS)
+		return 0;
+	period = F_CPU / (rate * count);
+	if (period > 0xFFFF) {
+		divider = ID_3;
+		period /= 8;
+		if (period > 0xFFFF)
+			return 0;
+	}
+
+	analogStreamEnd();
+	if (!timerClaim(ANALOG_STREAM_CHANNEL, TIMER_MODE_EXCLUSIVE, TIMER_OWNER_ADC))
+		return 0;                       // the trigger timer does PWM or is in use
+	adc_channel = ADC_CHANNEL_NONE;         // the stream sets up the ADC its own way
+
+	// as many copies of the sequence as fit in the slots and divide the block
+	for (repeat = ANALOG_STREAM_SLOTS / count; blockLength % (repeat * count); repeat--)
+		;
+
+	stream_buffer = buffer;
+	stream_block = blockLength;
+	stream_index = 0;
+	stream_callback = callback;
+
+	ADC12CTL0 &= ~ADC12ENC;                 // disable ADC
+	ADC12CTL0 = ADC12ON | ADC12SHT0_2 | ADC12SHT1_2; // turn ADC ON; sample + hold @ 16 x ADC12CLKs, one slot per trigger
+#if defined(__MSP430_HAS_ADC12_PLUS__)
+	ADC12CTL1 = ADC12CSTARTADD_0 | ANALOG_STREAM_SHS | ADC12SHP | ADC12SSEL_0 | ADC12CONSEQ_3; // repeated sequence, MODOSC
+	ADC12CTL2 |= ADC12RES1;                 // 12-bit resolution
+	while(REFCTL0 & REFGENBUSY);            // If ref generator busy, WAIT
+	REFCTL0 = REF_MAP(analog_reference);    // Set reference using masking off the SREF bits. See Energia.h.
+#endif
+#if defined(__MSP430_HAS_ADC12_B__)
+	ADC12CTL1 = ANALOG_STREAM_SHS | ADC12SHP | ADC12SSEL_0 | ADC12CONSEQ_3; // repeated sequence, MODOSC
+	ADC12CTL2 |= ADC12RES_2;                // 12-bit resolution
+	ADC12CTL3 = ADC12CSTARTADD_0 | ADC12TCMAP | ADC12BATMAP; // Map Temp and BAT
+	while(REFCTL0 & REFGENBUSY);            // If ref generator busy, WAIT
+	REFCTL0 = REF_MAP(analog_reference);    // Set reference using masking off the SREF bits. See Energia.h.
+#endif
+	for (slot = 0; slot < repeat * count; slot++) {
+		if (pins[slot % count] >= 128)
+			channel = pins[slot % count] - 128;
+		else
+			channel = digitalPinToADCIn(pins[slot % count]);
+		(&ADC12MCTL0)[slot] = channel | REFV_MAP(analog_reference)
+			| (slot == repeat * count - 1 ? ADC12EOS : 0);
+	}
+	stream_slots = repeat * count;
+	ADC12IFG_CLEAR();
+	ANALOG_STREAM_IE = 1U << (stream_slots - 1);  // interrupt once per pass
+	__delay_cycles(128);                    // Delay to allow Ref to settle
+	ADC12CTL0 |= ADC12ENC;                  // enable ADC, wait for the timer
+
+	ANALOG_STREAM_CCR0 = period - 1;
+	ANALOG_STREAM_CCR1 = period / 2;
+	ANALOG_STREAM_CCTL1 = OUTMOD_3;         // rising edge at CCR1, falling at CCR0
+	ANALOG_STREAM_CTL = ANALOG_STREAM_START | divider;
+	return 1;
+}
+
+void analogStreamEnd(void)
+{
+	if (!stream_slots)
+		return;
+	ANALOG_STREAM_CTL = 0;                  // stop the trigger
+	ANALOG_STREAM_CCTL1 = 0;
+	timerRelease(ANALOG_STREAM_CHANNEL, TIMER_OWNER_ADC);
+	ADC12CTL0 &= ~(ADC12ENC);
+	ADC12CTL1 &= ~ADC12CONSEQ_3;
+	ANALOG_STREAM_IE = 0;
+	ADC12IFG_CLEAR();
+	/* POWER: Turn ADC and reference voltage off to conserve power */
+	ADC12CTL0 &= ~(ADC12ON);
+	REFCTL0 &= ~(REFON);
+	stream_slots = 0;
+}
+
+static inline void analogStreamService(void)
+{
+	volatile unsigned int *mem = &ADC12MEM0;
+	uint16_t *out = stream_buffer + stream_index;
+	uint8_t slot;
+
+	for (slot = 0; slot < stream_slots; slot++)   // reading clears the flags
+		*out++ = mem[slot];
+	stream_index += stream_slots;
+
+	if (stream_index == stream_block) {
+		if (stream_callback)
+			stream_callback(stream_buffer, stream_block);
+	} else if (stream_index == 2 * stream_block) {
+		stream_index = 0;
+		if (stream_callback)
+			stream_callback(stream_buffer + stream_block, stream_block);
+	}
+}
+#endif
+
+#if defined(__MSP430_HAS_ADC10__) || defined(__MSP430_HAS_ADC10_B__) || defined(__MSP430_HAS_ADC12_PLUS__) || defined(__MSP430_HAS_ADC12_B__) || defined(__MSP430_HAS_ADC__)
+static void analogPowerOff(void)
+{
+    /* POWER: Turn ADC and reference voltage off to conserve power */
+#if defined(__MSP430_HAS_ADC10__)
+    ADC10CTL0 &= ~(ADC10ON | REFON);
+#endif
+#if defined(__MSP430_HAS_ADC10_B__)
+    ADC10CTL0 &= ~(ADC10ON);
+    REFCTL0 &= ~REFON;
+#endif
+#if defined(__MSP430_HAS_ADC__)
+    ADCCTL0 &= ~(ADCON);
+    //REFCTL0 &= ~REFON;
+    PMMCTL0_H = PMMPW_H;                // open PMM
+    PMMCTL2 &= ~(INTREFEN | TSENSOREN);
+    PMMCTL0_H = 0;                      // close PMM
+#endif
+#if defined(__MSP430_HAS_ADC12_PLUS__) || defined(__MSP430_HAS_ADC12_B__)
+    ADC12CTL0 &= ~(ADC12ON);
+    REFCTL0 &= ~(REFON);
+#endif
+    adc_channel = ADC_CHANNEL_NONE;
+}
+
+/* How much of the ADC set up analogRead() has to redo for this channel and reference */
+static uint8_t analogReadState(uint8_t channel, uint16_t reference)
+{
+	uint8_t state = ADC_SETUP;
+
+	if (adc_cache && adc_channel != ADC_CHANNEL_NONE && adc_reference == reference)
+		state = (adc_channel == channel) ? ADC_READY : ADC_MUX;
+	adc_channel = adc_cache ? channel : ADC_CHANNEL_NONE;
+	adc_reference = reference;
+	return state;
+}
+#endif
+
+void analogReadCache(uint8_t enable)
+{
+#if defined(__MSP430_HAS_ADC10__) || defined(__MSP430_HAS_ADC10_B__) || defined(__MSP430_HAS_ADC12_PLUS__) || defined(__MSP430_HAS_ADC12_B__) || defined(__MSP430_HAS_ADC__)
+	if (!enable && adc_channel != ADC_CHANNEL_NONE)
+		analogPowerOff();
+#endif
+	adc_cache = enable;
+}
+
 uint16_t analogRead(uint8_t pin)
 {
 // make sure we have an ADC
 	uint8_t channel;
+#if defined(__MSP430_HAS_ADC10__) || defined(__MSP430_HAS_ADC10_B__) || defined(__MSP430_HAS_ADC12_PLUS__) || defined(__MSP430_HAS_ADC12_B__) || defined(__MSP430_HAS_ADC__)
+	uint8_t state;
+#endif
+#if defined(__MSP430_HAS_ADC12_PLUS__) || defined(__MSP430_HAS_ADC12_B__)
+	uint16_t reference;
+#endif
 	
 	// Check if pin is a special analog pin (A10 = temp sensor, A11 = Vcc/2, etc.)
 	if (pin >=128)
@@ -334,6 +574,10 @@ uint16_t analogRead(uint8_t pin)
 	// Check if pin is valid
 	if (pin==NOT_ON_ADC)
 		return 0;
+#if defined(ANALOG_STREAM_AVAILABLE)
+	// a single conversion needs the ADC back
+	analogStreamEnd();
+#endif
 #if defined(__MSP430_HAS_ADC10__) || defined(__MSP430_HAS_ADC10_B__) || defined(__MSP430_HAS_ADC12_PLUS__) || defined(__MSP430_HAS_ADC12_B__) || defined(__MSP430_HAS_ADC__)
     //  0000 A0
     //  0001 A1
@@ -353,120 +597,138 @@ uint16_t analogRead(uint8_t pin)
     // Total time per sample = Tconvert + Tsample = 64 + 13 = 67 us = ~15k samples / sec
 
 #if defined(__MSP430_HAS_ADC10__)
-    ADC10CTL0 &= ~ADC10ENC;                 // disable ADC
-    ADC10CTL1 = ADC10SSEL_0 | ADC10DIV_4;   // ADC10OSC as ADC10CLK (~5MHz) / 5
-    ADC10CTL0 = REFV_MAP(analog_reference) | // set analog reference
-            ADC10ON | ADC10SHT_3 | ADC10IE; // turn ADC ON; sample + hold @ 64 × ADC10CLKs; Enable interrupts
-    ADC10CTL1 |= (channel << 12);               // select channel
-    ADC10AE0 = (1 << channel);                  // Disable input/output buffer on pin
-    __delay_cycles(128);                    // Delay to allow Ref to settle
+    state = analogReadState(channel, analog_reference);
+    if (state == ADC_SETUP) {
+        ADC10CTL0 &= ~ADC10ENC;                 // disable ADC
+        ADC10CTL1 = ADC10SSEL_0 | ADC10DIV_4;   // ADC10OSC as ADC10CLK (~5MHz) / 5
+        ADC10CTL0 = REFV_MAP(analog_reference) | // set analog reference
+                ADC10ON | ADC10SHT_3 | ADC10IE; // turn ADC ON; sample + hold @ 64 × ADC10CLKs; Enable interrupts
+    }
+    if (state != ADC_READY) {
+        ADC10CTL1 = (ADC10CTL1 & ~INCH_15) | (channel << 12); // select channel
+        ADC10AE0 = (1 << channel);              // Disable input/output buffer on pin
+    }
+    if (state == ADC_SETUP)
+        __delay_cycles(128);                    // Delay to allow Ref to settle
     ADC10CTL0 |= ADC10ENC | ADC10SC;        // enable ADC and start conversion
     while (ADC10CTL1 & ADC10BUSY) {         // sleep and wait for completion
         __bis_SR_register(CPUOFF + GIE);    // LPM0 with interrupts enabled
     }
-    /* POWER: Turn ADC and reference voltage off to conserve power */
     ADC10CTL0 &= ~(ADC10ENC);
-    ADC10CTL0 &= ~(ADC10ON | REFON);
+    if (!adc_cache)
+        analogPowerOff();
 #endif
 #if defined(__MSP430_HAS_ADC10_B__)
-    ADC10CTL0 &= ~ADC10ENC;                 // disable ADC
-    ADC10CTL1 = ADC10SSEL_0 | ADC10DIV_4;   // ADC10OSC as ADC10CLK (~5MHz) / 5
-    while(REFCTL0 & REFGENBUSY);            // If ref generator busy, WAIT
-    REFCTL0 = REF_MAP(analog_reference); // Set reference using masking off the SREF bits. See Energia.h.
-    ADC10MCTL0 = channel | REFV_MAP(analog_reference); // set channel and reference 
-    ADC10CTL0 = ADC10ON | ADC10SHT_4;       // turn ADC ON; sample + hold @ 64 × ADC10CLKs
-    ADC10CTL1 |= ADC10SHP;                  // ADCCLK = MODOSC; sampling timer
-    ADC10CTL2 |= ADC10RES;                  // 10-bit resolution
-    ADC10IFG = 0;                           // Clear Flags
-    ADC10IE |= ADC10IE0;                    // Enable interrupts
-    __delay_cycles(128);                    // Delay to allow Ref to settle
+    state = analogReadState(channel, analog_reference);
+    if (state == ADC_SETUP) {
+        ADC10CTL0 &= ~ADC10ENC;                 // disable ADC
+        ADC10CTL1 = ADC10SSEL_0 | ADC10DIV_4;   // ADC10OSC as ADC10CLK (~5MHz) / 5
+        while(REFCTL0 & REFGENBUSY);            // If ref generator busy, WAIT
+        REFCTL0 = REF_MAP(analog_reference); // Set reference using masking off the SREF bits. See Energia.h.
+    }
+    if (state != ADC_READY)
+        ADC10MCTL0 = channel | REFV_MAP(analog_reference); // set channel and reference 
+    if (state == ADC_SETUP) {
+        ADC10CTL0 = ADC10ON | ADC10SHT_4;       // turn ADC ON; sample + hold @ 64 × ADC10CLKs
+        ADC10CTL1 |= ADC10SHP;                  // ADCCLK = MODOSC; sampling timer
+        ADC10CTL2 |= ADC10RES;                  // 10-bit resolution
+        ADC10IFG = 0;                           // Clear Flags
+        ADC10IE |= ADC10IE0;                    // Enable interrupts
+        __delay_cycles(128);                    // Delay to allow Ref to settle
+    }
     ADC10CTL0 |= ADC10ENC | ADC10SC;        // enable ADC and start conversion
     while (ADC10CTL1 & ADC10BUSY) {         // sleep and wait for completion
         __bis_SR_register(CPUOFF + GIE);    // LPM0 with interrupts enabled
     }
-    /* POWER: Turn ADC and reference voltage off to conserve power */
     ADC10CTL0 &= ~(ADC10ENC);
-    ADC10CTL0 &= ~(ADC10ON);
-    REFCTL0 &= ~REFON;
+    if (!adc_cache)
+        analogPowerOff();
 #endif
 #if defined(__MSP430_HAS_ADC__)
-    ADCCTL0 &= ~ADCENC;                 // disable ADC
-    ADCCTL1 = ADCSSEL_0 | ADCDIV_4;   // ADC10OSC as ADC10CLK (~5MHz) / 5
-    //REFCTL0 = REF_MAP(analog_reference); // Set reference using masking off the SREF bits. See Energia.h.
-    PMMCTL0_H = PMMPW_H;                // open PMM
-    PMMCTL2 |= INTREFEN;                // enable Ref
-    if (pin == TEMPSENSOR) PMMCTL2 |= TSENSOREN;     // enable TC
-    ADCMCTL0 = channel | REFV_MAP(analog_reference); // set channel and reference
-    ADCCTL0 = ADCON | ADCSHT_4;         // turn ADC ON; sample + hold @ 64 × ADC10CLKs
-    ADCCTL1 |= ADCSHP;                  // ADCCLK = MODOSC; sampling timer
-    ADCCTL2 |= ADCRES;                  // 10-bit resolution
-    ADCIFG = 0;                         // Clear Flags
-    ADCIE |= ADCIE0;                    // Enable interrupts
-    __delay_cycles(128);                // Delay to allow Ref to settle
+    state = analogReadState(channel, analog_reference);
+    if (state == ADC_MUX && (pin == TEMPSENSOR || (PMMCTL2 & TSENSOREN)))
+        state = ADC_SETUP;                  // the sensor needs switching and time to settle
+    if (state == ADC_SETUP) {
+        ADCCTL0 &= ~ADCENC;                 // disable ADC
+        ADCCTL1 = ADCSSEL_0 | ADCDIV_4;   // ADC10OSC as ADC10CLK (~5MHz) / 5
+        //REFCTL0 = REF_MAP(analog_reference); // Set reference using masking off the SREF bits. See Energia.h.
+        PMMCTL0_H = PMMPW_H;                // open PMM
+        PMMCTL2 |= INTREFEN;                // enable Ref
+        if (pin == TEMPSENSOR) PMMCTL2 |= TSENSOREN;     // enable TC
+        else PMMCTL2 &= ~TSENSOREN;
+        PMMCTL0_H = 0;                      // close PMM
+    }
+    if (state != ADC_READY)
+        ADCMCTL0 = channel | REFV_MAP(analog_reference); // set channel and reference
+    if (state == ADC_SETUP) {
+        ADCCTL0 = ADCON | ADCSHT_4;         // turn ADC ON; sample + hold @ 64 × ADC10CLKs
+        ADCCTL1 |= ADCSHP;                  // ADCCLK = MODOSC; sampling timer
+        ADCCTL2 |= ADCRES;                  // 10-bit resolution
+        ADCIFG = 0;                         // Clear Flags
+        ADCIE |= ADCIE0;                    // Enable interrupts
+        __delay_cycles(128);                // Delay to allow Ref to settle
+    }
     ADCCTL0 |= ADCENC | ADCSC;          // enable ADC and start conversion
     while (ADCCTL1 & ADCBUSY) {         // sleep and wait for completion
         __bis_SR_register(CPUOFF + GIE);    // LPM0 with interrupts enabled
     }
-    /* POWER: Turn ADC and reference voltage off to conserve power */
     ADCCTL0 &= ~(ADCENC);
-    ADCCTL0 &= ~(ADCON);
-    //REFCTL0 &= ~REFON;
-    PMMCTL2 &= ~(INTREFEN | TSENSOREN);
-    PMMCTL0_H = 0;                      // close PMM
+    if (!adc_cache)
+        analogPowerOff();
 #endif
 #if defined(__MSP430_HAS_ADC12_PLUS__)
-    ADC12CTL0 &= ~ADC12ENC;                 // disable ADC
-    ADC12CTL1 = ADC12SSEL_0 | ADC12DIV_4;   // ADC12OSC as ADC12CLK (~5MHz) / 5
-    while(REFCTL0 & REFGENBUSY);            // If ref generator busy, WAIT
-    if (pin == TEMPSENSOR) {// if Temp Sensor 
-        REFCTL0 = REF_MAP(INTERNAL1V5);               // Set reference to internal 1.5V
-        ADC12MCTL0 = channel | REFV_MAP(INTERNAL1V5); // set channel and reference 
-    } else {
-        REFCTL0 = REF_MAP(analog_reference);          // Set reference using masking off the SREF bits. See Energia.h.
-        ADC12MCTL0 = channel | REFV_MAP(analog_reference); // set channel and reference 
+    reference = (pin == TEMPSENSOR) ? INTERNAL1V5 : analog_reference; // internal 1.5V for the Temp Sensor
+    state = analogReadState(channel, reference);
+    if (state == ADC_SETUP) {
+        ADC12CTL0 &= ~ADC12ENC;                 // disable ADC
+        ADC12CTL1 = ADC12SSEL_0 | ADC12DIV_4;   // ADC12OSC as ADC12CLK (~5MHz) / 5
+        while(REFCTL0 & REFGENBUSY);            // If ref generator busy, WAIT
+        REFCTL0 = REF_MAP(reference);           // Set reference using masking off the SREF bits. See Energia.h.
+    }
+    if (state != ADC_READY)
+        ADC12MCTL0 = channel | REFV_MAP(reference); // set channel and reference 
+    if (state == ADC_SETUP) {
+        ADC12CTL0 = ADC12ON | ADC12SHT0_4;      // turn ADC ON; sample + hold @ 64 × ADC10CLKs
+        ADC12CTL1 |= ADC12SHP;                  // ADCCLK = MODOSC; sampling timer
+        ADC12CTL2 |= ADC12RES1;                 // 12-bit resolution
+        ADC12IFG = 0;                           // Clear Flags
+        ADC12IE |= ADC12IE0;                    // Enable interrupts
+        __delay_cycles(128);                    // Delay to allow Ref to settle
     }
-    ADC12CTL0 = ADC12ON | ADC12SHT0_4;      // turn ADC ON; sample + hold @ 64 × ADC10CLKs
-    ADC12CTL1 |= ADC12SHP;                  // ADCCLK = MODOSC; sampling timer
-    ADC12CTL2 |= ADC12RES1;                 // 12-bit resolution
-    ADC12IFG = 0;                           // Clear Flags
-    ADC12IE |= ADC12IE0;                    // Enable interrupts
-    __delay_cycles(128);                    // Delay to allow Ref to settle
     ADC12CTL0 |= ADC12ENC | ADC12SC;        // enable ADC and start conversion
     while (ADC12CTL1 & ADC12BUSY) {         // sleep and wait for completion
         __bis_SR_register(CPUOFF + GIE);    // LPM0 with interrupts enabled
     }
-    /* POWER: Turn ADC and reference voltage off to conserve power */
     ADC12CTL0 &= ~(ADC12ENC);
-    ADC12CTL0 &= ~(ADC12ON);
-    REFCTL0 &= ~REFON;
+    if (!adc_cache)
+        analogPowerOff();
 #endif
 #if defined(__MSP430_HAS_ADC12_B__)
-    ADC12CTL0 &= ~ADC12ENC;                 // disable ADC
-    ADC12CTL0 = ADC12ON | ADC12SHT0_4;      // turn ADC ON; sample + hold @ 64 × ADC12CLKs
-    ADC12CTL1 = ADC12SSEL_0 | ADC12DIV_4;   // ADC12OSC as ADC12CLK (~5MHz) / 5
-    ADC12CTL3 = ADC12TCMAP | ADC12BATMAP;   // Map Temp and BAT
-    ADC12CTL1 |= ADC12SHP;                  // ADCCLK = MODOSC; sampling timer
-    ADC12CTL2 |= ADC12RES_2;                // 12-bit resolution
-    ADC12IFGR0 = 0;                         // Clear Flags
-    ADC12IER0 |= ADC12IE0;                  // Enable interrupts
-    while(REFCTL0 & REFGENBUSY);            // If ref generator busy, WAIT
-    if (pin == TEMPSENSOR) {// if Temp Sensor
-      REFCTL0 = REF_MAP(INTERNAL1V2);       // Set reference to internal 1.2V
-      ADC12MCTL0 = channel | REFV_MAP(INTERNAL1V2); // set channel and reference 
-    } else {
-      REFCTL0 = REF_MAP(analog_reference);  // Set reference using masking off the SREF bits. See Energia.h.
-      ADC12MCTL0 = channel | REFV_MAP(analog_reference); // set channel and reference 
+    reference = (pin == TEMPSENSOR) ? INTERNAL1V2 : analog_reference; // internal 1.2V for the Temp Sensor
+    state = analogReadState(channel, reference);
+    if (state == ADC_SETUP) {
+        ADC12CTL0 &= ~ADC12ENC;                 // disable ADC
+        ADC12CTL0 = ADC12ON | ADC12SHT0_4;      // turn ADC ON; sample + hold @ 64 × ADC12CLKs
+        ADC12CTL1 = ADC12SSEL_0 | ADC12DIV_4;   // ADC12OSC as ADC12CLK (~5MHz) / 5
+        ADC12CTL3 = ADC12TCMAP | ADC12BATMAP;   // Map Temp and BAT
+        ADC12CTL1 |= ADC12SHP;                  // ADCCLK = MODOSC; sampling timer
+        ADC12CTL2 |= ADC12RES_2;                // 12-bit resolution
+        ADC12IFGR0 = 0;                         // Clear Flags
+        ADC12IER0 |= ADC12IE0;                  // Enable interrupts
+        while(REFCTL0 & REFGENBUSY);            // If ref generator busy, WAIT
+        REFCTL0 = REF_MAP(reference);           // Set reference using masking off the SREF bits. See Energia.h.
     }
-    if (REFCTL0 & REFON)
+    if (state != ADC_READY)
+        ADC12MCTL0 = channel | REFV_MAP(reference); // set channel and reference 
+    if (state == ADC_SETUP && (REFCTL0 & REFON))
         while(!(REFCTL0 & REFGENRDY));      // wait till ref generator ready
     ADC12CTL0 |= ADC12ENC | ADC12SC;        // enable ADC and start conversion
     while (ADC12CTL1 & ADC12BUSY) {         // sleep and wait for completion
         __bis_SR_register(CPUOFF + GIE);    // LPM0 with interrupts enabled
     }
-    /* POWER: Turn ADC and reference voltage off to conserve power */
     ADC12CTL0 &= ~(ADC12ENC);
-    ADC12CTL0 &= ~(ADC12ON);
-    REFCTL0 &= ~(REFON);
+    if (!adc_cache)
+        analogPowerOff();
 #endif
     return mapResolution(ADCxMEM0, DEFAULT_READ_RESOLUTION, _readResolution);
 #else
@@ -529,6 +791,12 @@ void ADC10_ISR(void)
 __attribute__((interrupt(ADC12_VECTOR)))
 void ADC12_ISR(void)
 {
+#if defined(ANALOG_STREAM_AVAILABLE)
+    if (stream_slots) {
+        analogStreamService();
+        return;
+    }
+#endif
     switch(ADC12IV,12) {
         case  0: break;                          // No interrupt
         case  2: break;                          // conversion result overflow
@@ -550,6 +818,12 @@ void ADC12_ISR(void)
 __attribute__((interrupt(ADC12_VECTOR)))
 void ADC12_ISR(void)
 {
+#if defined(ANALOG_STREAM_AVAILABLE)
+    if (stream_slots) {
+        analogStreamService();
+        return;
+    }
+#endif
     switch(ADC12IV,12) {
         case  0: break;                          // No interrupt
         case  2: break;                          // conversion result overflow
@@ -252,3 +252,89 @@ void digitalWrite(uint8_t pin, uint8_t val)
 		*out |= bit;
 	}
 }
+
+void portWrite(uint8_t port, uint8_t mask, uint8_t value)
+{
+	volatile uint8_t *out;
+	uint16_t globalInterruptState;
+
+	if (port == NOT_A_PORT) return;
+
+	out = portOutputRegister(port);
+
+	/* read-modify-write of PxOUT, kept atomic against interrupt handlers */
+	globalInterruptState = __read_status_register() & GIE;
+	__disable_interrupt();
+	*out = (*out & ~mask) | (value & mask);
+	__bis_SR_register(globalInterruptState);
+}
+
+uint8_t portRead(uint8_t port)
+{
+	if (port == NOT_A_PORT) return 0;
+
+	return *portInputRegister(port);
+}
+
+uint8_t portGroupInit(PortGroup *group, const uint8_t *pins, uint8_t count)
+{
+	uint8_t i, port;
+
+	group->port = NOT_A_PORT;
+	group->mask = 0;
+	group->shift = PORT_GROUP_SCATTERED;
+	group->count = count;
+
+	if (count == 0 || count > 8) return 0;
+
+	port = digitalPinToPort(pins[0]);
+	if (port == NOT_A_PORT) return 0;
+
+	for (i = 0; i < count; i++) {
+		if (digitalPinToPort(pins[i]) != port) return 0;
+		group->bits[i] = digitalPinToBitMask(pins[i]);
+		group->mask |= group->bits[i];
+	}
+	group->port = port;
+
+	/* pins on consecutive ascending bits take a shift instead of a loop */
+	for (i = 0; i < 8 && !(group->bits[0] & (1 << i)); i++);
+	group->shift = i;
+	for (i = 1; i < count; i++) {
+		if (group->bits[i] != (uint8_t)(group->bits[0] << i)) {
+			group->shift = PORT_GROUP_SCATTERED;
+			break;
+		}
+	}
+	return 1;
+}
+
+void portGroupWrite(const PortGroup *group, uint8_t value)
+{
+	uint8_t bits = 0;
+	uint8_t i;
+
+	if (group->shift != PORT_GROUP_SCATTERED) {
+		bits = value << group->shift;
+	} else {
+		for (i = 0; i < group->count; i++, value >>= 1)
+			if (value & 1) bits |= group->bits[i];
+	}
+	portWrite(group->port, group->mask, bits);
+}
+
+uint8_t portGroupRead(const PortGroup *group)
+{
+	uint8_t bits = portRead(group->port) & group->mask;
+	uint8_t value = 0;
+	uint8_t i;
+
+	if (group->shift != PORT_GROUP_SCATTERED)
+		return bits >> group->shift;
+
+	for (i = group->count; i-- > 0; ) {
+		value <<= 1;
+		if (bits & group->bits[i]) value |= 1;
+	}
+	return value;
+}
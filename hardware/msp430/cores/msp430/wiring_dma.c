@@ -0,0 +1,92 @@
+/*
+  ************************************************************************
+  *	wiring_dma.c
+  *
+  *	DMA channel allocation and the shared DMA interrupt for the MSP430 core
+  *
+  ***********************************************************************
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General
+  Public License along with this library; if not, write to the
+  Free Software Foundation, Inc., 59 Temple Place, Suite 330,
+  Boston, MA  02111-1307  USA
+*/
+
+/*
+ * All channels raise the one DMA vector, so it lives here and hands each
+ * completion to the handler of the channel DMAIV reports. The trigger
+ * selects of two channels share a DMACTLx register and are only written
+ * here, with interrupts off. Like the timer compare vectors, this file is
+ * only linked in by sketches that claim a channel.
+ */
+
+#include "wiring_private.h"
+
+#if defined(DMA_AVAILABLE)
+
+#if defined(__MSP430_HAS_DMAX_6__)
+#define DMA_CHANNELS 6
+#else
+#define DMA_CHANNELS 3
+#endif
+
+#define DMA_CTL(n)  ((&DMA0CTL)[(n) * 8])       // channel registers are 16 bytes apart
+#define DMA_TSEL(n) ((&DMACTL0)[(n) >> 1])      // two trigger selects per register
+
+static uint8_t dma_claimed;
+static void (* volatile dma_handler[DMA_CHANNELS])(uint8_t channel);
+
+uint8_t dmaClaim(uint8_t channel, uint8_t trigger, void (*handler)(uint8_t channel))
+{
+	uint8_t shift = (channel & 1) ? 8 : 0;
+	uint16_t globalInterruptState;
+
+	if (channel >= DMA_CHANNELS)
+		return 0;
+	globalInterruptState = __read_status_register() & GIE;
+	__disable_interrupt();
+	if (dma_claimed & (1 << channel)) {
+		__bis_SR_register(globalInterruptState);
+		return 0;
+	}
+	dma_claimed |= 1 << channel;
+	dma_handler[channel] = handler;
+	DMA_CTL(channel) = 0;
+	DMA_TSEL(channel) = (DMA_TSEL(channel) & ~(0x1F << shift)) | ((uint16_t)(trigger & 0x1F) << shift);
+	__bis_SR_register(globalInterruptState);
+	return 1;
+}
+
+void dmaRelease(uint8_t channel)
+{
+	uint16_t globalInterruptState;
+
+	if (channel >= DMA_CHANNELS)
+		return;
+	globalInterruptState = __read_status_register() & GIE;
+	__disable_interrupt();
+	DMA_CTL(channel) = 0;                   // stops it and drops a pending DMAIFG
+	dma_handler[channel] = 0;
+	dma_claimed &= ~(1 << channel);
+	__bis_SR_register(globalInterruptState);
+}
+
+__attribute__((interrupt(DMA_VECTOR)))
+void DMA_ISR(void)
+{
+	uint8_t n = (DMAIV >> 1) - 1;           // reading DMAIV clears the flag
+
+	if (n < DMA_CHANNELS && dma_handler[n])
+		dma_handler[n](n);
+}
+#endif
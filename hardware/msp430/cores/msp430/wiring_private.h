@@ -53,6 +53,19 @@ extern "C"{
 
 typedef void (*voidFuncPtr)(void);
 
+/* Timer_A compare channels, see wiring_timer_compare.c */
+#if defined(__MSP430_HAS_T1A5__)
+#define TIMER_COMPARE1_CHANNELS 5
+#elif defined(__MSP430_HAS_T1A3__)
+#define TIMER_COMPARE1_CHANNELS 3
+#elif defined(__MSP430_HAS_T1A2__)
+#define TIMER_COMPARE1_CHANNELS 2
+#else
+#define TIMER_COMPARE1_CHANNELS 0
+#endif
+extern uint8_t timer_compare_timers;
+void timerCompareService(uint8_t channel);
+
 #ifdef __cplusplus
 } // extern "C"
 #endif
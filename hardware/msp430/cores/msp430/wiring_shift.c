@@ -33,31 +33,47 @@
 #include "wiring_private.h"
 
 uint8_t shiftIn(uint8_t dataPin, uint8_t clockPin, uint8_t bitOrder) {
+	uint8_t dataPort = digitalPinToPort(dataPin);
+	uint8_t dataBit = digitalPinToBitMask(dataPin);
+	uint8_t clockPort = digitalPinToPort(clockPin);
+	uint8_t clockBit = digitalPinToBitMask(clockPin);
 	uint8_t value = 0;
 	uint8_t i;
 
+	if (dataPort == NOT_A_PORT || clockPort == NOT_A_PORT) return 0;
+
+	/* ports and masks are looked up once, each edge is one register write */
 	for (i = 0; i < 8; ++i) {
-		digitalWrite(clockPin, HIGH);
-		if (bitOrder == LSBFIRST)
-			value |= digitalRead(dataPin) << i;
-		else
-			value |= digitalRead(dataPin) << (7 - i);
-		digitalWrite(clockPin, LOW);
+		portWrite(clockPort, clockBit, clockBit);
+		if (portRead(dataPort) & dataBit) {
+			if (bitOrder == LSBFIRST)
+				value |= 1 << i;
+			else
+				value |= 1 << (7 - i);
+		}
+		portWrite(clockPort, clockBit, 0);
 	}
 	return value;
 }
 
 void shiftOut(uint8_t dataPin, uint8_t clockPin, uint8_t bitOrder, uint8_t val)
 {
-	uint8_t i;
+	uint8_t dataPort = digitalPinToPort(dataPin);
+	uint8_t dataBit = digitalPinToBitMask(dataPin);
+	uint8_t clockPort = digitalPinToPort(clockPin);
+	uint8_t clockBit = digitalPinToBitMask(clockPin);
+	uint8_t i, bit;
+
+	if (dataPort == NOT_A_PORT || clockPort == NOT_A_PORT) return;
 
 	for (i = 0; i < 8; i++)  {
 		if (bitOrder == LSBFIRST)
-			digitalWrite(dataPin, !!(val & (1 << i)));
-		else	
-			digitalWrite(dataPin, !!(val & (1 << (7 - i))));
-			
-		digitalWrite(clockPin, HIGH);
-		digitalWrite(clockPin, LOW);		
+			bit = val & (1 << i);
+		else
+			bit = val & (1 << (7 - i));
+
+		portWrite(dataPort, dataBit, bit ? dataBit : 0);
+		portWrite(clockPort, clockBit, clockBit);
+		portWrite(clockPort, clockBit, 0);
 	}
 }
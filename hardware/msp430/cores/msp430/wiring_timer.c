@@ -0,0 +1,144 @@
+/*
+  ************************************************************************
+  *	wiring_timer.c
+  *
+  *	Timer channel allocation for the MSP430 core
+  *
+  ***********************************************************************
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General
+  Public License along with this library; if not, write to the
+  Free Software Foundation, Inc., 59 Temple Place, Suite 330,
+  Boston, MA  02111-1307  USA
+*/
+
+#include "wiring_private.h"
+#include "pins_energia.h"
+
+#define TIMERS 6
+
+/* first channel of each timer, the last entry ends the last timer */
+static const uint8_t timer_first[TIMERS + 1] = { T0A0, T1A0, T2A0, T0B0, T1B0, T2B0, TIMER_CHANNELS };
+
+static const char * const timer_owner_name[] = {
+	"none", "timebase", "analogWrite", "tone", "Servo", "OneMsTaskTimer", "analogStream", "user"
+};
+
+/* The timer that keeps millis() on boards with TIMEBASE_TIMER is taken
+ * from the start, none of its channels are given out. */
+#if defined(TIMEBASE_TIMER) && TIMEBASE_TIMER == 1
+#define TIMEBASE_INDEX 1
+#define TIMEBASE_CHANNEL T1A0
+#endif
+#if defined(TIMEBASE_TIMER) && TIMEBASE_TIMER == 2
+#define TIMEBASE_INDEX 2
+#define TIMEBASE_CHANNEL T2A0
+#endif
+#if defined(TIMEBASE_TIMER) && !defined(TIMEBASE_INDEX)
+#error "TIMEBASE_TIMER must select Timer1_A or Timer2_A"
+#endif
+
+#if defined(TIMEBASE_INDEX)
+static uint8_t timer_mode[TIMERS] = { [TIMEBASE_INDEX] = TIMER_MODE_EXCLUSIVE };
+static uint8_t timer_owner[TIMER_CHANNELS] = { [TIMEBASE_CHANNEL] = TIMER_OWNER_TIMEBASE };
+#else
+static uint8_t timer_mode[TIMERS];
+static uint8_t timer_owner[TIMER_CHANNELS];
+#endif
+
+static uint8_t timerOf(uint8_t channel)
+{
+	uint8_t timer = 0;
+
+	while (channel >= timer_first[timer + 1])
+		timer++;
+	return timer;
+}
+
+uint8_t timerClaim(uint8_t channel, uint8_t mode, uint8_t owner)
+{
+	uint8_t timer, first, granted = 0;
+	uint16_t globalInterruptState;
+
+	if (channel >= TIMER_CHANNELS || owner == TIMER_OWNER_NONE)
+		return 0;
+	timer = timerOf(channel);
+	first = timer_first[timer];
+	if (mode == TIMER_MODE_UP && channel == first)
+		return 0;                       // CCR0 holds the period
+	if (mode == TIMER_MODE_EXCLUSIVE && channel != first)
+		return 0;
+
+	globalInterruptState = __read_status_register() & GIE;
+	__disable_interrupt();
+	if (timer_mode[timer] == TIMER_MODE_NONE) {
+		timer_mode[timer] = mode;
+		if (mode != TIMER_MODE_CONTINUOUS)
+			timer_owner[first] = owner;     // the period, or the whole timer
+	}
+	// up and exclusive timers are one owner's, continuous ones are shared
+	if (timer_mode[timer] == mode
+	    && (mode == TIMER_MODE_CONTINUOUS || timer_owner[first] == owner)
+	    && (timer_owner[channel] == TIMER_OWNER_NONE || timer_owner[channel] == owner)) {
+		timer_owner[channel] = owner;
+		granted = 1;
+	}
+	__bis_SR_register(globalInterruptState);
+	return granted;
+}
+
+void timerRelease(uint8_t channel, uint8_t owner)
+{
+	uint8_t timer, first, i, busy = 0;
+	uint16_t globalInterruptState;
+
+	if (channel >= TIMER_CHANNELS)
+		return;
+	timer = timerOf(channel);
+	first = timer_first[timer];
+
+	globalInterruptState = __read_status_register() & GIE;
+	__disable_interrupt();
+	if (timer_owner[channel] == owner && owner != TIMER_OWNER_NONE
+	    && !(timer_mode[timer] == TIMER_MODE_UP && channel == first)) {
+		timer_owner[channel] = TIMER_OWNER_NONE;
+		// the timer is free again with its last channel
+		for (i = (timer_mode[timer] == TIMER_MODE_UP) ? first + 1 : first; i < timer_first[timer + 1]; i++)
+			if (timer_owner[i] != TIMER_OWNER_NONE)
+				busy = 1;
+		if (!busy) {
+			timer_owner[first] = TIMER_OWNER_NONE;
+			timer_mode[timer] = TIMER_MODE_NONE;
+		}
+	}
+	__bis_SR_register(globalInterruptState);
+}
+
+uint8_t timerOwner(uint8_t channel)
+{
+	uint8_t timer;
+
+	if (channel >= TIMER_CHANNELS)
+		return TIMER_OWNER_NONE;
+	timer = timerOf(channel);
+	if (timer_mode[timer] == TIMER_MODE_EXCLUSIVE)
+		return timer_owner[timer_first[timer]];
+	return timer_owner[channel];
+}
+
+const char *timerOwnerName(uint8_t owner)
+{
+	if (owner >= sizeof(timer_owner_name) / sizeof(timer_owner_name[0]))
+		return "?";
+	return timer_owner_name[owner];
+}
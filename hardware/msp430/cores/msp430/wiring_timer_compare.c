@@ -0,0 +1,181 @@
+/*
+  ************************************************************************
+  *	wiring_timer_compare.c
+  *
+  *	Timer0_A compare channels shared by tone(), Servo and OneMsTaskTimer
+  *
+  ***********************************************************************
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General
+  Public License along with this library; if not, write to the
+  Free Software Foundation, Inc., 59 Temple Place, Suite 330,
+  Boston, MA  02111-1307  USA
+*/
+
+/*
+ * A compare timer runs continuous at SMCLK/8 while any of its channels is
+ * attached and every channel moves its own compare on by what its handler
+ * returns. Timer0_A always hands out compare channels. Timer1_A does too
+ * once timerCompareUseTimer1() was called, and is then taken first, so
+ * that analogWrite() keeps PWM on the Timer0_A pins. A timer that already
+ * runs compares is preferred over starting another one; a timer doing PWM
+ * is never used. The Timer0_A vectors live here and the Timer1_A ones in
+ * wiring_timer_compare1.c, so each is only linked in when used.
+ * TimerSerial still takes Timer0_A for itself and can not be used at the
+ * same time.
+ */
+
+#include "wiring_private.h"
+#include "pins_energia.h"
+
+#ifndef TIMER0_A0_VECTOR
+#define TIMER0_A0_VECTOR TIMERA0_VECTOR
+#define TIMER0_A1_VECTOR TIMERA1_VECTOR
+#endif
+
+#if defined(__MSP430_HAS_TA5__) || defined(__MSP430_HAS_T0A5__)
+#define COMPARE0_CHANNELS 5
+#elif defined(__MSP430_HAS_TA3__) || defined(__MSP430_HAS_T0A3__)
+#define COMPARE0_CHANNELS 3
+#else
+#define COMPARE0_CHANNELS 2
+#endif
+#define COMPARE1_CHANNELS TIMER_COMPARE1_CHANNELS
+
+#if COMPARE1_CHANNELS
+#define COMPARE_REG(t, reg0, reg1) (*((t) ? &(reg1) : &(reg0)))
+#else
+#define COMPARE_REG(t, reg0, reg1) (reg0)
+#endif
+#define COMPARE_CTL(t)     COMPARE_REG(t, TA0CTL, TA1CTL)
+#define COMPARE_R(t)       COMPARE_REG(t, TA0R, TA1R)
+#define COMPARE_CCTL(t, n) ((&COMPARE_REG(t, TA0CCTL0, TA1CCTL0))[n])
+#define COMPARE_CCR(t, n)  ((&COMPARE_REG(t, TA0CCR0, TA1CCR0))[n])
+
+/* handlers of Timer0_A, then those of Timer1_A */
+#define COMPARE_SLOT(t, n) ((t) ? COMPARE0_CHANNELS + (n) : (n))
+
+static const uint8_t compare_channels[2] = { COMPARE0_CHANNELS, COMPARE1_CHANNELS };
+static const uint8_t compare_first[2] = { T0A0, T1A0 };
+static uint16_t (* volatile compare_handler[COMPARE0_CHANNELS + COMPARE1_CHANNELS])(uint8_t channel);
+
+uint8_t timer_compare_timers = 1;       // bit t: timer t hands out channels
+
+static uint8_t compareRunning(uint8_t t)
+{
+	uint8_t n;
+
+	for (n = 0; n < compare_channels[t]; n++)
+		if (compare_handler[COMPARE_SLOT(t, n)])
+			return 1;
+	return 0;
+}
+
+/* called with interrupts disabled */
+static uint8_t compareAttach(uint8_t t, uint16_t (*handler)(uint8_t channel), uint16_t first, uint8_t owner)
+{
+	uint8_t n, running = compareRunning(t);
+
+	for (n = 0; n < compare_channels[t]; n++)
+		if (!compare_handler[COMPARE_SLOT(t, n)]
+		    && timerClaim(compare_first[t] + n, TIMER_MODE_CONTINUOUS, owner))
+			break;
+	if (n == compare_channels[t])
+		return TIMER_CHANNEL_NONE;      // all taken, or the timer does PWM
+	if (!running) {
+		uint8_t i;
+		for (i = 0; i < compare_channels[t]; i++)
+			COMPARE_CCTL(t, i) = 0;
+		COMPARE_CTL(t) = TACLR | TASSEL_2 | ID_3 | MC_2; // SMCLK/8, continuous
+	}
+	compare_handler[COMPARE_SLOT(t, n)] = handler;
+	COMPARE_CCR(t, n) = COMPARE_R(t) + first;
+	COMPARE_CCTL(t, n) = CCIE;
+	return compare_first[t] + n;
+}
+
+uint8_t timerCompareAttach(uint16_t (*handler)(uint8_t channel), uint16_t first, uint8_t owner)
+{
+	uint8_t pass, t, channel = TIMER_CHANNEL_NONE;
+	uint16_t globalInterruptState;
+
+	globalInterruptState = __read_status_register() & GIE;
+	__disable_interrupt();
+	/* first a timer that already runs compares, then an idle one; Timer1_A
+	 * before Timer0_A in both cases */
+	for (pass = 0; pass < 2 && channel == TIMER_CHANNEL_NONE; pass++) {
+		for (t = 2; t-- > 0 && channel == TIMER_CHANNEL_NONE; ) {
+			if (!(timer_compare_timers & (1 << t)) || compareRunning(t) != (pass == 0))
+				continue;
+			channel = compareAttach(t, handler, first, owner);
+		}
+	}
+	__bis_SR_register(globalInterruptState);
+	return channel;
+}
+
+/* the timer and channel number of a compare channel, 0 if it is none */
+static uint8_t compareLocate(uint8_t channel, uint8_t *t, uint8_t *n)
+{
+	*t = (COMPARE1_CHANNELS && channel >= T1A0) ? 1 : 0;
+	*n = channel - compare_first[*t];
+	return *n < compare_channels[*t];
+}
+
+void timerCompareDetach(uint8_t channel)
+{
+	uint8_t t, n;
+	uint16_t globalInterruptState;
+
+	if (!compareLocate(channel, &t, &n))
+		return;
+	globalInterruptState = __read_status_register() & GIE;
+	__disable_interrupt();
+	if (compare_handler[COMPARE_SLOT(t, n)]) {
+		COMPARE_CCTL(t, n) = 0;
+		compare_handler[COMPARE_SLOT(t, n)] = 0;
+		timerRelease(channel, timerOwner(channel));
+		if (!compareRunning(t))
+			COMPARE_CTL(t) = 0;         // stop the timer with its last channel
+	}
+	__bis_SR_register(globalInterruptState);
+}
+
+void timerCompareService(uint8_t channel)
+{
+	uint8_t t, n;
+	uint16_t interval;
+
+	if (!compareLocate(channel, &t, &n) || !compare_handler[COMPARE_SLOT(t, n)])
+		return;
+	interval = compare_handler[COMPARE_SLOT(t, n)](channel);
+	if (interval)
+		COMPARE_CCR(t, n) += interval;
+	else
+		timerCompareDetach(channel);
+}
+
+__attribute__((interrupt(TIMER0_A0_VECTOR)))
+void TimerCompare0_ISR(void)
+{
+	timerCompareService(T0A0);
+}
+
+__attribute__((interrupt(TIMER0_A1_VECTOR)))
+void TimerCompare_ISR(void)
+{
+	uint8_t n = TA0IV >> 1;                 // reading TA0IV clears the flag
+
+	if (n && n < COMPARE0_CHANNELS)
+		timerCompareService(T0A0 + n);
+}
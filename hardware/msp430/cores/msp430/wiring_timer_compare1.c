@@ -0,0 +1,63 @@
+/*
+  ************************************************************************
+  *	wiring_timer_compare1.c
+  *
+  *	Timer1_A compare channels, added to the Timer0_A ones on request
+  *
+  ***********************************************************************
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General
+  Public License along with this library; if not, write to the
+  Free Software Foundation, Inc., 59 Temple Place, Suite 330,
+  Boston, MA  02111-1307  USA
+*/
+
+/*
+ * Kept apart from wiring_timer_compare.c so that the Timer1_A vectors are
+ * only linked in by sketches that call timerCompareUseTimer1(); tone() and
+ * Servo alone leave them to libraries such as IRremote. Parts without
+ * Timer1_A, or keeping millis() on it, stay on Timer0_A.
+ */
+
+#include "wiring_private.h"
+#include "pins_energia.h"
+
+#if TIMER_COMPARE1_CHANNELS && !(defined(TIMEBASE_TIMER) && TIMEBASE_TIMER == 1)
+
+void timerCompareUseTimer1(void)
+{
+	timer_compare_timers |= 1 << 1;
+}
+
+__attribute__((interrupt(TIMER1_A0_VECTOR)))
+void TimerCompare1_0_ISR(void)
+{
+	timerCompareService(T1A0);
+}
+
+__attribute__((interrupt(TIMER1_A1_VECTOR)))
+void TimerCompare1_ISR(void)
+{
+	uint8_t n = TA1IV >> 1;                 // reading TA1IV clears the flag
+
+	if (n && n < TIMER_COMPARE1_CHANNELS)
+		timerCompareService(T1A0 + n);
+}
+
+#else
+
+void timerCompareUseTimer1(void)
+{
+}
+
+#endif
@@ -174,11 +174,16 @@ void Screen_HX8353E::_fastFill(uint16_t x1, uint16_t y1, uint16_t x2, uint16_t y
     _setWindow(x1, y1, x2, y2);
     digitalWrite(_pinDataCommand, HIGH);
     digitalWrite(_pinChipSelect, LOW);
-    uint8_t hi = highByte(colour);
-    uint8_t lo = lowByte(colour);
-    for (uint32_t t=(uint32_t)(y2-y1+1)*(x2-x1+1); t>0; t--) {
-        SPI.transfer(hi);
-        SPI.transfer(lo);
+    // Send the colour from a short run of pixels rather than byte by byte
+    uint8_t run[32];
+    for (uint8_t i=0; i<sizeof(run); i+=2) {
+        run[i] = highByte(colour);
+        run[i+1] = lowByte(colour);
+    }
+    for (uint32_t t=2*(uint32_t)(y2-y1+1)*(x2-x1+1); t>0; ) {
+        uint16_t n = (t > sizeof(run)) ? sizeof(run) : t;
+        SPI.write(run, n);
+        t -= n;
     }
     digitalWrite(_pinChipSelect, HIGH);
 }
@@ -73,6 +73,15 @@ void LiquidCrystal::init(uint8_t fourbitmode, uint8_t rs, uint8_t rw, uint8_t en
     pinMode(_rw_pin, OUTPUT);
   }
   pinMode(_enable_pin, OUTPUT);
+
+#ifdef PORT_GROUP_AVAILABLE
+  // with all data pins on one port a nibble or byte is a single port write
+  if (portGroupInit(&_data_group, _data_pins, fourbitmode ? 4 : 8)) {
+    for (int i = 0; i < _data_group.count; i++) {
+      pinMode(_data_pins[i], OUTPUT);
+    }
+  }
+#endif
   
   if (fourbitmode)
     _displayfunction = LCD_4BITMODE | LCD_1LINE | LCD_5x8DOTS;
@@ -291,6 +300,14 @@ void LiquidCrystal::pulseEnable(void) {
 }
 
 void LiquidCrystal::write4bits(uint8_t value) {
+#ifdef PORT_GROUP_AVAILABLE
+  if (_data_group.port != NOT_A_PORT) {
+    portGroupWrite(&_data_group, value);
+    pulseEnable();
+    return;
+  }
+#endif
+
   for (int i = 0; i < 4; i++) {
     pinMode(_data_pins[i], OUTPUT);
     digitalWrite(_data_pins[i], (value >> i) & 0x01);
@@ -300,6 +317,14 @@ void LiquidCrystal::write4bits(uint8_t value) {
 }
 
 void LiquidCrystal::write8bits(uint8_t value) {
+#ifdef PORT_GROUP_AVAILABLE
+  if (_data_group.port != NOT_A_PORT) {
+    portGroupWrite(&_data_group, value);
+    pulseEnable();
+    return;
+  }
+#endif
+
   for (int i = 0; i < 8; i++) {
     pinMode(_data_pins[i], OUTPUT);
     digitalWrite(_data_pins[i], (value >> i) & 0x01);
@@ -27,14 +27,15 @@
 
 /*
  MSP430 Notes:
- This timer currently uses Timer1 available on chips like the MSP430G2553
- It uses CCR0 in interrupt mode with the same period as PWM so PWM is 
- still available for Timer1 which means pwm , analogWrite() is still available
- on the Timer1 associated pins.  We could have hacked into the watchdog timer
- which is used for millis() but that would have been a core change.
- 
- The MSP430/Energia Servo library uses Timer0 so this library should be able to 
- run concurrently with Servo.  
+ This timer takes one compare channel with timerCompareAttach(). The core
+ shares its compare timers between this library, tone() and Servo, so they
+ can run concurrently as long as a channel is free. The task timer asks for
+ Timer1_A first, as this library did before, so analogWrite() keeps PWM on
+ the Timer0_A pins (e.g. P1.2 and P1.6 on the MSP430G2553). While Timer1_A
+ runs compares its own pins (P2.1, P2.2, P2.4 and P2.5 there) lose PWM and
+ only go LOW up to half scale and HIGH above. If analogWrite() already
+ runs PWM on Timer1_A, Timer0_A is used instead, and if both do PWM,
+ start() returns false and no task is called.
  
  It will not run at the same time as the interrupt driven software serial library
  because that uses both timer interrupt vectors
@@ -42,9 +43,13 @@
  
 #include "Energia.h"
 #include "OneMsTaskTimer.h"
+#include "OneMsTaskLock.h"
 
-volatile int8_t overflowing;
 OneMsTaskTimer_t * p_initial_OneMsTaskTimer = 0;
+// deferred tasks waiting for run(), oldest first
+static OneMsTaskTimer_t * volatile p_pending_OneMsTaskTimer = 0;
+static OneMsTaskTimer_t * volatile p_last_pending_OneMsTaskTimer = 0;
+static volatile uint32_t tic_count = 0;
 
 #if defined(__MSP432P401R__)
 #include <driverlib/timer_a.h>
@@ -66,7 +71,7 @@ void OneMsTaskTimer_int(void);
 #define PWM_PERIOD F_CPU/1000
 
 
-void OneMsTaskTimer::start(uint32_t timer_index) {
+bool OneMsTaskTimer::start(uint32_t timer_index) {
   uint32_t load = (F_CPU / 1000);
   //// !!!! count = 0;
   const Timer_A_UpModeConfig timer_config = {
@@ -78,7 +83,6 @@ void OneMsTaskTimer::start(uint32_t timer_index) {
     TIMER_A_DO_CLEAR,
   };
   
-  overflowing = 0;
   // Base address for first timer
   if (timer_index == 0) g_ulBase = TIMER_A0_MODULE;
   if (timer_index == 1) g_ulBase = TIMER_A1_MODULE;
@@ -89,6 +93,7 @@ void OneMsTaskTimer::start(uint32_t timer_index) {
   Timer_A_configureUpMode(g_ulBase, &timer_config);
   Timer_A_startCounter(g_ulBase, TIMER_A_UP_MODE);  
   Timer_A_registerInterrupt(g_ulBase, TIMER_A_CCR0_INTERRUPT, OneMsTaskTimer_int);
+  return true;
 }
 
 // turn off the interrupts but don't turn of the timer because may
@@ -130,10 +135,9 @@ void OneMsTaskTimer_int(void);
 #define PWM_PERIOD F_CPU/1000
 
 
-void OneMsTaskTimer::start(uint32_t timer_index) {
+bool OneMsTaskTimer::start(uint32_t timer_index) {
   uint32_t load = (F_CPU / 1000);
   //// !!!! count = 0;
-  overflowing = 0;
   // Base address for first timer
   if (timer_index == 0) g_ulBase = TIMER32_0_MODULE;
   if (timer_index == 1) g_ulBase = TIMER32_1_MODULE;
@@ -146,6 +150,7 @@ void OneMsTaskTimer::start(uint32_t timer_index) {
   Timer32_startTimer(g_ulBase, false);  
   if (timer_index == 0) Timer32_registerInterrupt(TIMER32_0_INTERRUPT, OneMsTaskTimer_int);
   if (timer_index == 1) Timer32_registerInterrupt(TIMER32_1_INTERRUPT, OneMsTaskTimer_int);
+  return true;
 }
 
 // turn off the interrupts but don't turn of the timer because may
@@ -168,87 +173,37 @@ void OneMsTaskTimer_int(void)
 #if defined(__MSP430__)
 
 #define DEFAULT_TIMER 1
-uint32_t timer_index_ = DEFAULT_TIMER;
-
-//#if defined(__MSP430_HAS_T1A2__) || defined(__MSP430_HAS_T1A3__) || defined(__MSP430_HAS_T1A5__) || defined(__MSP430_HAS_T1A7__)
-	#if DEFAULT_TIMER == 0
-	#define TAxCCTL0 TA0CCTL0
-	#define TAxCCR0 TA0CCR0
-	#define TAxCTL TA0CTL
-	#define TIMERx_A0_VECTOR TIMER0_A0_VECTOR
-	#endif
-	#if DEFAULT_TIMER == 1
-	#define TAxCCTL0 TA1CCTL0
-	#define TAxCCR0 TA1CCR0
-	#define TAxCTL TA1CTL
-	#define TIMERx_A0_VECTOR TIMER1_A0_VECTOR
-	#endif
-	#if DEFAULT_TIMER == 2
-	#define TAxCCTL0 TA2CCTL0
-	#define TAxCCR0 TA2CCR0
-	#define TAxCTL TA2CTL
-	#define TIMERx_A0_VECTOR TIMER2_A0_VECTOR
-	#endif
-	#if DEFAULT_TIMER == 3
-	#define TAxCCTL0 TA3CCTL0
-	#define TAxCCR0 TA3CCR0
-	#define TAxCTL TA3CTL
-	#define TIMERx_A0_VECTOR TIMER3_A0_VECTOR
-	#endif
-	#if DEFAULT_TIMER == 4
-	#define TAxCCTL0 TA4CCTL0
-	#define TAxCCR0 TA4CCR0
-	#define TAxCTL TA4CTL
-	#define TIMERx_A0_VECTOR TIMER4_A0_VECTOR
-	#endif
-	#if DEFAULT_TIMER == 10
-	#define TAxCCTL0 TB0CCTL0
-	#define TAxCCR0 TB0CCR0
-	#define TAxCTL TB0CTL
-	#define TIMERx_A0_VECTOR TIMER0_B0_VECTOR
-	#endif
-//#else
-//#error Board not supported
-//#endif
-
+uint32_t timer_index_ = DEFAULT_TIMER; // not used, the tic comes from a core compare channel
 
-// lifted from wiring_analog.c so that the do not step on each other
-// there should probably be a processor check here but that also exists in MsTimer.h
-#define PWM_DIV ID__8
-#define PWM_PERIOD F_CPU/1000/8
+#define TIC_TICKS (TIMER_COMPARE_FREQ / 1000)
 
-#ifndef MC__UP
-#define MC__UP MC_1
-#endif
-#ifndef ID__8
-#define ID__8 ID_3
-#endif
+static uint8_t tic_channel = TIMER_CHANNEL_NONE;
 
+// Compare channel handler, called every TIC_TICKS
+static uint16_t OneMsTaskTimer_int(uint8_t channel)
+{
+  OneMsTaskTimer::_ticHandler();
+  return TIC_TICKS;
+}
 
-void OneMsTaskTimer::start(uint32_t timer_index) {
-  //// !!!! count = 0;
-  overflowing = 0;
-  // identical to the wiring_analog.c pwm setup so is compatible
-  TAxCCR0 = PWM_PERIOD;           // PWM Period
-  TAxCTL = TACLR | TASSEL_2 | MC__UP | PWM_DIV;            // SMCLK, up mode
-  TAxCCTL0 |= CCIE;                             // CCR0 interrupt enabled
+// The core shares its compare timers with tone() and Servo and takes
+// Timer1_A before Timer0_A, where PWM is more likely to be wanted (the
+// green LED on P1.6 of the MSP430G2 LaunchPad). Fails if every timer
+// does PWM or is busy otherwise.
+bool OneMsTaskTimer::start(uint32_t timer_index) {
+  if (tic_channel == TIMER_CHANNEL_NONE) {
+    timerCompareUseTimer1();
+    tic_channel = timerCompareAttach(OneMsTaskTimer_int, TIC_TICKS, TIMER_OWNER_TASK);
+  }
+  return tic_channel != TIMER_CHANNEL_NONE;
 }
 
-// turn off the interrupts but don't turn of the timer because may
-// be in use for pwm.
+// give the channel back, the timer stops with its last channel
 void OneMsTaskTimer::stop() {
-  // disable interrupt
-  TAxCCTL0 &= ~CCIE;
-  TAxCTL = 0;  
+  timerCompareDetach(tic_channel);
+  tic_channel = TIMER_CHANNEL_NONE;
 }
 
-// Timer interrupt service routine
-__attribute__((interrupt(TIMERx_A0_VECTOR)))
-void OneMsTaskTimer_int(void)
-{
-  OneMsTaskTimer::_ticHandler();
-}
-
 #endif //if defined(__MSP430__)
 
 
@@ -274,10 +229,9 @@ void OneMsTaskTimer_int(void);
 #define PWM_DIV 0
 #define PWM_PERIOD F_CPU/1000
 
-void OneMsTaskTimer::start(uint32_t timer_index) {
+bool OneMsTaskTimer::start(uint32_t timer_index) {
   uint32_t load = (F_CPU / 1000);
   //// !!!! count = 0;
-  overflowing = 0;
   // Base address for first timer
   g_ulBase = TIMERA0_BASE + (timer_index <<12);
   // Configuring the timers
@@ -292,6 +246,7 @@ void OneMsTaskTimer::start(uint32_t timer_index) {
   MAP_TimerLoadSet(g_ulBase,TIMER_A, load);
   // Enable the GPT 
   MAP_TimerEnable(g_ulBase,TIMER_A);
+  return true;
 }
 
 // turn off the interrupts but don't turn of the timer because may
@@ -340,10 +295,9 @@ void OneMsTaskTimer_int(void);
 #define PWM_DIV 0
 #define PWM_PERIOD F_CPU/1000
 
-void OneMsTaskTimer::start(uint32_t timer_index) {
+bool OneMsTaskTimer::start(uint32_t timer_index) {
   uint32_t load = (F_CPU / 1000);
   //// !!!! count = 0;
-  overflowing = 0;
   // Base address for first timer
   g_ulBase = getTimerBase(timerToOffset(timer_index));
   timerAB = TIMER_A << timerToAB(timer_index);
@@ -360,6 +314,7 @@ void OneMsTaskTimer::start(uint32_t timer_index) {
   ROM_TimerIntEnable(g_ulBase, TIMER_TIMA_TIMEOUT);
   ROM_TimerEnable(g_ulBase, TIMER_A);
   
+  return true;
 }
 
 // turn off the interrupts but don't turn of the timer because may
@@ -385,79 +340,163 @@ void OneMsTaskTimer_int(void)
 // Common Functions
 // ---------------------------------------------------------------------
 
+// Tasks are kept in a list sorted by absolute deadline (count), so the ISR
+// only looks at the head of the list and the tasks that actually expire.
+// add() and remove() lock out the timer ISR with taskLock(), which leaves
+// interrupts off again if the caller had them off (see OneMsTaskLock.h).
+
+// insert a task in deadline order, after the tasks with the same deadline
+static void insertTask(OneMsTaskTimer_t * task) {
+  OneMsTaskTimer_t * p_task = p_initial_OneMsTaskTimer;
+
+  if (p_task == 0 || (int32_t)(task->count - p_task->count) < 0){
+    task->nextTask = p_task;
+    p_initial_OneMsTaskTimer = task;
+  }else{
+    while (p_task->nextTask != 0 && (int32_t)(task->count - p_task->nextTask->count) >= 0){
+      p_task = p_task->nextTask;
+    }
+    task->nextTask = p_task->nextTask;
+    p_task->nextTask = task;
+  }
+  task->flags |= ONEMSTASK_SCHEDULED;
+}
+
+// unlink a task from the deadline list
+static void unlinkTask(OneMsTaskTimer_t * task) {
+  OneMsTaskTimer_t * p_task = p_initial_OneMsTaskTimer;
+
+  if (!(task->flags & ONEMSTASK_SCHEDULED))
+    return;
+  if (p_task == task){
+    p_initial_OneMsTaskTimer = task->nextTask;
+  }else{
+    while (p_task != 0 && p_task->nextTask != task){
+      p_task = p_task->nextTask;
+    }
+    if (p_task != 0)
+      p_task->nextTask = task->nextTask;
+  }
+  task->nextTask = 0;
+  task->flags &= ~ONEMSTASK_SCHEDULED;
+}
+
 void OneMsTaskTimer::set_timer_index(uint32_t timer_index) {
 	timer_index_ = timer_index;
 }
 
 // configure the registers
-void OneMsTaskTimer::start() {
-  OneMsTaskTimer::start(timer_index_);
+bool OneMsTaskTimer::start() {
+  return OneMsTaskTimer::start(timer_index_);
 }
 
 
-// add an additional task into the handler
+// add an additional task into the handler, periodic and called from the ISR
 void OneMsTaskTimer::add(OneMsTaskTimer_t * task) {
-  OneMsTaskTimer_t * p_task = p_initial_OneMsTaskTimer;
-  if (p_task == 0){
-	  p_initial_OneMsTaskTimer = task;
-  }else{
-	while (p_task->nextTask != 0){
-	  p_task = p_task->nextTask;
-	}
-	p_task->nextTask = task;
-  }
-  p_task = task;
-	
+  OneMsTaskTimer::add(task, 0);
+}
+
+// add a task (or re-arm one that is already added) with ONEMSTASK_* flags;
+// its first call is msecs from now
+void OneMsTaskTimer::add(OneMsTaskTimer_t * task, uint8_t flags) {
+  taskLockState state;
+
   // ensure save initialisation
   if (task->msecs == 0)
   	task->msecs = 1;
-  task->count = 0;
-  task->nextTask = 0;
+
+  state = taskLock();
+  unlinkTask(task);
+  task->flags = (task->flags & ONEMSTASK_RUNNING) | (flags & (ONEMSTASK_ONESHOT | ONEMSTASK_DEFERRED));
+  task->count = tic_count + task->msecs;
+  insertTask(task);
+  taskUnlock(state);
 }
 
-// removes an task from the handler
+// removes an task from the handler; a deferred call that is already
+// pending still runs once from run()
 void OneMsTaskTimer::remove(OneMsTaskTimer_t * task) {
+  taskLockState state = taskLock();
+
+  unlinkTask(task);
+  taskUnlock(state);
+}
+
+// call the deferred tasks that expired since the last call, from loop()
+void OneMsTaskTimer::run() {
   OneMsTaskTimer_t * p_task;
-  OneMsTaskTimer_t * p_nexttask;
-  p_nexttask = (OneMsTaskTimer_t *)p_initial_OneMsTaskTimer;
-  p_task = p_nexttask;
+  OneMsTaskTimer_t * p_next;
+  taskLockState state;
 
-  while (p_nexttask != task && p_nexttask != 0){
-    p_task = p_nexttask;
-    p_nexttask = p_task->nextTask;
-  }
-  if (p_nexttask != 0){
-	  if (p_nexttask == p_initial_OneMsTaskTimer){
-		  if (p_nexttask != 0){
-			  p_initial_OneMsTaskTimer = p_nexttask->nextTask;
-		  }else{
-			  p_initial_OneMsTaskTimer = 0;
-		  }
-	  }else{
-		  p_task->nextTask = p_nexttask->nextTask;
-	  }
+  // take the whole queue so tasks expiring meanwhile wait for the next run()
+  state = taskLock();
+  p_task = p_pending_OneMsTaskTimer;
+  p_pending_OneMsTaskTimer = 0;
+  p_last_pending_OneMsTaskTimer = 0;
+  taskUnlock(state);
+
+  while (p_task != 0){
+    p_next = p_task->nextPending;
+    p_task->pending = 0;
+    (*p_task->func)();
+    p_task = p_next;
   }
 }
 
+// ms since start() as counted by the task timer
+uint32_t OneMsTaskTimer::tics() {
+  uint32_t now;
+  taskLockState state = taskLock();
+
+  now = tic_count;
+  taskUnlock(state);
+  return now;
+}
+
 // called by the ISR every time we get an interrupt
 void OneMsTaskTimer::_ticHandler() {
-  OneMsTaskTimer_t * p_task = p_initial_OneMsTaskTimer;
-  
-  while (p_task != 0){
-    // It is a 1000hz interrupt so each interrupt is 1msec
-    p_task->count += 1;
-    if (p_task->count >= p_task->msecs && !overflowing) {
-      overflowing = 1;
-      // subtract ms to catch missed overflows. set to 0 if you don't want this.
-      // do this before running supplied function so don't take into account handler time
-      p_task->count = p_task->count - p_task->msecs; 
+  OneMsTaskTimer_t * p_task;
+  uint32_t now = ++tic_count; // It is a 1000hz interrupt so each interrupt is 1msec
+  uint32_t missed;
+
+  while ((p_task = p_initial_OneMsTaskTimer) != 0 && (int32_t)(now - p_task->count) >= 0){
+    p_initial_OneMsTaskTimer = p_task->nextTask;
+    p_task->flags &= ~ONEMSTASK_SCHEDULED;
+
+    if (!(p_task->flags & ONEMSTASK_ONESHOT)){
+      // the next deadline is based on the last one so the period does not
+      // drift; periods that are already over are skipped and counted
+      p_task->count += p_task->msecs;
+      if ((int32_t)(now - p_task->count) >= 0){
+        missed = (now - p_task->count) / p_task->msecs + 1;
+        p_task->overruns += missed;
+        p_task->count += missed * p_task->msecs;
+      }
+      insertTask(p_task);
+    }
+
+    if (p_task->flags & ONEMSTASK_DEFERRED){
+      // queue for run(); still queued from the last time is an overrun
+      if (p_task->pending){
+        p_task->overruns++;
+      }else{
+        p_task->pending = 1;
+        p_task->nextPending = 0;
+        if (p_last_pending_OneMsTaskTimer != 0)
+          p_last_pending_OneMsTaskTimer->nextPending = p_task;
+        else
+          p_pending_OneMsTaskTimer = p_task;
+        p_last_pending_OneMsTaskTimer = p_task;
+      }
+    }else if (p_task->flags & ONEMSTASK_RUNNING){
+      // the task's previous call has not returned yet (it re-enabled
+      // interrupts); only this task misses its turn
+      p_task->overruns++;
+    }else{
+      p_task->flags |= ONEMSTASK_RUNNING;
       // call the program supplied function
       (*p_task->func)();
-      overflowing = 0;
+      p_task->flags &= ~ONEMSTASK_RUNNING;
     }
-    p_task = (OneMsTaskTimer_t *)p_task->nextTask;
   }
 }
-
-
-
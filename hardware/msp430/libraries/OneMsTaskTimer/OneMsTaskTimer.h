@@ -27,14 +27,15 @@
 
 /*
  MSP430 Notes:
- This timer currently uses Timer1 available on chips like the MSP430G2553
- It uses CCR0 in interrupt mode with the same period as PWM so PWM is 
- still available for Timer1 which means pwm , analogWrite() is still available
- on the Timer1 associated pins.  We could have hacked into the watchdog timer
- which is used for millis() but that would have been a core change.
- 
- The MSP430/Energia Servo library uses Timer0 so this library should be able to 
- run concurrently with Servo.  
+ This timer takes one compare channel with timerCompareAttach(). The core
+ shares its compare timers between this library, tone() and Servo, so they
+ can run concurrently as long as a channel is free. The task timer asks for
+ Timer1_A first, as this library did before, so analogWrite() keeps PWM on
+ the Timer0_A pins (e.g. P1.2 and P1.6 on the MSP430G2553). While Timer1_A
+ runs compares its own pins (P2.1, P2.2, P2.4 and P2.5 there) lose PWM and
+ only go LOW up to half scale and HIGH above. If analogWrite() already
+ runs PWM on Timer1_A, Timer0_A is used instead, and if both do PWM,
+ start() returns false and no task is called.
  
  It will not run at the same time as the interrupt driven software serial library
  because that uses both timer interrupt vectors
@@ -57,8 +58,19 @@ How to use:
  
  Add a task to the list to be processed:
    OneMsTaskTimer::add(&myTask1); // 500ms period
+
+ Tasks are kept sorted by their next deadline, so each 1ms interrupt only
+ handles the tasks that are due. A task is added with optional flags:
+   OneMsTaskTimer::add(&myTask2, ONEMSTASK_ONESHOT);  // once, msecs from now
+   OneMsTaskTimer::add(&myTask3, ONEMSTASK_DEFERRED); // periodic, called from run()
+ Adding a task again re-arms it. Deferred tasks are not called in the ISR;
+ loop() calls them by calling:
+   OneMsTaskTimer::run();
+ myTask.overruns counts the calls a task missed: periods that were already
+ over, a deferred call still waiting for run(), or a callback that was still
+ running when its next deadline came.
   
- Then start the timer:
+ Then start the timer, which returns false if it found no timer to run on:
    OneMsTaskTimer::start();
  To Stop the timer call:
    void stop();
@@ -69,10 +81,8 @@ How to use:
   When getting problems that a timer is used by another function already, a different
   Timer can be selected with:  
    void set_timer_index(uint32_t timer_index);
-  Note: this function is not available for the MSP430. For this architecture the timer module
-        can only be changed by modifing the define:
-        #define DEFAULT_TIMER TIMER_A0_MODULE
-		in the library source file
+  Note: this function has no effect on the MSP430, where the core hands out
+        the compare channel; timerOwner() tells which feature holds which timer.
 
 */
 
@@ -82,20 +92,31 @@ How to use:
 
 #include <stdint.h>
 
+#define ONEMSTASK_ONESHOT   0x01  // call once, msecs after add()
+#define ONEMSTASK_DEFERRED  0x02  // call from OneMsTaskTimer::run() instead of the ISR
+#define ONEMSTASK_SCHEDULED 0x40  // internal
+#define ONEMSTASK_RUNNING   0x80  // internal
+
 typedef struct OneMsTaskTimer_t{
     uint32_t msecs;
     void (*func)();
     uint32_t count;
     OneMsTaskTimer_t * nextTask;
+    uint16_t overruns;
+    uint8_t flags;
+    volatile uint8_t pending;
+    OneMsTaskTimer_t * nextPending;
 } OneMsTaskTimer_t;
 
 
 namespace OneMsTaskTimer {
-//	extern volatile int8_t overflowing;
 	void add(OneMsTaskTimer_t * task);
+	void add(OneMsTaskTimer_t * task, uint8_t flags);
 	void remove(OneMsTaskTimer_t * task);
-	void start();
-	void start(uint32_t timer_index);
+	void run();
+	uint32_t tics();
+	bool start();                           // false if no timer was free
+	bool start(uint32_t timer_index);
 	void stop();
 	void set_timer_index(uint32_t timer_index);
 	void _ticHandler();
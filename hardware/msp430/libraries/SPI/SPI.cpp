@@ -17,3 +17,125 @@
 
 SPIClass SPI;
 
+uint8_t SPIClass::currentMode = 0xFF;
+uint8_t SPIClass::currentDivider = 0xFF;
+uint8_t SPIClass::currentBitOrder = 0xFF;
+
+SPITransaction *SPIClass::queueHead;
+SPITransaction * volatile SPIClass::queueActive;
+SPIDevice *SPIClass::queueHeld;
+volatile uint8_t SPIClass::queueRunning;
+
+/*
+ * Transaction queue. Where the part has DMA, larger transactions run on
+ * DMA and the next one is started from the completion interrupt; the
+ * rest run to completion inside queue() or the callback that queued them.
+ */
+void SPIClass::attachDevice(SPIDevice *device)
+{
+    pinMode(device->csPin, OUTPUT);
+    digitalWrite(device->csPin, HIGH);
+}
+
+void SPIClass::queue(SPITransaction *t)
+{
+    SPITransaction **link, **after = 0;
+    bool start = false;
+
+    t->done = 0;
+
+    uint16_t globalInterruptState = __read_status_register() & GIE;
+    __disable_interrupt();
+    // Behind everything of the same or higher priority, but straight
+    // after the device's own transactions if it has some queued there
+    for (link = &queueHead; *link && (*link)->device->priority >= t->device->priority; link = &(*link)->next) {
+        if ((*link)->device == t->device)
+            after = &(*link)->next;
+    }
+    if (after)
+        link = after;
+    t->next = *link;
+    *link = t;
+    if (!queueRunning) {
+        queueRunning = 1;
+        start = true;
+    }
+    __bis_SR_register(globalInterruptState);
+
+    if (start)
+        runQueue();
+}
+
+void SPIClass::runQueue()
+{
+    SPITransaction *t, **link;
+
+    for (;;) {
+        uint16_t globalInterruptState = __read_status_register() & GIE;
+        __disable_interrupt();
+        // while chip select is held only that device may use the bus
+        for (link = &queueHead; *link && queueHeld && (*link)->device != queueHeld; link = &(*link)->next)
+            ;
+        t = *link;
+        if (t)
+            *link = t->next;
+        else
+            queueRunning = 0;
+        __bis_SR_register(globalInterruptState);
+        if (!t)
+            return;
+
+        applyDevice(t->device);
+        if (queueHeld != t->device)
+            digitalWrite(t->device->csPin, LOW);
+        queueActive = t;
+        if (startTransaction(t))
+            return; // finished from the DMA interrupt
+        finishTransaction(t);
+    }
+}
+
+void SPIClass::applyDevice(SPIDevice *device)
+{
+    if (device->dataMode != currentMode)
+        setDataMode(device->dataMode);
+    if (device->clockDivider != currentDivider)
+        setClockDivider(device->clockDivider);
+    if (device->bitOrder != currentBitOrder)
+        setBitOrder(device->bitOrder);
+}
+
+bool SPIClass::startTransaction(SPITransaction *t)
+{
+#ifdef SPI_DMA_AVAILABLE
+    if (t->count >= SPI_DMA_MIN_SIZE
+        && spi_dma_start((t->flags & SPI_TX_ONLY) ? 0 : t->buf, t->buf, t->count, dmaDone))
+        return true;
+#endif
+    if (t->flags & SPI_TX_ONLY)
+        spi_write(t->buf, t->count);
+    else
+        spi_transfer(t->buf, t->count);
+    return false;
+}
+
+void SPIClass::finishTransaction(SPITransaction *t)
+{
+    queueActive = 0;
+    if (t->flags & SPI_KEEP_CS) {
+        queueHeld = t->device;
+    } else {
+        digitalWrite(t->device->csPin, HIGH);
+        queueHeld = 0;
+    }
+    t->done = 1;
+    if (t->callback)
+        t->callback(t);
+}
+
+void SPIClass::dmaDone()
+{
+    finishTransaction(queueActive);
+    runQueue();
+}
+
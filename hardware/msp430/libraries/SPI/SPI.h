@@ -26,9 +26,70 @@
 #define SPI_MODE2 2
 #define SPI_MODE3 4
 
+/*
+ * Transaction queue for devices sharing the bus. Transactions run in
+ * order of device priority, those of one device are kept together, and
+ * the bus is only reconfigured when the settings change. Chip select is
+ * driven low for the transaction and high after it, unless SPI_KEEP_CS
+ * asks to hold it for the device's next transaction. The callback runs
+ * from the completion interrupt where the bus is interrupt or DMA driven.
+ * Do not call transfer() while the queue is busy.
+ */
+#define SPI_QUEUE_AVAILABLE
+
+#define SPI_TX_ONLY 0x01	// leave buf alone and drop the bytes received
+#define SPI_KEEP_CS 0x02	// keep chip select low after the transaction
+
+struct SPIDevice {
+  uint8_t csPin;
+  uint8_t dataMode;
+  uint8_t clockDivider;
+  uint8_t bitOrder;
+  uint8_t priority;	// higher runs first
+};
+
+struct SPITransaction {
+  SPIDevice *device;
+  uint8_t *buf;		// sent, then overwritten with the bytes received
+	uint16_t count;
+  uint8_t flags;
+  void (*callback)(SPITransaction *);
+  volatile uint8_t done;
+  SPITransaction *next;
+};
+
 class SPIClass {
+private:
+  static uint8_t currentMode;
+  static uint8_t currentDivider;
+  static uint8_t currentBitOrder;
+
+  static SPITransaction *queueHead;
+  static SPITransaction * volatile queueActive;
+  static SPIDevice *queueHeld;
+  static volatile uint8_t queueRunning;
+
+  static void runQueue();
+  static void applyDevice(SPIDevice *device);
+  static bool startTransaction(SPITransaction *t);
+  static void finishTransaction(SPITransaction *t);
+  static void dmaDone();
+
 public:
   inline static uint8_t transfer(uint8_t _data);
+  // Sends count bytes from buf and stores the bytes received in their place
+  inline static void transfer(void *buf, size_t count);
+  // Sends count bytes from buf and drops what comes back
+  inline static void write(const void *buf, size_t count);
+#ifdef SPI_DMA_AVAILABLE
+  // As above, but return at once and call callback from the DMA
+  // interrupt when done; wait with busy() before touching buf again.
+  // If the DMA channels are taken the bytes are moved before returning
+  // and callback is called from here.
+  inline static void transferAsync(void *buf, size_t count, void (*callback)(void));
+  inline static void writeAsync(const void *buf, size_t count, void (*callback)(void));
+  inline static bool busy();
+#endif
 
   // SPI Configuration methods
 
@@ -41,6 +102,10 @@ public:
 
   inline static void attachInterrupt();
   inline static void detachInterrupt();
+
+  static void attachDevice(SPIDevice *device);
+  static void queue(SPITransaction *t);
+  inline static bool queueBusy();
 };
 
 extern SPIClass SPI;
@@ -49,9 +114,56 @@ uint8_t SPIClass::transfer(uint8_t _data) {
     return spi_send(_data);
 }
 
+void SPIClass::transfer(void *buf, size_t count) {
+#ifdef SPI_DMA_AVAILABLE
+    if (count >= SPI_DMA_MIN_SIZE && spi_dma_start((uint8_t *)buf, (const uint8_t *)buf, count, 0)) {
+        while (spi_dma_busy())
+            ;
+        return;
+    }
+#endif
+    spi_transfer((uint8_t *)buf, count);
+}
+
+void SPIClass::write(const void *buf, size_t count) {
+#ifdef SPI_DMA_AVAILABLE
+    if (count >= SPI_DMA_MIN_SIZE && spi_dma_start(0, (const uint8_t *)buf, count, 0)) {
+        while (spi_dma_busy())
+            ;
+        return;
+    }
+#endif
+    spi_write((const uint8_t *)buf, count);
+}
+
+#ifdef SPI_DMA_AVAILABLE
+void SPIClass::transferAsync(void *buf, size_t count, void (*callback)(void)) {
+    if (!spi_dma_start((uint8_t *)buf, (const uint8_t *)buf, count, callback)) {
+        spi_transfer((uint8_t *)buf, count); // DMA channels taken
+        if (callback)
+            callback();
+    }
+}
+
+void SPIClass::writeAsync(const void *buf, size_t count, void (*callback)(void)) {
+    if (!spi_dma_start(0, (const uint8_t *)buf, count, callback)) {
+        spi_write((const uint8_t *)buf, count);
+        if (callback)
+            callback();
+    }
+}
+
+bool SPIClass::busy() {
+    return spi_dma_busy();
+}
+#endif
+
 void SPIClass::begin()
 {
     spi_initialize();
+    currentMode = 0xFF;
+    currentDivider = 0xFF;
+    currentBitOrder = 0xFF;
 }
 
 void SPIClass::end()
@@ -62,16 +174,23 @@ void SPIClass::end()
 void SPIClass::setBitOrder(uint8_t bitOrder)
 {
     spi_set_bitorder(bitOrder);
+    currentBitOrder = bitOrder;
 }
 
 void SPIClass::setDataMode(uint8_t mode)
 {
     spi_set_datamode(mode);
+    currentMode = mode;
 }
 
 void SPIClass::setClockDivider(uint8_t rate)
 {
     spi_set_divisor(rate);
+    currentDivider = rate;
+}
+
+bool SPIClass::queueBusy() {
+    return queueRunning;
 }
 
 void SPIClass::attachInterrupt() {
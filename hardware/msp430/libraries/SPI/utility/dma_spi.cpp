@@ -0,0 +1,126 @@
+/**
+ * File: dma_spi.cpp - msp430 DMA driven SPI transfers
+ *
+ * spi abstraction api for msp430
+ *
+ * This file is free software; you can redistribute it and/or modify
+ * it under the terms of either the GNU General Public License version 2
+ * or the GNU Lesser General Public License version 2.1, both as
+ * published by the Free Software Foundation.
+ *
+ */
+
+#include <msp430.h>
+#include <stdint.h>
+#include <Energia.h>
+#include "spi_430.h"
+
+#ifdef SPI_DMA_AVAILABLE
+
+/**
+ * DMA triggers 18 and 19 are UCB0RXIFG and UCB0TXIFG on the F5xx, FR5xx
+ * and FR6xx parts. A board using another module can override them.
+ */
+#ifndef SPI_DMA_RX_TRIGGER
+#define SPI_DMA_RX_TRIGGER 18
+#endif
+#ifndef SPI_DMA_TX_TRIGGER
+#define SPI_DMA_TX_TRIGGER 19
+#endif
+
+#define SPI_DMA_RX 1
+#define SPI_DMA_TX 2
+
+#if defined(UCB0STATW_) || defined(UCB0STATW)
+#define SPI_BUSY() (UCB0STATW & UCBUSY)
+#else
+#define SPI_BUSY() (UCB0STAT & UCBUSY)
+#endif
+
+static uint8_t spi_dma_sink;
+static const uint8_t spi_dma_fill = 0;
+static volatile uint8_t spi_dma_active;
+static void (* volatile spi_dma_callback)(void);
+
+static void spi_dma_finish(void)
+{
+	dmaRelease(SPI_DMA_TX);
+	dmaRelease(SPI_DMA_RX);
+	spi_dma_active = 0;
+}
+
+static void spi_dma_done(uint8_t channel)
+{
+	void (*callback)(void) = spi_dma_callback;
+
+	spi_dma_callback = 0;
+	spi_dma_finish();
+	if (callback)
+		callback();
+}
+
+/**
+ * spi_dma_start() - receive on channel 1 and transmit on channel 2.
+ *
+ * Both channels are edge triggered, so RXIFG is cleared first and the
+ * first byte is written by hand; its move into the shift register raises
+ * TXIFG and the transmit channel takes it from there. Channel 1 has the
+ * higher priority, so a received byte is always stored before the next
+ * one can overrun it. tx may be NULL to send zeros. Returns 0, and
+ * leaves the transfer to the caller, if the channels are taken.
+ */
+uint8_t spi_dma_start(uint8_t *rx, const uint8_t *tx, uint16_t count, void (*callback)(void))
+{
+	if (!count)
+		return 0;
+
+	while (spi_dma_busy())
+		; // wait for an earlier transfer
+	while (SPI_BUSY())
+		; // and for a byte sent with spi_send()
+
+	if (!dmaClaim(SPI_DMA_RX, SPI_DMA_RX_TRIGGER, spi_dma_done))
+		return 0;
+	if (count > 1 && !dmaClaim(SPI_DMA_TX, SPI_DMA_TX_TRIGGER, 0)) {
+		dmaRelease(SPI_DMA_RX);
+		return 0;
+	}
+
+	spi_dma_callback = callback;
+	spi_dma_active = 1;
+	(void)UCB0RXBUF; // clear RXIFG
+
+	__data16_write_addr((unsigned short) &DMA1SA, (unsigned long) &UCB0RXBUF);
+	__data16_write_addr((unsigned short) &DMA1DA, (unsigned long) (rx ? rx : &spi_dma_sink));
+	DMA1SZ = count;
+	DMA1CTL = DMADT_0 + DMASRCINCR_0 + (rx ? DMADSTINCR_3 : DMADSTINCR_0) + DMASBDB
+		+ (callback ? DMAIE : 0) + DMAEN;
+
+	if (count > 1) {
+		__data16_write_addr((unsigned short) &DMA2SA, (unsigned long) (tx ? tx + 1 : &spi_dma_fill));
+		__data16_write_addr((unsigned short) &DMA2DA, (unsigned long) &UCB0TXBUF);
+		DMA2SZ = count - 1;
+		DMA2CTL = DMADT_0 + (tx ? DMASRCINCR_3 : DMASRCINCR_0) + DMADSTINCR_0 + DMASBDB + DMAEN;
+	}
+
+	UCB0TXBUF = tx ? tx[0] : spi_dma_fill;
+	return 1;
+}
+
+/**
+ * spi_dma_busy() - non-zero until the last byte has been received
+ *
+ * A transfer without callback has no interrupt, its channels are given
+ * back here once channel 1 is done.
+ */
+uint8_t spi_dma_busy(void)
+{
+	uint16_t globalInterruptState = __read_status_register() & GIE;
+
+	__disable_interrupt();
+	if (spi_dma_active && !spi_dma_callback && !(DMA1CTL & DMAEN))
+		spi_dma_finish();
+	__bis_SR_register(globalInterruptState);
+	return spi_dma_active;
+}
+#endif
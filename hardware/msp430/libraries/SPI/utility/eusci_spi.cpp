@@ -94,6 +94,63 @@ uint8_t spi_send(const uint8_t _data)
 	return UCB0RXBUF;
 }
 
+/**
+ * spi_transfer() - send count bytes from buf, replacing each with the
+ * byte received. The next byte waits in TXBUF while the current one
+ * shifts, so there are no gaps in the clock between bytes.
+ */
+void spi_transfer(uint8_t *buf, uint16_t count)
+{
+	uint16_t globalInterruptState = __read_status_register() & GIE;
+	uint16_t i;
+
+	if (!count)
+		return;
+
+	/* Wait for previous tx to complete. */
+	while (UCB0STATW & UCBUSY)
+		;
+	/* Clear RXIFG. */
+	(void)UCB0RXBUF;
+
+	UCB0TXBUF = buf[0];
+	for (i = 1; i < count; i++) {
+		/* Queue byte i, then collect byte i - 1 before byte i is
+		 * in. Interrupts are held off in between so RXBUF cannot
+		 * overrun. */
+		__disable_interrupt();
+		while (!(UCB0IFG & UCTXIFG))
+			;
+		UCB0TXBUF = buf[i];
+		while (!(UCB0IFG & UCRXIFG))
+			;
+		buf[i - 1] = UCB0RXBUF;
+		__bis_SR_register(globalInterruptState);
+	}
+	while (!(UCB0IFG & UCRXIFG))
+		;
+	buf[count - 1] = UCB0RXBUF;
+}
+
+/**
+ * spi_write() - send count bytes from buf and drop what comes back.
+ */
+void spi_write(const uint8_t *buf, uint16_t count)
+{
+	while (count--) {
+		while (!(UCB0IFG & UCTXIFG))
+			;
+		UCB0TXBUF = *buf++;
+	}
+
+	/* Wait for the last byte to shift out. */
+	while (UCB0STATW & UCBUSY)
+		;
+
+	/* Clear RXIFG and the overrun flag. */
+	(void)UCB0RXBUF;
+}
+
 /***SPI_MODE_0
  * spi_set_divisor() - set new clock divider for USCI.
  *
@@ -46,5 +46,25 @@ uint8_t spi_send(const uint8_t);
 void spi_set_bitorder(const uint8_t);
 void spi_set_datamode(const uint8_t);
 void spi_set_divisor(const uint16_t clkdivider);
+void spi_transfer(uint8_t *buf, uint16_t count);
+void spi_write(const uint8_t *buf, uint16_t count);
+
+/*
+ * USCI_B0/EUSCI_B0 parts with a DMA controller can run a transfer on DMA
+ * channels 1 (receive) and 2 (transmit), claimed from the core with
+ * dmaClaim() for the length of the transfer; channel 0 is left to
+ * USBSerial. rx may be NULL to drop the received bytes and tx NULL to
+ * send zeros. The callback runs from the DMA interrupt once the last
+ * byte has been received. spi_dma_start() returns 0 if the channels are
+ * taken, the caller then moves the bytes itself.
+ */
+#if (defined(__MSP430_HAS_DMAX_3__) || defined(__MSP430_HAS_DMAX_6__)) && !defined(__MSP430_HAS_USI__)
+#define SPI_DMA_AVAILABLE
+#ifndef SPI_DMA_MIN_SIZE
+#define SPI_DMA_MIN_SIZE 16
+#endif
+uint8_t spi_dma_start(uint8_t *rx, const uint8_t *tx, uint16_t count, void (*callback)(void));
+uint8_t spi_dma_busy(void);
+#endif
 
 #endif /*_SPI_430_H_*/
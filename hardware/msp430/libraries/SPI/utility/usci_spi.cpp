@@ -92,6 +92,68 @@ uint8_t spi_send(const uint8_t _data)
 	return UCB0RXBUF; // reading clears RXIFG flag
 }
 
+#if defined(UCB0IFG_) || defined(UCB0IFG)
+#define SPI_IFG UCB0IFG
+#define SPI_RXIFG UCRXIFG
+#define SPI_TXIFG UCTXIFG
+#else
+#define SPI_IFG IFG2
+#define SPI_RXIFG UCB0RXIFG
+#define SPI_TXIFG UCB0TXIFG
+#endif
+
+/**
+ * spi_transfer() - send count bytes from buf, replacing each with the
+ * byte received. The next byte waits in TXBUF while the current one
+ * shifts, so there are no gaps in the clock between bytes.
+ */
+void spi_transfer(uint8_t *buf, uint16_t count)
+{
+	uint16_t globalInterruptState = __read_status_register() & GIE;
+	uint16_t i;
+
+	if (!count)
+		return;
+
+	while (UCB0STAT & UCBUSY)
+		; // wait for SPI TX/RX to finish
+	(void)UCB0RXBUF; // clear RXIFG
+
+	UCB0TXBUF = buf[0];
+	for (i = 1; i < count; i++) {
+		// Queue byte i, then collect byte i - 1 before byte i is
+		// in. Interrupts are held off in between so RXBUF cannot
+		// overrun.
+		__disable_interrupt();
+		while (!(SPI_IFG & SPI_TXIFG))
+			;
+		UCB0TXBUF = buf[i];
+		while (!(SPI_IFG & SPI_RXIFG))
+			;
+		buf[i - 1] = UCB0RXBUF;
+		__bis_SR_register(globalInterruptState);
+	}
+	while (!(SPI_IFG & SPI_RXIFG))
+		;
+	buf[count - 1] = UCB0RXBUF;
+}
+
+/**
+ * spi_write() - send count bytes from buf and drop what comes back
+ */
+void spi_write(const uint8_t *buf, uint16_t count)
+{
+	while (count--) {
+		while (!(SPI_IFG & SPI_TXIFG))
+			;
+		UCB0TXBUF = *buf++;
+	}
+	while (UCB0STAT & UCBUSY)
+		; // wait for SPI TX/RX to finish
+
+	(void)UCB0RXBUF; // clear RXIFG and the overrun flag
+}
+
 /***SPI_MODE_0
  * spi_set_divisor() - set new clock divider for USCI
  *
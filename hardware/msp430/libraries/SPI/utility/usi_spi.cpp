@@ -87,6 +87,29 @@ uint8_t spi_send(const uint8_t _data)
     return USISRL; // reading clears RXIFG flag
 }
 
+/**
+ * spi_transfer() - send count bytes from buf, replacing each with the
+ * byte received. USI has no transmit buffer, so this is spi_send() in a
+ * loop without the call per byte from the sketch.
+ */
+void spi_transfer(uint8_t *buf, uint16_t count)
+{
+    while (count--) {
+        *buf = spi_send(*buf);
+        buf++;
+    }
+}
+
+/**
+ * spi_write() - send count bytes from buf and drop what comes back
+ */
+void spi_write(const uint8_t *buf, uint16_t count)
+{
+    while (count--) {
+        spi_send(*buf++);
+    }
+}
+
 /**
  * spi_set_divisor() - set new clock divider for USI
  *
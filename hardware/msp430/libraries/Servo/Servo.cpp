@@ -44,16 +44,14 @@ static unsigned int ServoCount = 0; // the total number of attached servos
 
 static volatile int counter = 0; // Servo counter; -1 before first servo starts being serviced
 static volatile unsigned int totalWait = 0; // Total amount waited so far in the current period; after all servos, wait for the rest of REFRESH_INTERVAL
+static uint8_t servoChannel = TIMER_CHANNEL_NONE; // compare channel all servos are sequenced on
 
-#ifndef TIMERA0_VECTOR
-#define TIMERA0_VECTOR TIMER0_A0_VECTOR
-#endif /* TIMER0_A0_VECTOR */
-
-// Timer A0 interrupt service routine
-static void inline
-Timer_A(void)
+// Compare channel handler: ends the pulse of one servo, starts the next
+// and returns its length, or the rest of REFRESH_INTERVAL after the last
+static uint16_t
+Timer_A(uint8_t channel)
 {
-  static unsigned long wait;
+  unsigned long wait;
   if (counter >= 0) {
     /* Turn pulse off. */
     digitalWrite(servos[counter].Pin.nbr, LOW);
@@ -72,22 +70,13 @@ Timer_A(void)
     digitalWrite(servos[counter].Pin.nbr, HIGH);
     /* And hold! */
     totalWait += servos[counter].ticks;
-    TA0CCR0 = servos[counter].ticks;
-  } else {
-    /* Wait for the remaining of REFRESH_INTERVAL. */
-    wait = usToTicks(REFRESH_INTERVAL) - totalWait;
-    totalWait = 0;
-    TA0CCR0 = (wait < 1000 ? 1000 : wait);
-    counter = -1;
+    return servos[counter].ticks;
   }
-}
-
-// Timer A0 interrupt service routine
-__attribute__((interrupt(TIMERA0_VECTOR)))
-static void
-Timer_A_int(void)
-{
-  Timer_A();
+  /* Wait for the remaining of REFRESH_INTERVAL. */
+  wait = usToTicks(REFRESH_INTERVAL) - totalWait;
+  totalWait = 0;
+  counter = -1;
+  return (wait < 1000 ? 1000 : wait);
 }
 
 static boolean isTimerActive(void)
@@ -99,22 +88,22 @@ static boolean isTimerActive(void)
   return false;
 }
 
-static void enableTimer(void)
+static boolean enableTimer(void)
 {
   counter = -1;
   totalWait = 0;
 
-  Timer_A(); // enable first servo
-
-  TA0CCTL0 = CCIE;                             // CCR0 interrupt enabled
-  TA0CTL = TASSEL_2 + MC_1 + ID_3;           // prescale SMCLK/8, upmode
+  // first pulse after the minimum wait, the timer is shared with tone() and others
+  servoChannel = timerCompareAttach(Timer_A, 1000, TIMER_OWNER_SERVO);
+  return servoChannel != TIMER_CHANNEL_NONE;
 }
 
 static void disableTimer(void)
 {
-  // disable interrupt
-  TA0CCTL0 = 0;
-  TA0CCR0 = 0;
+  timerCompareDetach(servoChannel);
+  servoChannel = TIMER_CHANNEL_NONE;
+  if (counter >= 0)                            // a pulse may have been running
+    digitalWrite(servos[counter].Pin.nbr, LOW);
 }
 
 
@@ -146,15 +135,17 @@ uint8_t Servo::attach(int pin, int min, int max)
     this->max  = (MAX_PULSE_WIDTH - max)/4; 
 
     boolean timer_active = isTimerActive();
+    if (!timer_active && !enableTimer())
+      return INVALID_SERVO;                                 // no free compare channel
     servos[this->servoIndex].Pin.isActive = true;
-    if (!timer_active)
-      enableTimer();
   } 
   return this->servoIndex ;
 }
 
 void Servo::detach()  
 {
+  if (!servos[this->servoIndex].Pin.isActive)
+    return;
   servos[this->servoIndex].Pin.isActive = false;
   if (!isTimerActive())
     disableTimer();
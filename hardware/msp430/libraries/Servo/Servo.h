@@ -33,12 +33,13 @@
  */
 
 /*
-  Note that the Servo uses TIMER0_A, which cannot be used for other
-  purposes, e.g. for TimerSerial.
-
-  XXX: Also, some pins reused by TIMER0_A may be affected by this
-  library, but I do not understand the datasheet enough regarding this.
-  Most likely, you should avoid PWM on pin 2? (And other stuff too?)
+  All servos are pulsed one after the other from a single compare channel,
+  taken with timerCompareAttach() while any servo is attached: of TIMER0_A,
+  or of TIMER1_A once OneMsTaskTimer has started. The other channels stay
+  free for tone() and OneMsTaskTimer. attach() returns INVALID_SERVO if no
+  channel is free, e.g. while analogWrite() runs PWM on a pin of each of
+  these timers; TimerSerial can not be used at the same time.
+  MAX_SERVOS pulses of up to MAX_PULSE_WIDTH fit in one REFRESH_INTERVAL.
  */
 
 #define Servo_VERSION           2      // software version of this library
@@ -66,7 +67,7 @@ class Servo
 {
 public:
   Servo();
-  uint8_t attach(int pin);           // attach the given pin to the next free channel, sets pinMode, returns channel number or 0 if failure
+  uint8_t attach(int pin);           // attach the given pin to the next free channel, sets pinMode, returns channel number or INVALID_SERVO if failure
   uint8_t attach(int pin, int min, int max); // as above but also sets min and max values for writes. 
   void detach();
   void write(int value);             // if value is < 200 its treated as an angle, otherwise as pulse width in microseconds 
@@ -0,0 +1,58 @@
+// Wire Master Queue
+
+// Demonstrates use of the Wire library
+// Reads a register from several I2C/TWI slave devices without waiting
+// for the bus: each read is queued as a write of the register number
+// followed by a repeated start and a read, and loop() keeps running
+// while the transfers go on in the background.
+
+// This example code is in the public domain.
+
+
+#include <Wire.h>
+
+#define SENSORS 3
+
+uint8_t sensorAddress[SENSORS] = { 0x48, 0x49, 0x4A };
+uint8_t registerNumber = 0x00;           // register to read from each sensor
+uint8_t reading[SENSORS][2];
+WireTransaction transaction[SENSORS];
+
+void setup()
+{
+  Wire.begin();        // join i2c bus (address optional for master)
+  Serial.begin(9600);  // start serial for output
+
+  for (int i = 0; i < SENSORS; i++) {
+    transaction[i].address = sensorAddress[i];
+    transaction[i].txBuffer = &registerNumber;
+    transaction[i].txLength = 1;
+    transaction[i].rxBuffer = reading[i];
+    transaction[i].rxLength = 2;
+    transaction[i].callback = NULL;  // poll done instead
+  }
+}
+
+void loop()
+{
+  for (int i = 0; i < SENSORS; i++) {
+    Wire.queue(&transaction[i]);     // returns at once
+  }
+
+  // ... other work can run here while the sensors are read ...
+
+  for (int i = 0; i < SENSORS; i++) {
+    while (!transaction[i].done);
+    Serial.print("sensor ");
+    Serial.print(i);
+    if (transaction[i].status == 0) {
+      Serial.print(": ");
+      Serial.println((reading[i][0] << 8) | reading[i][1]);
+    } else {
+      Serial.print(" error ");
+      Serial.println(transaction[i].status);
+    }
+  }
+
+  delay(500);
+}
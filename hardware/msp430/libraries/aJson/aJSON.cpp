@@ -37,6 +37,7 @@
 #include <float.h>
 #include <ctype.h>
 #include <avr/pgmspace.h>
+#include "atof.h"
 
 #include "aJSON.h"
 #include "utility/stringbuffer.h"
@@ -207,12 +208,18 @@ aJsonClass::deleteItem(aJsonObject *c)
     }
 }
 
+// significant digits gathered for a double, later ones only move the scale
+#define MAX_MANTISSA_DIGITS 9
+
 // Parse the input text to generate a number, and populate the result into item.
 int
 aJsonStream::parseNumber(aJsonObject *item)
 {
   int i = 0;
   int sign = 1;
+  unsigned long mantissa = 0; // the digits as an integer, in case it is a double
+  int digits = 0;
+  int scale = 0;
 
   int in = this->getch();
   if (in == EOF)
@@ -235,6 +242,14 @@ aJsonStream::parseNumber(aJsonObject *item)
     do
       {
         i = (i * 10) + (in - '0');
+        if (digits < MAX_MANTISSA_DIGITS)
+          {
+            mantissa = (mantissa * 10) + (in - '0');
+            if (mantissa)
+              digits++;
+          }
+        else
+          scale++;
         in = this->getch();
       }
     while (in >= '0' && in <= '9'); // Number?
@@ -247,19 +262,22 @@ aJsonStream::parseNumber(aJsonObject *item)
   //ok it seems to be a double
   else
     {
-      double n = (double) i;
-      int scale = 0;
+      double n;
       int subscale = 0;
       char signsubscale = 1;
       if (in == '.')
         {
           in = this->getch();
-          do
+          while (in >= '0' && in <= '9')
             {
-              n = (n * 10.0) + (in - '0'), scale--;
+              if (digits < MAX_MANTISSA_DIGITS)
+                {
+                  mantissa = (mantissa * 10) + (in - '0'), scale--;
+                  if (mantissa)
+                    digits++;
+                }
               in = this->getch();
             }
-          while (in >= '0' && in <= '9');
         } // Fractional part?
       if (in == 'e' || in == 'E') // Exponent?
         {
@@ -280,9 +298,10 @@ aJsonStream::parseNumber(aJsonObject *item)
             }
         }
 
-      n = sign * n * powf((double)10.0,double(((double) scale + (double) subscale
-          * (double) signsubscale))); // number = +/- number.fraction * 10^+/- exponent
-        
+      // number = +/- mantissa * 10^(scale +/- exponent), one scaling step
+      n = atof_scale((double) mantissa, scale + subscale * signsubscale);
+      if (sign < 0)
+        n = -n;
 
       item->valuefloat = n;
       item->type = aJson_Float;
@@ -161,6 +161,79 @@ static const uint8_t PUSH1 = 23;
 static const uint8_t PUSH2 = 29;
 static const uint8_t TEMPSENSOR = 128 + 10;
 
+/* Pin to port and bit mask tables, as macros so that FastPin.h can
+ * resolve constant pins at compile time */
+#define DIGITAL_PIN_TO_PORT { \
+	NOT_A_PIN,   /*  0 - pin count starts at 1 */ \
+	NOT_A_PIN,   /*  1 - VCC */ \
+	P2,          /*  2 - P2.0 */ \
+	P2,          /*  3 - P2.5 */ \
+	P2,          /*  4 - P2.6 */ \
+	P2,          /*  5 - P2.1 */ \
+	P2,          /*  6 - P2.2 */ \
+	P3,          /*  7 - P3.4 */ \
+	P3,          /*  8 - P3.5 */ \
+	P3,          /*  9 - P3.6 */ \
+	P3,          /* 10 - P3.7 */ \
+	P1,          /* 11 - P1.6 */ \
+	P1,          /* 12 - P1.7 */ \
+	P1,          /* 13 - P1.0 */ \
+	P1,          /* 14 - P1.1 */ \
+	P1,          /* 15 - P1.2 */ \
+	P3,          /* 16 - P3.0 */ \
+	P3,          /* 17 - P3.1 */ \
+	P3,          /* 18 - P3.2 */ \
+	P3,          /* 19 - P3.3 */ \
+	P1,          /* 20 - P1.3 */ \
+	P1,          /* 21 - P1.4 */ \
+	P1,          /* 22 - P1.5 */ \
+	P4,          /* 23 - P4.0 */ \
+	NOT_A_PIN,   /* 24 - GND */ \
+	/* LED's */ \
+	PJ,          /* 25 PJ.0 - LED1 */ \
+	PJ,          /* 26 PJ.1 - LED2 */ \
+	PJ,          /* 27 PJ.2 - LED3 */ \
+	PJ,          /* 28 PJ.3 - LED4 */ \
+	P4,          /* 29 P4.1 - PUSH2 */ \
+	P2,          /* 30 P2.7 - ACC_ENABLE / NTC_ENABLE */ \
+}
+
+#define DIGITAL_PIN_TO_BIT_MASK { \
+	NOT_A_PIN,   /*  0 - pin count starts at 1 */ \
+	NOT_A_PIN,   /*  1 - VCC */ \
+	BV(0),       /*  2 - P2.0 */ \
+	BV(5),       /*  3 - P2.5 */ \
+	BV(6),       /*  4 - P2.6 */ \
+	BV(1),       /*  5 - P2.1 */ \
+	BV(2),       /*  6 - P2.2 */ \
+	BV(4),       /*  7 - P3.4 */ \
+	BV(5),       /*  8 - P3.5 */ \
+	BV(6),       /*  9 - P3.6 */ \
+	BV(7),       /* 10 - P3.7 */ \
+	BV(6),       /* 11 - P1.6 */ \
+	BV(7),       /* 12 - P1.7 */ \
+	BV(0),       /* 13 - P1.0 */ \
+	BV(1),       /* 14 - P1.1 */ \
+	BV(2),       /* 15 - P1.2 */ \
+	BV(0),       /* 16 - P3.0 */ \
+	BV(1),       /* 17 - P3.1 */ \
+	BV(2),       /* 18 - P3.2 */ \
+	BV(3),       /* 19 - P3.3 */ \
+	BV(3),       /* 20 - P1.3 */ \
+	BV(4),       /* 21 - P1.4 */ \
+	BV(5),       /* 22 - P1.5 */ \
+	BV(0),       /* 23 - P4.0 */ \
+	NOT_A_PIN,   /* 24 - GND  */ \
+	/* LED's 1 through 8 */ \
+	BV(0),       /* 25 - PJ.0 - LED1 */ \
+	BV(1),       /* 26 - PJ.1 - LED2 */ \
+	BV(2),       /* 27 - PJ.2 - LED3 */ \
+	BV(3),       /* 28 - PJ.3 - LED4 */ \
+	BV(1),       /* 29 - P4.1 - PUSH2 */ \
+	BV(7),       /* 30 - P2.7 - ACC_ENABLE / NTC_ENABLE */ \
+ \
+}
+
 #ifdef ARDUINO_MAIN
 
 const uint16_t port_to_input[] = {
@@ -286,76 +359,9 @@ const uint8_t digital_pin_to_timer[] = {
 	NOT_ON_TIMER,  /* 28 PJ.3 - LED4 */
 };
 
-const uint8_t digital_pin_to_port[] = {
-	NOT_A_PIN,   /*  0 - pin count starts at 1 */
-	NOT_A_PIN,   /*  1 - VCC */
-	P2,          /*  2 - P2.0 */
-	P2,          /*  3 - P2.5 */
-	P2,          /*  4 - P2.6 */
-	P2,          /*  5 - P2.1 */
-	P2,          /*  6 - P2.2 */
-	P3,          /*  7 - P3.4 */
-	P3,          /*  8 - P3.5 */
-	P3,          /*  9 - P3.6 */
-	P3,          /* 10 - P3.7 */
-	P1,          /* 11 - P1.6 */
-	P1,          /* 12 - P1.7 */
-	P1,          /* 13 - P1.0 */
-	P1,          /* 14 - P1.1 */
-	P1,          /* 15 - P1.2 */
-	P3,          /* 16 - P3.0 */
-	P3,          /* 17 - P3.1 */
-	P3,          /* 18 - P3.2 */
-	P3,          /* 19 - P3.3 */
-	P1,          /* 20 - P1.3 */
-	P1,          /* 21 - P1.4 */
-	P1,          /* 22 - P1.5 */
-	P4,          /* 23 - P4.0 */
-	NOT_A_PIN,   /* 24 - GND */
-	/* LED's */
-	PJ,          /* 25 PJ.0 - LED1 */
-	PJ,          /* 26 PJ.1 - LED2 */
-	PJ,          /* 27 PJ.2 - LED3 */
-	PJ,          /* 28 PJ.3 - LED4 */
-	P4,          /* 29 P4.1 - PUSH2 */
-	P2,          /* 30 P2.7 - ACC_ENABLE / NTC_ENABLE */
-};
-
-const uint8_t digital_pin_to_bit_mask[] = {
-	NOT_A_PIN,   /*  0 - pin count starts at 1 */
-	NOT_A_PIN,   /*  1 - VCC */
-	BV(0),       /*  2 - P2.0 */
-	BV(5),       /*  3 - P2.5 */
-	BV(6),       /*  4 - P2.6 */
-	BV(1),       /*  5 - P2.1 */
-	BV(2),       /*  6 - P2.2 */
-	BV(4),       /*  7 - P3.4 */
-	BV(5),       /*  8 - P3.5 */
-	BV(6),       /*  9 - P3.6 */
-	BV(7),       /* 10 - P3.7 */
-	BV(6),       /* 11 - P1.6 */
-	BV(7),       /* 12 - P1.7 */
-	BV(0),       /* 13 - P1.0 */
-	BV(1),       /* 14 - P1.1 */
-	BV(2),       /* 15 - P1.2 */
-	BV(0),       /* 16 - P3.0 */
-	BV(1),       /* 17 - P3.1 */
-	BV(2),       /* 18 - P3.2 */
-	BV(3),       /* 19 - P3.3 */
-	BV(3),       /* 20 - P1.3 */
-	BV(4),       /* 21 - P1.4 */
-	BV(5),       /* 22 - P1.5 */
-	BV(0),       /* 23 - P4.0 */
-	NOT_A_PIN,   /* 24 - GND  */
-	/* LED's 1 through 8 */
-	BV(0),       /* 25 - PJ.0 - LED1 */
-	BV(1),       /* 26 - PJ.1 - LED2 */
-	BV(2),       /* 27 - PJ.2 - LED3 */
-	BV(3),       /* 28 - PJ.3 - LED4 */
-	BV(1),       /* 29 - P4.1 - PUSH2 */
-	BV(7),       /* 30 - P2.7 - ACC_ENABLE / NTC_ENABLE */
+const uint8_t digital_pin_to_port[] = DIGITAL_PIN_TO_PORT;
 
-};
+const uint8_t digital_pin_to_bit_mask[] = DIGITAL_PIN_TO_BIT_MASK;
 
 const uint32_t digital_pin_to_analog_in[] = {
         NOT_ON_ADC,     /*  dummy   */
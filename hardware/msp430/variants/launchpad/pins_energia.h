@@ -127,6 +127,56 @@ static const uint8_t PUSH2 = 5;
 static const uint8_t TEMPSENSOR = 128 + 10; // depends on chip
 
 
+/* Pin to port and bit mask tables, as macros so that FastPin.h can
+ * resolve constant pins at compile time */
+#define DIGITAL_PIN_TO_PORT { \
+   NOT_A_PIN, /* dummy */ \
+   NOT_A_PIN, /* 1 */ \
+   P1, /* 2 */ \
+   P1, /* 3 */ \
+   P1, /* 4 */ \
+   P1, /* 5 */ \
+   P1, /* 6 */ \
+   P1, /* 7 */ \
+   P2, /* 8 */ \
+   P2, /* 9 */ \
+   P2, /* 10 */ \
+   P2, /* 11 */ \
+   P2, /* 12 */ \
+   P2, /* 13 */ \
+   P1, /* 14 */ \
+   P1, /* 15 */ \
+   NOT_A_PIN, /* 16 */ \
+   NOT_A_PIN, /* 17 */ \
+   P2, /* 18 */ \
+   P2, /* 19 */ \
+   NOT_A_PIN, /* 20 */ \
+}
+
+#define DIGITAL_PIN_TO_BIT_MASK { \
+   NOT_A_PIN, /* 0,  pin count starts at 1 */ \
+   NOT_A_PIN, /* 1,  VCC */ \
+   BV(0),     /* 2,  port P1.0 */ \
+   BV(1),     /* 3,  port P1.1 */ \
+   BV(2),     /* 4,  port P1.2 */ \
+   BV(3),     /* 5,  port P1.3*/ \
+   BV(4),     /* 6,  port P1.4 */ \
+   BV(5),     /* 7,  port P1.5 */ \
+   BV(0),     /* 8,  port P2.0 */ \
+   BV(1),     /* 9,  port P2.1 */ \
+   BV(2),     /* 10, port P2.2 */ \
+   BV(3),     /* 11, port P2.3 */ \
+   BV(4),     /* 12, port P2.4 */ \
+   BV(5),     /* 13, port P2.5 */ \
+   BV(6),     /* 14, port P1.6 */ \
+   BV(7),     /* 15, port P1.7 */ \
+   NOT_A_PIN, /* 16, RST */ \
+   NOT_A_PIN, /* 17, TEST */ \
+   BV(7),     /* 18, XOUT */ \
+   BV(6),     /* 19, XIN */ \
+   NOT_A_PIN, /* 20, GND */ \
+}
+
 #ifdef ARDUINO_MAIN
 
 const uint16_t port_to_input[] = {
@@ -231,53 +281,9 @@ const uint8_t digital_pin_to_timer[] = {
    NOT_ON_TIMER, /* 20 - GND */
 };
 
-const uint8_t digital_pin_to_port[] = {
-   NOT_A_PIN, /* dummy */
-   NOT_A_PIN, /* 1 */
-   P1, /* 2 */
-   P1, /* 3 */
-   P1, /* 4 */
-   P1, /* 5 */
-   P1, /* 6 */
-   P1, /* 7 */
-   P2, /* 8 */
-   P2, /* 9 */
-   P2, /* 10 */
-   P2, /* 11 */
-   P2, /* 12 */
-   P2, /* 13 */
-   P1, /* 14 */
-   P1, /* 15 */
-   NOT_A_PIN, /* 16 */
-   NOT_A_PIN, /* 17 */
-   P2, /* 18 */
-   P2, /* 19 */
-   NOT_A_PIN, /* 20 */
-};
+const uint8_t digital_pin_to_port[] = DIGITAL_PIN_TO_PORT;
 
-const uint8_t digital_pin_to_bit_mask[] = {
-   NOT_A_PIN, /* 0,  pin count starts at 1 */
-   NOT_A_PIN, /* 1,  VCC */
-   BV(0),     /* 2,  port P1.0 */
-   BV(1),     /* 3,  port P1.1 */
-   BV(2),     /* 4,  port P1.2 */
-   BV(3),     /* 5,  port P1.3*/
-   BV(4),     /* 6,  port P1.4 */
-   BV(5),     /* 7,  port P1.5 */
-   BV(0),     /* 8,  port P2.0 */
-   BV(1),     /* 9,  port P2.1 */
-   BV(2),     /* 10, port P2.2 */
-   BV(3),     /* 11, port P2.3 */
-   BV(4),     /* 12, port P2.4 */
-   BV(5),     /* 13, port P2.5 */
-   BV(6),     /* 14, port P1.6 */
-   BV(7),     /* 15, port P1.7 */
-   NOT_A_PIN, /* 16, RST */
-   NOT_A_PIN, /* 17, TEST */
-   BV(7),     /* 18, XOUT */
-   BV(6),     /* 19, XIN */
-   NOT_A_PIN, /* 20, GND */
-};
+const uint8_t digital_pin_to_bit_mask[] = DIGITAL_PIN_TO_BIT_MASK;
 const uint32_t digital_pin_to_analog_in[] = {
         NOT_ON_ADC,     /*  dummy   */
         NOT_ON_ADC,     /*  1 - 3.3V*/
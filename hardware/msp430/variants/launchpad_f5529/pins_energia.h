@@ -177,6 +177,108 @@ static const uint8_t RED_LED = 43;
 static const uint8_t GREEN_LED = 44;
 static const uint8_t TEMPSENSOR = 128 + 10;
 
+/* Pin to port and bit mask tables, as macros so that FastPin.h can
+ * resolve constant pins at compile time */
+#define DIGITAL_PIN_TO_PORT { \
+    NOT_A_PIN, /* dummy */ \
+    NOT_A_PIN, /* 1 */ \
+    P6,        /* 2 */ \
+    P3,        /* 3 */ \
+    P3,        /* 4 */ \
+    P1,        /* 5 */ \
+    P6,        /* 6 */ \
+    P3,        /* 7 */ \
+    P2,        /* 8 */ \
+    P4,        /* 9 */ \
+    P4,        /* 10 */ \
+    P8,        /* 11 */ \
+    P2,        /* 12 */ \
+    P2,        /* 13 */ \
+    P3,        /* 14 */ \
+    P3,        /* 15 */ \
+    NOT_A_PIN, /* 16 */ \
+    P7,        /* 17 */ \
+    P2,        /* 18 */ \
+    P2,        /* 19 */ \
+    NOT_A_PIN, /* 20 */ \
+    NOT_A_PIN, /* 21 */ \
+    NOT_A_PIN, /* 22 */ \
+    P6,        /* 23 */ \
+    P6,        /* 24 */ \
+    P6,        /* 25 */ \
+    P6,        /* 26 */ \
+    P6,        /* 27 */ \
+    P7,        /* 28 */ \
+    P3,        /* 29 */ \
+    P3,        /* 30 */ \
+    P8,        /* 31 */ \
+    P3,        /* 32 */ \
+    P4,        /* 33 */ \
+    P4,        /* 34 */ \
+    P1,        /* 35 */ \
+    P1,        /* 36 */ \
+    P1,        /* 37 */ \
+    P1,        /* 38 */ \
+    P2,        /* 39 */ \
+    P2,        /* 40 */ \
+    P2,        /* 41 */ \
+    P1,        /* 42 */ \
+    P1,        /* 43 */ \
+    P4,        /* 44 */ \
+    P4,        /* 45 */ \
+    P4,        /* 46 */ \
+}
+
+#define DIGITAL_PIN_TO_BIT_MASK { \
+    NOT_A_PIN, /* 0,  pin count starts at 1 */ \
+    NOT_A_PIN, /* 1 */ \
+    BV(5),     /* 2 */ \
+    BV(4),     /* 3 */ \
+    BV(3),     /* 4 */ \
+    BV(6),     /* 5 */ \
+    BV(6),     /* 6 */ \
+    BV(2),     /* 7 */ \
+    BV(7),     /* 8 */ \
+    BV(2),     /* 9 */ \
+    BV(1),     /* 10 */ \
+    BV(1),     /* 11 */ \
+    BV(3),     /* 12 */ \
+    BV(6),     /* 13 */ \
+    BV(1),     /* 14 */ \
+    BV(0),     /* 15 */ \
+    NOT_A_PIN, /* 16 */ \
+    BV(4),     /* 17 */ \
+    BV(2),     /* 18 */ \
+    BV(0),     /* 19 */ \
+    NOT_A_PIN, /* 20 */ \
+    NOT_A_PIN, /* 21 */ \
+    NOT_A_PIN, /* 22 */ \
+    BV(0),     /* 23 */ \
+    BV(1),     /* 24 */ \
+    BV(2),     /* 25 */ \
+    BV(3),     /* 26 */ \
+    BV(4),     /* 27 */ \
+    BV(0),     /* 28 */ \
+    BV(6),     /* 29 */ \
+    BV(5),     /* 30 */ \
+    BV(2),     /* 31 */ \
+    BV(7),     /* 32 */ \
+    BV(0),     /* 33 */ \
+    BV(3),     /* 34 */ \
+    BV(2),     /* 35 */ \
+    BV(3),     /* 36 */ \
+    BV(4),     /* 37 */ \
+    BV(5),     /* 38 */ \
+    BV(4),     /* 39 */ \
+    BV(5),     /* 40 */ \
+    BV(1),     /* 41 */ \
+    BV(1),     /* 42 */ \
+    BV(0),     /* 43 */ \
+    BV(7),     /* 44 */ \
+    BV(5),     /* 45 */ \
+    BV(4),     /* 46 */ \
+}
+
 #ifdef ARDUINO_MAIN
 
 const uint16_t port_to_input[] = {
@@ -359,105 +461,9 @@ const uint8_t digital_pin_to_timer[] = {
     T0B1,         /* 44 - P4.7 */
 };
 
-const uint8_t digital_pin_to_port[] = {
-    NOT_A_PIN, /* dummy */
-    NOT_A_PIN, /* 1 */
-    P6,        /* 2 */
-    P3,        /* 3 */
-    P3,        /* 4 */
-    P1,        /* 5 */
-    P6,        /* 6 */
-    P3,        /* 7 */
-    P2,        /* 8 */
-    P4,        /* 9 */
-    P4,        /* 10 */
-    P8,        /* 11 */
-    P2,        /* 12 */
-    P2,        /* 13 */
-    P3,        /* 14 */
-    P3,        /* 15 */
-    NOT_A_PIN, /* 16 */
-    P7,        /* 17 */
-    P2,        /* 18 */
-    P2,        /* 19 */
-    NOT_A_PIN, /* 20 */
-    NOT_A_PIN, /* 21 */
-    NOT_A_PIN, /* 22 */
-    P6,        /* 23 */
-    P6,        /* 24 */
-    P6,        /* 25 */
-    P6,        /* 26 */
-    P6,        /* 27 */
-    P7,        /* 28 */
-    P3,        /* 29 */
-    P3,        /* 30 */
-    P8,        /* 31 */
-    P3,        /* 32 */
-    P4,        /* 33 */
-    P4,        /* 34 */
-    P1,        /* 35 */
-    P1,        /* 36 */
-    P1,        /* 37 */
-    P1,        /* 38 */
-    P2,        /* 39 */
-    P2,        /* 40 */
-    P2,        /* 41 */
-    P1,        /* 42 */
-    P1,        /* 43 */
-    P4,        /* 44 */
-    P4,        /* 45 */
-    P4,        /* 46 */
-};
+const uint8_t digital_pin_to_port[] = DIGITAL_PIN_TO_PORT;
 
-const uint8_t digital_pin_to_bit_mask[] = {
-    NOT_A_PIN, /* 0,  pin count starts at 1 */
-    NOT_A_PIN, /* 1 */
-    BV(5),     /* 2 */
-    BV(4),     /* 3 */
-    BV(3),     /* 4 */
-    BV(6),     /* 5 */
-    BV(6),     /* 6 */
-    BV(2),     /* 7 */
-    BV(7),     /* 8 */
-    BV(2),     /* 9 */
-    BV(1),     /* 10 */
-    BV(1),     /* 11 */
-    BV(3),     /* 12 */
-    BV(6),     /* 13 */
-    BV(1),     /* 14 */
-    BV(0),     /* 15 */
-    NOT_A_PIN, /* 16 */
-    BV(4),     /* 17 */
-    BV(2),     /* 18 */
-    BV(0),     /* 19 */
-    NOT_A_PIN, /* 20 */
-    NOT_A_PIN, /* 21 */
-    NOT_A_PIN, /* 22 */
-    BV(0),     /* 23 */
-    BV(1),     /* 24 */
-    BV(2),     /* 25 */
-    BV(3),     /* 26 */
-    BV(4),     /* 27 */
-    BV(0),     /* 28 */
-    BV(6),     /* 29 */
-    BV(5),     /* 30 */
-    BV(2),     /* 31 */
-    BV(7),     /* 32 */
-    BV(0),     /* 33 */
-    BV(3),     /* 34 */
-    BV(2),     /* 35 */
-    BV(3),     /* 36 */
-    BV(4),     /* 37 */
-    BV(5),     /* 38 */
-    BV(4),     /* 39 */
-    BV(5),     /* 40 */
-    BV(1),     /* 41 */
-    BV(1),     /* 42 */
-    BV(0),     /* 43 */
-    BV(7),     /* 44 */
-    BV(5),     /* 45 */
-    BV(4),     /* 46 */
-};
+const uint8_t digital_pin_to_bit_mask[] = DIGITAL_PIN_TO_BIT_MASK;
 
 const uint32_t digital_pin_to_analog_in[] = {
         NOT_ON_ADC,     /*  dummy   */
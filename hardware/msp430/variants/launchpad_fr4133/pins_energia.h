@@ -202,6 +202,68 @@ static const uint8_t PUSH1 = 24;
 static const uint8_t PUSH2 = 25;
 static const uint8_t TEMPSENSOR = 128 + 12; // depends on chip
 
+/* Pin to port and bit mask tables, as macros so that FastPin.h can
+ * resolve constant pins at compile time */
+#define DIGITAL_PIN_TO_PORT { \
+	NOT_A_PIN,   /*  0 - pin count starts at 1 */ \
+	NOT_A_PIN,   /*  1 - Vcc */ \
+	P8,          /*  2 - P8.1 */ \
+	P1,          /*  3 - P1.1 */ \
+	P1,          /*  4 - P1.0 */ \
+	P2,          /*  5 - P2.7 */ \
+	P8,          /*  6 - P8.0 */ \
+	P5,          /*  7 - P5.1 */ \
+	P2,          /*  8 - P2.5 */ \
+	P8,          /*  9 - P8.2 */ \
+	P8,          /* 10 - P8.3 */ \
+	P1,          /* 11 - P1.5 */ \
+	P1,          /* 12 - P1.4 */ \
+	P1,          /* 13 - P1.3 */ \
+	P5,          /* 14 - P5.3 */ \
+	P5,          /* 15 - P5.2 */ \
+	NOT_A_PIN,   /* 16 - RST */ \
+	P5,          /* 17 - P5.0 */ \
+	P1,          /* 18 - P1.6 */ \
+	P1,          /* 19 - P1.7 */ \
+	NOT_A_PIN,   /* 20 - GND */ \
+ \
+	P2,          /* 21 - P2.4 */ \
+	P2,          /* 22 - P2.3 */ \
+	P4,          /* 23 - P4.0 */ \
+	P1,          /* 24 - P1.2 */ \
+	P2,          /* 25 - P2.6 */ \
+}
+
+#define DIGITAL_PIN_TO_BIT_MASK { \
+	NOT_A_PIN,   /*  0 - pin count starts at 1 */ \
+	NOT_A_PIN,   /*  1 - Vcc */ \
+	BV(1),       /*  2 - P8.1 */ \
+	BV(1),       /*  3 - P1.1 */ \
+	BV(0),       /*  4 - P1.0 */ \
+	BV(7),       /*  5 - P2.7 */ \
+	BV(0),       /*  6 - P8.0 */ \
+	BV(1),       /*  7 - P5.1 */ \
+	BV(5),       /*  8 - P2.5 */ \
+	BV(2),       /*  9 - P8.2 */ \
+	BV(3),       /* 10 - P8.3 */ \
+	BV(5),       /* 11 - P1.5 */ \
+	BV(4),       /* 12 - P1.4 */ \
+	BV(3),       /* 13 - P1.3 */ \
+	BV(3),       /* 14 - P5.3 */ \
+	BV(2),       /* 15 - P5.2 */ \
+	NOT_A_PIN,   /* 16 - RST */ \
+	BV(0),       /* 17 - P5.0 */ \
+	BV(6),       /* 18 - P1.6 */ \
+	BV(7),       /* 19 - P1.7 */ \
+	NOT_A_PIN,   /* 20 - GND */ \
+ \
+	BV(4),       /* 21 - P2.4 */ \
+	BV(3),       /* 22 - P2.3 */ \
+	BV(0),       /* 23 - P4.0 */ \
+	BV(2),       /* 24 - P1.2 */ \
+	BV(6),       /* 25 - P2.6 */ \
+}
+
 #ifdef ARDUINO_MAIN
 
 const uint16_t port_to_input[] = {
@@ -369,65 +431,9 @@ const uint8_t digital_pin_to_timer[] = {
 	NOT_ON_TIMER,  /* 25 - P2.6 */
 };
 
-const uint8_t digital_pin_to_port[] = {
-	NOT_A_PIN,   /*  0 - pin count starts at 1 */
-	NOT_A_PIN,   /*  1 - Vcc */
-	P8,          /*  2 - P8.1 */
-	P1,          /*  3 - P1.1 */
-	P1,          /*  4 - P1.0 */
-	P2,          /*  5 - P2.7 */
-	P8,          /*  6 - P8.0 */
-	P5,          /*  7 - P5.1 */
-	P2,          /*  8 - P2.5 */
-	P8,          /*  9 - P8.2 */
-	P8,          /* 10 - P8.3 */
-	P1,          /* 11 - P1.5 */
-	P1,          /* 12 - P1.4 */
-	P1,          /* 13 - P1.3 */
-	P5,          /* 14 - P5.3 */
-	P5,          /* 15 - P5.2 */
-	NOT_A_PIN,   /* 16 - RST */
-	P5,          /* 17 - P5.0 */
-	P1,          /* 18 - P1.6 */
-	P1,          /* 19 - P1.7 */
-	NOT_A_PIN,   /* 20 - GND */
-
-	P2,          /* 21 - P2.4 */
-	P2,          /* 22 - P2.3 */
-	P4,          /* 23 - P4.0 */
-	P1,          /* 24 - P1.2 */
-	P2,          /* 25 - P2.6 */
-};
+const uint8_t digital_pin_to_port[] = DIGITAL_PIN_TO_PORT;
 
-const uint8_t digital_pin_to_bit_mask[] = {
-	NOT_A_PIN,   /*  0 - pin count starts at 1 */
-	NOT_A_PIN,   /*  1 - Vcc */
-	BV(1),       /*  2 - P8.1 */
-	BV(1),       /*  3 - P1.1 */
-	BV(0),       /*  4 - P1.0 */
-	BV(7),       /*  5 - P2.7 */
-	BV(0),       /*  6 - P8.0 */
-	BV(1),       /*  7 - P5.1 */
-	BV(5),       /*  8 - P2.5 */
-	BV(2),       /*  9 - P8.2 */
-	BV(3),       /* 10 - P8.3 */
-	BV(5),       /* 11 - P1.5 */
-	BV(4),       /* 12 - P1.4 */
-	BV(3),       /* 13 - P1.3 */
-	BV(3),       /* 14 - P5.3 */
-	BV(2),       /* 15 - P5.2 */
-	NOT_A_PIN,   /* 16 - RST */
-	BV(0),       /* 17 - P5.0 */
-	BV(6),       /* 18 - P1.6 */
-	BV(7),       /* 19 - P1.7 */
-	NOT_A_PIN,   /* 20 - GND */
-
-	BV(4),       /* 21 - P2.4 */
-	BV(3),       /* 22 - P2.3 */
-	BV(0),       /* 23 - P4.0 */
-	BV(2),       /* 24 - P1.2 */
-	BV(6),       /* 25 - P2.6 */
-};
+const uint8_t digital_pin_to_bit_mask[] = DIGITAL_PIN_TO_BIT_MASK;
 
 const uint32_t digital_pin_to_analog_in[] = {
         NOT_ON_ADC,     /*  0 - pin count starts at 1 */
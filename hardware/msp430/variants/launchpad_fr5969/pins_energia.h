@@ -36,6 +36,13 @@
 #define BV(x) (1 << (x))
 #endif
 
+/* Keep millis()/micros() on Timer2_A, which is not routed to any pin on
+ * this board, rather than on the WDT interval interrupt.
+ * Build with TIMEBASE_WDT defined to go back to the WDT. */
+#if !defined(TIMEBASE_WDT)
+#define TIMEBASE_TIMER 2
+#endif
+
 
 #if defined(__MSP430_HAS_EUSCI_B0__)
 static const uint8_t SS      = 8;   /* P3.4 */
@@ -196,6 +203,86 @@ static const uint8_t PUSH1 = 27;
 static const uint8_t PUSH2 = 28;
 static const uint8_t TEMPSENSOR = 128 + 30; // depends on chip
 
+/* Pin to port and bit mask tables, as macros so that FastPin.h can
+ * resolve constant pins at compile time */
+#define DIGITAL_PIN_TO_PORT { \
+	NOT_A_PIN,   /*  0 - pin count starts at 1 */ \
+	NOT_A_PIN,   /*  1 - Vcc */ \
+	P4,          /*  2 - P4.2 */ \
+	P2,          /*  3 - P2.6 */ \
+	P2,          /*  4 - P2.5 */ \
+	P4,          /*  5 - P4.3 */ \
+	P2,          /*  6 - P2.4 */ \
+	P2,          /*  7 - P2.2 */ \
+	P3,          /*  8 - P3.4 */ \
+	P3,          /*  9 - P3.5 */ \
+	P3,          /* 10 - P3.6 */ \
+	P1,          /* 11 - P1.3 */ \
+	P1,          /* 12 - P1.4 */ \
+	P1,          /* 13 - P1.5 */ \
+	P1,          /* 14 - P1.7 */ \
+	P1,          /* 15 - P1.6 */ \
+	NOT_A_PIN,   /* 16 - RST */ \
+	NOT_A_PIN,   /* 17 - TEST */ \
+	P3,          /* 18 - P3.0 */ \
+	P1,          /* 19 - P1.2 */ \
+	NOT_A_PIN,   /* 20 - GND */ \
+ \
+	P2,          /* 21 - P2.0 */ \
+	P2,          /* 22 - P2.1 */ \
+	P4,          /* 23 - P4.0 */ \
+	P4,          /* 24 - P4.1 */ \
+ \
+	P4,          /* 25 - P4.6 */ \
+	P1,          /* 26 - P1.0 */ \
+	P4,          /* 27 - P4.5 */ \
+	P1,          /* 28 - P1.1 */ \
+ \
+	PJ,          /* 29 - PJ.0 */ \
+	PJ,          /* 30 - PJ.1 */ \
+	PJ,          /* 31 - PJ.2 */ \
+	PJ,          /* 32 - PJ.3 */ \
+}
+
+#define DIGITAL_PIN_TO_BIT_MASK { \
+	NOT_A_PIN,   /*  0 - pin count starts at 1 */ \
+	NOT_A_PIN,   /*  1 - Vcc */ \
+	BV(2),       /*  2 - P4.2 */ \
+	BV(6),       /*  3 - P2.6 */ \
+	BV(5),       /*  4 - P2.5 */ \
+	BV(3),       /*  5 - P4.3 */ \
+	BV(4),       /*  6 - P2.4 */ \
+	BV(2),       /*  7 - P2.2 */ \
+	BV(4),       /*  8 - P3.4 */ \
+	BV(5),       /*  9 - P3.5 */ \
+	BV(6),       /* 10 - P3.6 */ \
+	BV(3),       /* 11 - P1.3 */ \
+	BV(4),       /* 12 - P1.4 */ \
+	BV(5),       /* 13 - P1.5 */ \
+	BV(7),       /* 14 - P1.7 */ \
+	BV(6),       /* 15 - P1.6 */ \
+	NOT_A_PIN,   /* 16 - RST */ \
+	NOT_A_PIN,   /* 17 - TEST */ \
+	BV(0),       /* 18 - P3.0 */ \
+	BV(2),       /* 19 - P1.2 */ \
+	NOT_A_PIN,   /* 20 - GND */ \
+ \
+	BV(0),       /* 21 - P2.0 */ \
+	BV(1),       /* 22 - P2.1 */ \
+	BV(0),       /* 23 - P4.0 */ \
+	BV(1),       /* 24 - P4.1 */ \
+ \
+	BV(6),       /* 25 - P4.6 */ \
+	BV(0),       /* 26 - P1.0 */ \
+	BV(5),       /* 27 - P4.5 */ \
+	BV(1),       /* 28 - P1.1 */ \
+ \
+	BV(0),       /* 29 - PJ.0 */ \
+	BV(1),       /* 30 - PJ.1 */ \
+	BV(2),       /* 31 - PJ.2 */ \
+	BV(3),       /* 32 - PJ.3 */ \
+}
+
 #ifdef ARDUINO_MAIN
 
 const uint16_t port_to_input[] = {
@@ -327,83 +414,9 @@ const uint8_t digital_pin_to_timer[] = {
 	NOT_ON_TIMER,  /* 32 - PJ.3 */
 };
 
-const uint8_t digital_pin_to_port[] = {
-	NOT_A_PIN,   /*  0 - pin count starts at 1 */
-	NOT_A_PIN,   /*  1 - Vcc */
-	P4,          /*  2 - P4.2 */
-	P2,          /*  3 - P2.6 */
-	P2,          /*  4 - P2.5 */
-	P4,          /*  5 - P4.3 */
-	P2,          /*  6 - P2.4 */
-	P2,          /*  7 - P2.2 */
-	P3,          /*  8 - P3.4 */
-	P3,          /*  9 - P3.5 */
-	P3,          /* 10 - P3.6 */
-	P1,          /* 11 - P1.3 */
-	P1,          /* 12 - P1.4 */
-	P1,          /* 13 - P1.5 */
-	P1,          /* 14 - P1.7 */
-	P1,          /* 15 - P1.6 */
-	NOT_A_PIN,   /* 16 - RST */
-	NOT_A_PIN,   /* 17 - TEST */
-	P3,          /* 18 - P3.0 */
-	P1,          /* 19 - P1.2 */
-	NOT_A_PIN,   /* 20 - GND */
-
-	P2,          /* 21 - P2.0 */
-	P2,          /* 22 - P2.1 */
-	P4,          /* 23 - P4.0 */
-	P4,          /* 24 - P4.1 */
-
-	P4,          /* 25 - P4.6 */
-	P1,          /* 26 - P1.0 */
-	P4,          /* 27 - P4.5 */
-	P1,          /* 28 - P1.1 */
-
-	PJ,          /* 29 - PJ.0 */
-	PJ,          /* 30 - PJ.1 */
-	PJ,          /* 31 - PJ.2 */
-	PJ,          /* 32 - PJ.3 */
-};
+const uint8_t digital_pin_to_port[] = DIGITAL_PIN_TO_PORT;
 
-const uint8_t digital_pin_to_bit_mask[] = {
-	NOT_A_PIN,   /*  0 - pin count starts at 1 */
-	NOT_A_PIN,   /*  1 - Vcc */
-	BV(2),       /*  2 - P4.2 */
-	BV(6),       /*  3 - P2.6 */
-	BV(5),       /*  4 - P2.5 */
-	BV(3),       /*  5 - P4.3 */
-	BV(4),       /*  6 - P2.4 */
-	BV(2),       /*  7 - P2.2 */
-	BV(4),       /*  8 - P3.4 */
-	BV(5),       /*  9 - P3.5 */
-	BV(6),       /* 10 - P3.6 */
-	BV(3),       /* 11 - P1.3 */
-	BV(4),       /* 12 - P1.4 */
-	BV(5),       /* 13 - P1.5 */
-	BV(7),       /* 14 - P1.7 */
-	BV(6),       /* 15 - P1.6 */
-	NOT_A_PIN,   /* 16 - RST */
-	NOT_A_PIN,   /* 17 - TEST */
-	BV(0),       /* 18 - P3.0 */
-	BV(2),       /* 19 - P1.2 */
-	NOT_A_PIN,   /* 20 - GND */
-
-	BV(0),       /* 21 - P2.0 */
-	BV(1),       /* 22 - P2.1 */
-	BV(0),       /* 23 - P4.0 */
-	BV(1),       /* 24 - P4.1 */
-
-	BV(6),       /* 25 - P4.6 */
-	BV(0),       /* 26 - P1.0 */
-	BV(5),       /* 27 - P4.5 */
-	BV(1),       /* 28 - P1.1 */
-
-	BV(0),       /* 29 - PJ.0 */
-	BV(1),       /* 30 - PJ.1 */
-	BV(2),       /* 31 - PJ.2 */
-	BV(3),       /* 32 - PJ.3 */
-};
+const uint8_t digital_pin_to_bit_mask[] = DIGITAL_PIN_TO_BIT_MASK;
 
 const uint32_t digital_pin_to_analog_in[] = {
         NOT_ON_ADC,     /*  dummy   */
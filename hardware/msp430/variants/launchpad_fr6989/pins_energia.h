@@ -36,6 +36,13 @@
 #define BV(x) (1 << (x))
 #endif
 
+/* Keep millis()/micros() on Timer2_A, which is not routed to any pin on
+ * this board, rather than on the WDT interval interrupt.
+ * Build with TIMEBASE_WDT defined to go back to the WDT. */
+#if !defined(TIMEBASE_WDT)
+#define TIMEBASE_TIMER 2
+#endif
+
 
 #if defined(__MSP430_HAS_EUSCI_B0__)
 static const uint8_t SS      = 8;   /* P2.0 */
@@ -181,6 +188,108 @@ static const uint8_t RED_LED = 43;
 static const uint8_t GREEN_LED = 44;
 static const uint8_t TEMPSENSOR = 128 + 30;
 
+/* Pin to port and bit mask tables, as macros so that FastPin.h can
+ * resolve constant pins at compile time */
+#define DIGITAL_PIN_TO_PORT { \
+	NOT_A_PIN, /* dummy */ \
+	NOT_A_PIN, /* 1  - 3.3v */ \
+	P9,        /* 2  - P9.2 */ \
+	P4,        /* 3  - P4.3 */ \
+	P4,        /* 4  - P4.2 */ \
+	P3,        /* 5  - P3.2 */ \
+	P9,        /* 6  - P9.3 */ \
+	P1,        /* 7  - P1.4 */ \
+	P2,        /* 8  - P2.0 */ \
+	P4,        /* 9  - P4.1 */ \
+	P4,        /* 10 - P4.0 */ \
+	P4,        /* 11 - P4.7 */ \
+	P2,        /* 12 - P2.4 */ \
+	P2,        /* 13 - P2.5 */ \
+	P1,        /* 14 - P1.7 */ \
+	P1,        /* 15 - P1.6 */ \
+	NOT_A_PIN, /* 16 - RST  */ \
+	P9,        /* 17 - P9.4 */ \
+	P1,        /* 18 - P1.5 */ \
+	P2,        /* 19 - P2.1 */ \
+	NOT_A_PIN, /* 20 - GND  */ \
+	NOT_A_PIN, /* 21 - 5.0v */ \
+	NOT_A_PIN, /* 22 - GND  */ \
+	P8,        /* 23 - P8.4 */ \
+	P8,        /* 24 - P8.5 */ \
+	P8,        /* 25 - P8.6 */ \
+	P8,        /* 26 - P8.7 */ \
+	P9,        /* 27 - P9.0 */ \
+	P9,        /* 28 - P9.1 */ \
+	P9,        /* 29 - P9.5 */ \
+	P9,        /* 30 - P9.6 */ \
+	P2,        /* 31 - P2.3 */ \
+	P3,        /* 32 - P3.1 */ \
+	P3,        /* 33 - P3.0 */ \
+	P1,        /* 34 - P1.3 */ \
+	P2,        /* 35 - P2.2 */ \
+	P3,        /* 36 - P3.7 */ \
+	P3,        /* 37 - P3.6 */ \
+	P3,        /* 38 - P3.3 */ \
+	P2,        /* 39 - P2.6 */ \
+	P2,        /* 40 - P2.7 */ \
+	P3,        /* 41 - P3.4 */ \
+	P3,        /* 42 - P3.5 */ \
+	P1,        /* 43 - P1.0 */ \
+	P9,        /* 44 - P9.7 */ \
+	P1,        /* 45 - P1.1 */ \
+	P1,        /* 46 - P1.2 */ \
+}
+
+#define DIGITAL_PIN_TO_BIT_MASK { \
+	NOT_A_PIN, /* 0,  pin count starts at 1 */ \
+	NOT_A_PIN, /* 1  - 3.3v */ \
+	BV(2),     /* 2  - P9.2 */ \
+	BV(3),     /* 3  - P4.3 */ \
+	BV(2),     /* 4  - P4.2 */ \
+	BV(2),     /* 5  - P3.2 */ \
+	BV(3),     /* 6  - P9.3 */ \
+	BV(4),     /* 7  - P1.4 */ \
+	BV(0),     /* 8  - P2.0 */ \
+	BV(1),     /* 9  - P4.1 */ \
+	BV(0),     /* 10 - P4.0 */ \
+	BV(7),     /* 11 - P4.7 */ \
+	BV(4),     /* 12 - P2.4 */ \
+	BV(5),     /* 13 - P2.5 */ \
+	BV(7),     /* 14 - P1.7 */ \
+	BV(6),     /* 15 - P1.6 */ \
+	NOT_A_PIN, /* 16 - RST  */ \
+	BV(4),     /* 17 - P9.4 */ \
+	BV(5),     /* 18 - P1.5 */ \
+	BV(1),     /* 19 - P2.1 */ \
+	NOT_A_PIN, /* 20 - GND  */ \
+	NOT_A_PIN, /* 21 - 5.0v */ \
+	NOT_A_PIN, /* 22 - GND  */ \
+	BV(4),     /* 23 - P8.4 */ \
+	BV(5),     /* 24 - P8.5 */ \
+	BV(6),     /* 25 - P8.6 */ \
+	BV(7),     /* 26 - P8.7 */ \
+	BV(0),     /* 27 - P9.0 */ \
+	BV(1),     /* 28 - P9.1 */ \
+	BV(5),     /* 29 - P9.5 */ \
+	BV(6),     /* 30 - P9.6 */ \
+	BV(3),     /* 31 - P2.3 */ \
+	BV(1),     /* 32 - P3.1 */ \
+	BV(0),     /* 33 - P3.0 */ \
+	BV(3),     /* 34 - P1.3 */ \
+	BV(2),     /* 35 - P2.2 */ \
+	BV(7),     /* 36 - P3.7 */ \
+	BV(6),     /* 37 - P3.6 */ \
+	BV(3),     /* 38 - P3.3 */ \
+	BV(6),     /* 39 - P2.6 */ \
+	BV(7),     /* 40 - P2.7 */ \
+	BV(4),     /* 41 - P3.4 */ \
+	BV(5),     /* 42 - P3.5 */ \
+	BV(0),     /* 43 - P1.0 */ \
+	BV(7),     /* 44 - P9.7 */ \
+	BV(1),     /* 45 - P1.1 */ \
+	BV(2),     /* 46 - P1.2 */ \
+}
+
 #ifdef ARDUINO_MAIN
 
 const uint16_t port_to_input[] = {
@@ -431,105 +540,9 @@ const uint8_t digital_pin_to_timer[] = {
 	T1A1,         /* 46 - P1.2 */
 };
 
-const uint8_t digital_pin_to_port[] = {
-	NOT_A_PIN, /* dummy */
-	NOT_A_PIN, /* 1  - 3.3v */
-	P9,        /* 2  - P9.2 */
-	P4,        /* 3  - P4.3 */
-	P4,        /* 4  - P4.2 */
-	P3,        /* 5  - P3.2 */
-	P9,        /* 6  - P9.3 */
-	P1,        /* 7  - P1.4 */
-	P2,        /* 8  - P2.0 */
-	P4,        /* 9  - P4.1 */
-	P4,        /* 10 - P4.0 */
-	P4,        /* 11 - P4.7 */
-	P2,        /* 12 - P2.4 */
-	P2,        /* 13 - P2.5 */
-	P1,        /* 14 - P1.7 */
-	P1,        /* 15 - P1.6 */
-	NOT_A_PIN, /* 16 - RST  */
-	P9,        /* 17 - P9.4 */
-	P1,        /* 18 - P1.5 */
-	P2,        /* 19 - P2.1 */
-	NOT_A_PIN, /* 20 - GND  */
-	NOT_A_PIN, /* 21 - 5.0v */
-	NOT_A_PIN, /* 22 - GND  */
-	P8,        /* 23 - P8.4 */
-	P8,        /* 24 - P8.5 */
-	P8,        /* 25 - P8.6 */
-	P8,        /* 26 - P8.7 */
-	P9,        /* 27 - P9.0 */
-	P9,        /* 28 - P9.1 */
-	P9,        /* 29 - P9.5 */
-	P9,        /* 30 - P9.6 */
-	P2,        /* 31 - P2.3 */
-	P3,        /* 32 - P3.1 */
-	P3,        /* 33 - P3.0 */
-	P1,        /* 34 - P1.3 */
-	P2,        /* 35 - P2.2 */
-	P3,        /* 36 - P3.7 */
-	P3,        /* 37 - P3.6 */
-	P3,        /* 38 - P3.3 */
-	P2,        /* 39 - P2.6 */
-	P2,        /* 40 - P2.7 */
-	P3,        /* 41 - P3.4 */
-	P3,        /* 42 - P3.5 */
-	P1,        /* 43 - P1.0 */
-	P9,        /* 44 - P9.7 */
-	P1,        /* 45 - P1.1 */
-	P1,        /* 46 - P1.2 */
-};
+const uint8_t digital_pin_to_port[] = DIGITAL_PIN_TO_PORT;
 
-const uint8_t digital_pin_to_bit_mask[] = {
-	NOT_A_PIN, /* 0,  pin count starts at 1 */
-	NOT_A_PIN, /* 1  - 3.3v */
-	BV(2),     /* 2  - P9.2 */
-	BV(3),     /* 3  - P4.3 */
-	BV(2),     /* 4  - P4.2 */
-	BV(2),     /* 5  - P3.2 */
-	BV(3),     /* 6  - P9.3 */
-	BV(4),     /* 7  - P1.4 */
-	BV(0),     /* 8  - P2.0 */
-	BV(1),     /* 9  - P4.1 */
-	BV(0),     /* 10 - P4.0 */
-	BV(7),     /* 11 - P4.7 */
-	BV(4),     /* 12 - P2.4 */
-	BV(5),     /* 13 - P2.5 */
-	BV(7),     /* 14 - P1.7 */
-	BV(6),     /* 15 - P1.6 */
-	NOT_A_PIN, /* 16 - RST  */
-	BV(4),     /* 17 - P9.4 */
-	BV(5),     /* 18 - P1.5 */
-	BV(1),     /* 19 - P2.1 */
-	NOT_A_PIN, /* 20 - GND  */
-	NOT_A_PIN, /* 21 - 5.0v */
-	NOT_A_PIN, /* 22 - GND  */
-	BV(4),     /* 23 - P8.4 */
-	BV(5),     /* 24 - P8.5 */
-	BV(6),     /* 25 - P8.6 */
-	BV(7),     /* 26 - P8.7 */
-	BV(0),     /* 27 - P9.0 */
-	BV(1),     /* 28 - P9.1 */
-	BV(5),     /* 29 - P9.5 */
-	BV(6),     /* 30 - P9.6 */
-	BV(3),     /* 31 - P2.3 */
-	BV(1),     /* 32 - P3.1 */
-	BV(0),     /* 33 - P3.0 */
-	BV(3),     /* 34 - P1.3 */
-	BV(2),     /* 35 - P2.2 */
-	BV(7),     /* 36 - P3.7 */
-	BV(6),     /* 37 - P3.6 */
-	BV(3),     /* 38 - P3.3 */
-	BV(6),     /* 39 - P2.6 */
-	BV(7),     /* 40 - P2.7 */
-	BV(4),     /* 41 - P3.4 */
-	BV(5),     /* 42 - P3.5 */
-	BV(0),     /* 43 - P1.0 */
-	BV(7),     /* 44 - P9.7 */
-	BV(1),     /* 45 - P1.1 */
-	BV(2),     /* 46 - P1.2 */
-};
+const uint8_t digital_pin_to_bit_mask[] = DIGITAL_PIN_TO_BIT_MASK;
 
 const uint32_t digital_pin_to_analog_in[] = {
         NOT_ON_ADC,     /*  dummy   */
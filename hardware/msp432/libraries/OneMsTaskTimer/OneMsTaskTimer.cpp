@@ -42,9 +42,13 @@
  
 #include "Energia.h"
 #include "OneMsTaskTimer.h"
+#include "OneMsTaskLock.h"
 
-volatile int8_t overflowing;
 OneMsTaskTimer_t * p_initial_OneMsTaskTimer = 0;
+// deferred tasks waiting for run(), oldest first
+static OneMsTaskTimer_t * volatile p_pending_OneMsTaskTimer = 0;
+static OneMsTaskTimer_t * volatile p_last_pending_OneMsTaskTimer = 0;
+static volatile uint32_t tic_count = 0;
 
 #if defined(__MSP432P401R__)
 #include <driverlib/timer_a.h>
@@ -78,7 +82,6 @@ void OneMsTaskTimer::start(uint32_t timer_index) {
     TIMER_A_DO_CLEAR,
   };
   
-  overflowing = 0;
   // Base address for first timer
   if (timer_index == 0) g_ulBase = TIMER_A0_MODULE;
   if (timer_index == 1) g_ulBase = TIMER_A1_MODULE;
@@ -133,7 +136,6 @@ void OneMsTaskTimer_int(void);
 void OneMsTaskTimer::start(uint32_t timer_index) {
   uint32_t load = (F_CPU / 1000);
   //// !!!! count = 0;
-  overflowing = 0;
   // Base address for first timer
   if (timer_index == 0) g_ulBase = TIMER32_0_MODULE;
   if (timer_index == 1) g_ulBase = TIMER32_1_MODULE;
@@ -227,7 +229,6 @@ uint32_t timer_index_ = DEFAULT_TIMER;
 
 void OneMsTaskTimer::start(uint32_t timer_index) {
   //// !!!! count = 0;
-  overflowing = 0;
   // identical to the wiring_analog.c pwm setup so is compatible
   TAxCCR0 = PWM_PERIOD;           // PWM Period
   TAxCTL = TACLR | TASSEL_2 | MC__UP | PWM_DIV;            // SMCLK, up mode
@@ -277,7 +278,6 @@ void OneMsTaskTimer_int(void);
 void OneMsTaskTimer::start(uint32_t timer_index) {
   uint32_t load = (F_CPU / 1000);
   //// !!!! count = 0;
-  overflowing = 0;
   // Base address for first timer
   g_ulBase = TIMERA0_BASE + (timer_index <<12);
   // Configuring the timers
@@ -343,7 +343,6 @@ void OneMsTaskTimer_int(void);
 void OneMsTaskTimer::start(uint32_t timer_index) {
   uint32_t load = (F_CPU / 1000);
   //// !!!! count = 0;
-  overflowing = 0;
   // Base address for first timer
   g_ulBase = getTimerBase(timerToOffset(timer_index));
   timerAB = TIMER_A << timerToAB(timer_index);
@@ -385,6 +384,47 @@ void OneMsTaskTimer_int(void)
 // Common Functions
 // ---------------------------------------------------------------------
 
+// Tasks are kept in a list sorted by absolute deadline (count), so the ISR
+// only looks at the head of the list and the tasks that actually expire.
+// add() and remove() lock out the timer ISR with taskLock(), which leaves
+// interrupts off again if the caller had them off (see OneMsTaskLock.h).
+
+// insert a task in deadline order, after the tasks with the same deadline
+static void insertTask(OneMsTaskTimer_t * task) {
+  OneMsTaskTimer_t * p_task = p_initial_OneMsTaskTimer;
+
+  if (p_task == 0 || (int32_t)(task->count - p_task->count) < 0){
+    task->nextTask = p_task;
+    p_initial_OneMsTaskTimer = task;
+  }else{
+    while (p_task->nextTask != 0 && (int32_t)(task->count - p_task->nextTask->count) >= 0){
+      p_task = p_task->nextTask;
+    }
+    task->nextTask = p_task->nextTask;
+    p_task->nextTask = task;
+  }
+  task->flags |= ONEMSTASK_SCHEDULED;
+}
+
+// unlink a task from the deadline list
+static void unlinkTask(OneMsTaskTimer_t * task) {
+  OneMsTaskTimer_t * p_task = p_initial_OneMsTaskTimer;
+
+  if (!(task->flags & ONEMSTASK_SCHEDULED))
+    return;
+  if (p_task == task){
+    p_initial_OneMsTaskTimer = task->nextTask;
+  }else{
+    while (p_task != 0 && p_task->nextTask != task){
+      p_task = p_task->nextTask;
+    }
+    if (p_task != 0)
+      p_task->nextTask = task->nextTask;
+  }
+  task->nextTask = 0;
+  task->flags &= ~ONEMSTASK_SCHEDULED;
+}
+
 void OneMsTaskTimer::set_timer_index(uint32_t timer_index) {
 	timer_index_ = timer_index;
 }
@@ -395,69 +435,112 @@ void OneMsTaskTimer::start() {
 }
 
 
-// add an additional task into the handler
+// add an additional task into the handler, periodic and called from the ISR
 void OneMsTaskTimer::add(OneMsTaskTimer_t * task) {
-  OneMsTaskTimer_t * p_task = p_initial_OneMsTaskTimer;
-  if (p_task == 0){
-	  p_initial_OneMsTaskTimer = task;
-  }else{
-	while (p_task->nextTask != 0){
-	  p_task = p_task->nextTask;
-	}
-	p_task->nextTask = task;
-  }
-  p_task = task;
-	
+  OneMsTaskTimer::add(task, 0);
+}
+
+// add a task (or re-arm one that is already added) with ONEMSTASK_* flags;
+// its first call is msecs from now
+void OneMsTaskTimer::add(OneMsTaskTimer_t * task, uint8_t flags) {
+  taskLockState state;
+
   // ensure save initialisation
   if (task->msecs == 0)
   	task->msecs = 1;
-  task->count = 0;
-  task->nextTask = 0;
+
+  state = taskLock();
+  unlinkTask(task);
+  task->flags = (task->flags & ONEMSTASK_RUNNING) | (flags & (ONEMSTASK_ONESHOT | ONEMSTASK_DEFERRED));
+  task->count = tic_count + task->msecs;
+  insertTask(task);
+  taskUnlock(state);
 }
 
-// removes an task from the handler
+// removes an task from the handler; a deferred call that is already
+// pending still runs once from run()
 void OneMsTaskTimer::remove(OneMsTaskTimer_t * task) {
+  taskLockState state = taskLock();
+
+  unlinkTask(task);
+  taskUnlock(state);
+}
+
+// call the deferred tasks that expired since the last call, from loop()
+void OneMsTaskTimer::run() {
   OneMsTaskTimer_t * p_task;
-  OneMsTaskTimer_t * p_nexttask;
-  p_nexttask = (OneMsTaskTimer_t *)p_initial_OneMsTaskTimer;
-  p_task = p_nexttask;
+  OneMsTaskTimer_t * p_next;
+  taskLockState state;
 
-  while (p_nexttask != task && p_nexttask != 0){
-    p_task = p_nexttask;
-    p_nexttask = p_task->nextTask;
-  }
-  if (p_nexttask != 0){
-	  if (p_nexttask == p_initial_OneMsTaskTimer){
-		  if (p_nexttask != 0){
-			  p_initial_OneMsTaskTimer = p_nexttask->nextTask;
-		  }else{
-			  p_initial_OneMsTaskTimer = 0;
-		  }
-	  }else{
-		  p_task->nextTask = p_nexttask->nextTask;
-	  }
+  // take the whole queue so tasks expiring meanwhile wait for the next run()
+  state = taskLock();
+  p_task = p_pending_OneMsTaskTimer;
+  p_pending_OneMsTaskTimer = 0;
+  p_last_pending_OneMsTaskTimer = 0;
+  taskUnlock(state);
+
+  while (p_task != 0){
+    p_next = p_task->nextPending;
+    p_task->pending = 0;
+    (*p_task->func)();
+    p_task = p_next;
   }
 }
 
+// ms since start() as counted by the task timer
+uint32_t OneMsTaskTimer::tics() {
+  uint32_t now;
+  taskLockState state = taskLock();
+
+  now = tic_count;
+  taskUnlock(state);
+  return now;
+}
+
 // called by the ISR every time we get an interrupt
 void OneMsTaskTimer::_ticHandler() {
-  OneMsTaskTimer_t * p_task = p_initial_OneMsTaskTimer;
-  
-  while (p_task != 0){
-    // It is a 1000hz interrupt so each interrupt is 1msec
-    p_task->count += 1;
-    if (p_task->count >= p_task->msecs && !overflowing) {
-      overflowing = 1;
-      // subtract ms to catch missed overflows. set to 0 if you don't want this.
-      // do this before running supplied function so don't take into account handler time
-      p_task->count = p_task->count - p_task->msecs; 
+  OneMsTaskTimer_t * p_task;
+  uint32_t now = ++tic_count; // It is a 1000hz interrupt so each interrupt is 1msec
+  uint32_t missed;
+
+  while ((p_task = p_initial_OneMsTaskTimer) != 0 && (int32_t)(now - p_task->count) >= 0){
+    p_initial_OneMsTaskTimer = p_task->nextTask;
+    p_task->flags &= ~ONEMSTASK_SCHEDULED;
+
+    if (!(p_task->flags & ONEMSTASK_ONESHOT)){
+      // the next deadline is based on the last one so the period does not
+      // drift; periods that are already over are skipped and counted
+      p_task->count += p_task->msecs;
+      if ((int32_t)(now - p_task->count) >= 0){
+        missed = (now - p_task->count) / p_task->msecs + 1;
+        p_task->overruns += missed;
+        p_task->count += missed * p_task->msecs;
+      }
+      insertTask(p_task);
+    }
+
+    if (p_task->flags & ONEMSTASK_DEFERRED){
+      // queue for run(); still queued from the last time is an overrun
+      if (p_task->pending){
+        p_task->overruns++;
+      }else{
+        p_task->pending = 1;
+        p_task->nextPending = 0;
+        if (p_last_pending_OneMsTaskTimer != 0)
+          p_last_pending_OneMsTaskTimer->nextPending = p_task;
+        else
+          p_pending_OneMsTaskTimer = p_task;
+        p_last_pending_OneMsTaskTimer = p_task;
+      }
+    }else if (p_task->flags & ONEMSTASK_RUNNING){
+      // the task's previous call has not returned yet (it re-enabled
+      // interrupts); only this task misses its turn
+      p_task->overruns++;
+    }else{
+      p_task->flags |= ONEMSTASK_RUNNING;
       // call the program supplied function
       (*p_task->func)();
-      overflowing = 0;
+      p_task->flags &= ~ONEMSTASK_RUNNING;
     }
-    p_task = (OneMsTaskTimer_t *)p_task->nextTask;
   }
 }
-
-
-
@@ -3,6 +3,7 @@
 
 #include <inttypes.h>
 #include "Print.h"
+#include "Arduino.h"
 
 // commands
 #define LCD_CLEARDISPLAY 0x01
@@ -93,6 +94,9 @@ private:
   uint8_t _rw_pin; // LOW: write to LCD.  HIGH: read from LCD.
   uint8_t _enable_pin; // activated by a HIGH pulse.
   uint8_t _data_pins[8];
+#ifdef PORT_GROUP_AVAILABLE
+  PortGroup _data_group; // the data pins, if they share a port
+#endif
 
   uint8_t _displayfunction;
   uint8_t _displaycontrol;
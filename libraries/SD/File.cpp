@@ -99,6 +99,12 @@ int File::read(void *buf, uint16_t nbyte) {
   return 0;
 }
 
+// Stream bulk read hook, so readBytes() copies sector data directly
+int File::read(uint8_t *buf, size_t size) {
+  if (size > 0XFFFF) size = 0XFFFF;
+  return read((void *)buf, (uint16_t)size);
+}
+
 int File::available() {
   if (! _file) return 0;
 
@@ -39,6 +39,7 @@ public:
   virtual int available();
   virtual void flush();
   int read(void *buf, uint16_t nbyte);
+  virtual int read(uint8_t *buf, size_t size);
   boolean seek(uint32_t pos);
   uint32_t position();
   uint32_t size();
@@ -72,6 +72,8 @@
 #define 	eSPI_STATE_READ_IRQ				 (6)
 #define 	eSPI_STATE_READ_FIRST_PORTION	 (7)
 #define 	eSPI_STATE_READ_EOT				 (8)
+#define 	eSPI_STATE_WRITE_DMA			 (9)
+#define 	eSPI_STATE_READ_DMA				 (10)
 
 
 typedef struct
@@ -101,6 +103,28 @@ void SpiPauseSpi(void);
 void SpiResumeSpi(void);
 void SSIContReadOperation(void);
 
+//*****************************************************************************
+//
+// On MSP430 parts where the SPI library can use DMA, the bulk of every HCI
+// packet is moved between UCB0 and wlan_tx_buffer/spi_buffer with
+// spi_dma_start() and finished from its completion callback. A read then
+// ends in the interrupt, so the IRQ handler returns while the payload comes
+// in. SpiWrite() still waits for the end of the transfer before it returns,
+// as its callers refill wlan_tx_buffer right after; there DMA only saves the
+// per byte loop. Define CC3000_SPI_NO_DMA to keep the byte loops.
+//
+//*****************************************************************************
+#if !defined(CC3000_SPI_NO_DMA) && defined(SPI_DMA_AVAILABLE)
+#define CC3000_SPI_DMA
+#endif
+
+#ifdef CC3000_SPI_DMA
+// Transfers shorter than this are not worth the DMA setup
+#define CC3000_DMA_MIN_SIZE		(16)
+
+static void SpiDmaDone(void);
+#endif
+
 // The magic number that resides at the end of the TX/RX buffer (1 byte after
 // the allocated size) for the purpose of detection of the overrun. The location
 // of the memory where the magic number resides shall never be written. In case 
@@ -327,10 +351,7 @@ SpiWrite(unsigned char *pUserBuffer, unsigned short usLength)
 		// check for a missing interrupt between the CS assertion and enabling back the interrupts
 		if (tSLInformation.ReadWlanInterruptPin() == 0)
 		{
-		
-            SpiWriteDataSynchronous(sSpiInformation.pTxPacket, sSpiInformation.usTxPacketLength);
-			sSpiInformation.ulSpiState = eSPI_STATE_IDLE;
-			DEASSERT_CS();
+			SpiWriteAsync(sSpiInformation.pTxPacket, sSpiInformation.usTxPacketLength);
 		}
 	}
 
@@ -366,6 +387,39 @@ SpiWriteDataSynchronous(unsigned char *data, unsigned short size)
 	}
 }
 
+//*****************************************************************************
+//
+//!  SpiWriteAsync
+//!
+//!  @param  data  buffer to write
+//!  @param  size  buffer's size
+//!
+//!  @return none
+//!
+//!  @brief  Write a whole packet with CS already asserted and return the
+//!          interface to idle. With DMA available the transfer is started
+//!          here and completed from the DMA interrupt.
+//
+//*****************************************************************************
+void
+SpiWriteAsync(const unsigned char *data, unsigned short size)
+{
+#ifdef CC3000_SPI_DMA
+	if (size >= CC3000_DMA_MIN_SIZE)
+	{
+		sSpiInformation.ulSpiState = eSPI_STATE_WRITE_DMA;
+		if (spi_dma_start(NULL, data, size, SpiDmaDone))
+			return;
+	}
+#endif
+
+	SpiWriteDataSynchronous((unsigned char *)data, size);
+	
+	sSpiInformation.ulSpiState = eSPI_STATE_IDLE;
+	
+	DEASSERT_CS();
+}
+
 //*****************************************************************************
 //
 //! SpiReadDataSynchronous
@@ -420,7 +474,8 @@ SpiReadHeader(void)
 //!
 //!  @param  None
 //!
-//!  @return None
+//!  @return 0 if the packet has been read, 1 if a DMA read is still
+//!          in progress
 //!
 //!  @brief  This function processes received SPI Header and in accordance with 
 //!	         it - continues reading the packet
@@ -452,6 +507,15 @@ SpiReadDataCont(void)
 			
 			if (data_to_recv)
 			{
+#ifdef CC3000_SPI_DMA
+				if (data_to_recv >= CC3000_DMA_MIN_SIZE)
+				{
+					// Completion is reported from the DMA interrupt
+					sSpiInformation.ulSpiState = eSPI_STATE_READ_DMA;
+					if (spi_dma_start(evnt_buff + 10, NULL, data_to_recv, SpiDmaDone))
+						return (1);
+				}
+#endif
 				SpiReadDataSynchronous(evnt_buff + 10, data_to_recv);
 			}
 			break;
@@ -604,12 +668,8 @@ void IntSpiGPIOHandler(void)
 	}
 	else if (sSpiInformation.ulSpiState == eSPI_STATE_WRITE_IRQ)
 	{
-		SpiWriteDataSynchronous(sSpiInformation.pTxPacket, 
-														sSpiInformation.usTxPacketLength);
-		
-		sSpiInformation.ulSpiState = eSPI_STATE_IDLE;
-		
-		DEASSERT_CS();
+		SpiWriteAsync(sSpiInformation.pTxPacket, 
+									sSpiInformation.usTxPacketLength);
 	}
 	
 	//if(deassert_cs){DEASSERT_CS();deassert_cs=0;}
@@ -692,6 +752,35 @@ SSIContReadOperation(void)
 
 
 
+#ifdef CC3000_SPI_DMA
+//*****************************************************************************
+//
+//!  SpiDmaDone
+//!
+//!  @param  none
+//!
+//!  @return none
+//!
+//!  @brief  DMA completion callback: finish the write or hand the received
+//!          packet to the HCI layer exactly as the synchronous path does.
+//
+//*****************************************************************************
+static void
+SpiDmaDone(void)
+{
+	if (sSpiInformation.ulSpiState == eSPI_STATE_WRITE_DMA)
+	{
+		sSpiInformation.ulSpiState = eSPI_STATE_IDLE;
+		DEASSERT_CS();
+	}
+	else if (sSpiInformation.ulSpiState == eSPI_STATE_READ_DMA)
+	{
+		sSpiInformation.ulSpiState = eSPI_STATE_READ_EOT;
+		SpiTriggerRxProcessing();
+	}
+}
+#endif
+
 //*****************************************************************************
 //
 // Close the Doxygen group.